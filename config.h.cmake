@@ -15,6 +15,14 @@
 #cmakedefine HAVE_SENDMMSG
 #cmakedefine HAVE_GSO
 #cmakedefine HAVE_RECVMMSG
+#cmakedefine HAVE_RTM_GETSTATS
+#cmakedefine HAVE_SO_RXQ_OVFL
+#cmakedefine HAVE_SO_TIMESTAMPNS
+#cmakedefine HAVE_TX_TIMESTAMPS
+#cmakedefine TX_TSTAMP_CORRECT
+#cmakedefine HAVE_HUGEPAGES
+#cmakedefine HAVE_TSC_CLOCK
+#cmakedefine CONTROL_THREAD
 #cmakedefine DISABLE_INT_TIMER
 #cmakedefine RATE_LIMITING
 #cmakedefine AUTH_IS_OPTIONAL
@@ -91,9 +91,11 @@
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
+#include <arpa/inet.h>
 #include <sys/epoll.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #ifdef AUTH_KEY_ENABLE
 #include <openssl/hmac.h>
 #include <openssl/x509.h>
@@ -127,6 +129,11 @@ int json_finish(void);
 int proc_pstats_file(int, BOOL);
 int proc_pstats_max(int);
 int proc_pstats_rec(int);
+int pstats_sources(char *);
+size_t hugepage_size(void);
+size_t thp_size(void);
+BOOL iobuf_alloc(void);
+void iobuf_free(void);
 
 //----------------------------------------------------------------------------
 //
@@ -141,8 +148,14 @@ struct connection *conn;                      // Connection table (array)
 static volatile sig_atomic_t sig_alrm = 0;    // Interrupt indicator
 static volatile sig_atomic_t sig_exit = 0;    // Interrupt indicator
 struct epoll_event epoll_events[MAX_EPOLL_EVENTS];
-char *boolText[]    = {"Disabled", "Enabled"};
-char *rateAdjAlgo[] = {"B", "C"}; // Aligned to CHTA_RA_ALGO_x
+static int dispReads[MAX_EPOLL_EVENTS]; // Reads per ready FD during dispatch (aligned to epoll_events)
+static unsigned int dispFirst = 0;      // Ready FD serviced first, rotated on each dispatch
+char *boolText[]     = {"Disabled", "Enabled"};
+char *rateAdjAlgo[]  = {"B", "C"};                       // Aligned to CHTA_RA_ALGO_x
+int txProbeBurst[]   = {1, 4, 16, TXPROBE_MAXBURST};     // Probed burst sizes (ascending, count of TXPROBE_BURSTS)
+char *txMethodText[] = {"sendmsg", "sendmmsg", "gso"};   // Aligned to TXM_x
+char *ioBufText[]    = {"heap", "thp", "hugetlb"};       // Aligned to IOBUF_x
+char *clockSrcText[] = {"realtime", "monotonic", "tsc"}; // Aligned to CLOCK_SRC_x
 //
 cJSON *json_top = NULL, *json_output = NULL, *json_siArray = NULL;
 char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
@@ -155,11 +168,15 @@ char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
 //
 int main(int argc, char **argv) {
         pid_t pid;
-        int i, j, var, var2, readyfds, fdpass, pristatus, secstatus;
+        int i, j, k, var, var2, readyfds, fdpass, pristatus, secstatus;
         int appstatus = STATUS_ERROR, outputfd = STDOUT_FILENO, logfilefd = -1;
         struct itimerval itime;
         struct sigaction saction;
         struct stat statbuf;
+        nstime_t dispstart;
+#ifndef DISABLE_INT_TIMER
+        struct timespec tspecvar;
+#endif
         struct perfStatsMaximums *psM = &repo.psMaximums;
         struct perfStatsAverages *psA = &repo.psAverages;
 
@@ -253,9 +270,9 @@ int main(int argc, char **argv) {
         //
         // Initialize local copy of system time clock and seed RNG
         //
-        clock_gettime(CLOCK_REALTIME, &repo.systemClock);
-        tspeccpy(&repo.startTime, &repo.systemClock);
-        srandom((unsigned int) repo.systemClock.tv_nsec);
+        clock_init();
+        repo.startTime = repo.monoClock;
+        srandom((unsigned int) nsnsec(repo.systemClock));
 
         //
         // Print banner or initialize JSON output object
@@ -304,10 +321,24 @@ int main(int argc, char **argv) {
 #ifdef HAVE_GSO
                 var += sprintf(&scratch[var], "+GSO");
 #endif // HAVE_GSO
+#ifdef HAVE_TX_TIMESTAMPS
+                var += sprintf(&scratch[var], "+TxTstamp");
+#endif // HAVE_TX_TIMESTAMPS
 #endif // HAVE_SENDMMSG
 #ifdef HAVE_RECVMMSG
                 var += sprintf(&scratch[var], " RecvMMsg()+Trunc");
+#ifdef HAVE_SO_RXQ_OVFL
+                var += sprintf(&scratch[var], "+RxqOvfl");
+#endif // HAVE_SO_RXQ_OVFL
+#ifdef HAVE_SO_TIMESTAMPNS
+                var += sprintf(&scratch[var], "+RxTstamp");
+#endif // HAVE_SO_TIMESTAMPNS
 #endif // HAVE_RECVMMSG
+#ifdef CONTROL_THREAD
+                var += sprintf(&scratch[var], " CtlThread");
+#endif // CONTROL_THREAD
+                if (repo.clockSource == CLOCK_SRC_TSC)
+                        var += sprintf(&scratch[var], " TSC");
                 scratch[var++] = '\n';
                 var            = write(outputfd, scratch, var);
         } else {
@@ -330,17 +361,18 @@ int main(int argc, char **argv) {
         // Allocate and initialize buffers
         //
         repo.sendingRates = calloc(1, MAX_SENDING_RATES * sizeof(struct sendingRate));
-        repo.sndBuffer    = calloc(1, SND_BUFFER_SIZE);
-        repo.defBuffer    = calloc(1, RCV_BUFFER_SIZE);
-        repo.randData     = malloc(MAX_JPAYLOAD_SIZE);
-        repo.sndBufRand   = malloc(SND_BUFFER_SIZE);
-        conn              = malloc(conf.maxConnections * sizeof(struct connection));
-        if (repo.sendingRates == NULL || repo.sndBuffer == NULL || repo.defBuffer == NULL || repo.randData == NULL ||
-            repo.sndBufRand == NULL || conn == NULL) {
+        if (repo.sendingRates == NULL || !iobuf_alloc()) { // I/O buffers and connection table
                 var = sprintf(scratch, "ERROR: Memory allocation(s) failed\n");
                 var = write(outputfd, scratch, var);
                 return STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
         }
+        if (repo.isServer && (conf.srcRate > 0 || conf.srcMaxConn > 0)) {
+                if ((repo.srcLimit = calloc(SRCLIM_TABLE_SIZE, sizeof(struct srcLimit))) == NULL) {
+                        var = sprintf(scratch, "ERROR: Memory allocation(s) failed\n");
+                        var = write(outputfd, scratch, var);
+                        return STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                }
+        }
         for (i = 0; i < conf.maxConnections; i++)
                 init_conn(i, FALSE);
         for (i = 0; i < (int) (MAX_JPAYLOAD_SIZE / sizeof(int)); i++)
@@ -366,19 +398,19 @@ int main(int argc, char **argv) {
         // Check for needed clock resolution
         //
 #ifndef DISABLE_INT_TIMER
-        if (clock_getres(CLOCK_REALTIME, &repo.systemClock) == -1) {
+        if (clock_getres(CLOCK_MONOTONIC, &tspecvar) == -1) {
                 var = sprintf(scratch, "CLOCK_GETRES ERROR: %s\n", strerror(errno));
                 var = write(outputfd, scratch, var);
                 return STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
         }
-        if (repo.systemClock.tv_nsec > 1) {
+        if (tspecvar.tv_nsec > 1) {
                 var =
                     sprintf(scratch, "ERROR: Clock resolution (%ld ns) out of range [see compile-time option DISABLE_INT_TIMER]\n",
-                            repo.systemClock.tv_nsec);
+                            tspecvar.tv_nsec);
                 var = write(outputfd, scratch, var);
                 return STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
         }
-        clock_gettime(CLOCK_REALTIME, &repo.systemClock); // Reinitialize local copy of system time clock
+        clock_update(); // Reinitialize local copy of system time clock
 #endif
 
         //
@@ -491,6 +523,21 @@ int main(int argc, char **argv) {
                 }
         }
 
+        //
+        // Probe available transmit methods (GSO, sendmmsg, sendmsg) and select cheapest per burst size, and clock read costs
+        //
+        if (!sig_exit) {
+                probe_tx_methods();
+                probe_clock_reads();
+        }
+
+        //
+        // If requested, calibrate server capacity via loopback benchmark (sets available bandwidth if not configured)
+        //
+        if (!sig_exit && conf.calibrate) {
+                calibrate_capacity();
+        }
+
         //
         // If specified, validate server IP addresses or resolve names into IP addresses
         //
@@ -499,7 +546,7 @@ int main(int argc, char **argv) {
                         send_proc(errConn, scratch, var);
                         appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
                         if (!repo.isServer && conf.jsonOutput) {
-                                tspeccpy(&conn[errConn].endTime, &repo.systemClock); // Schedule immediate exit
+                                conn[errConn].endTime = repo.monoClock; // Schedule immediate exit
                         } else {
                                 sig_exit = TRUE;
                         }
@@ -513,11 +560,38 @@ int main(int argc, char **argv) {
         //
         if (appstatus == STATUS_ERROR) { // If still set to default error status (i.e., no explicit errors so far)
                 if (repo.isServer) {
-                        if ((i = new_conn(-1, repo.server[0].ip, repo.server[0].port, T_UDP, &recv_proc, &service_setupreq)) < 0) {
+                        //
+                        // Start any preforked server processes (each creates its own control port connection)
+                        //
+                        var = prefork_start();
+#ifndef DISABLE_INT_TIMER
+                        if (var == 0 && repo.workerIndex > 0 && setitimer(ITIMER_REAL, &itime, NULL) != 0) { // Not inherited
+                                var = sprintf(scratch, "ITIMER ERROR: %s\n", strerror(errno));
+                        }
+#endif
+                        if (var == 0)
+                                rt_profile(); // Apply realtime profile to this process (if configured)
+                        if (var > 0) {
+                                send_proc(errConn, scratch, var);
+                                appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                                sig_exit  = TRUE;
+                        } else if ((i = new_conn(-1, repo.server[0].ip, repo.server[0].port, T_UDP, &recv_setupreq,
+                                                 &service_setupreq)) < 0) {
                                 appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
                                 sig_exit  = TRUE;
                         } else {
-                                if (conf.psFile != NULL) { // Initialize performance statistics
+#ifdef HAVE_SO_RXQ_OVFL
+                                var = 1; // Enable socket receive overflow (drop) counter of control port
+                                setsockopt(conn[i].fd, SOL_SOCKET, SO_RXQ_OVFL, (const void *) &var, sizeof(var));
+#endif
+                                if (*conf.intfName) { // Open local interface statistics
+                                        if ((var = open_intf_stats()) > 0) {
+                                                send_proc(errConn, scratch, var);
+                                                appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                                                sig_exit  = TRUE;
+                                        }
+                                }
+                                if (!sig_exit && conf.psFile != NULL) { // Initialize performance statistics
                                         if ((var = proc_pstats_file(i, TRUE)) > 0) {
                                                 send_proc(errConn, scratch, var);
                                                 appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
@@ -529,14 +603,57 @@ int main(int argc, char **argv) {
                                                       conn[i].locPort);
                                         send_proc(monConn, scratch, var);
                                 }
+                                if (!sig_exit) // Pre-create test sockets
+                                        sockpool_init(i);
+                                if (!sig_exit && conf.sharedSock > 0) { // Create shared test sockets
+                                        if ((var = shared_init()) > 0) {
+                                                send_proc(errConn, scratch, var);
+                                                appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                                                sig_exit  = TRUE;
+                                        }
+                                }
+#ifdef CONTROL_THREAD
+                                if (!sig_exit) { // Service control port via separate thread
+                                        if ((var = start_ctlthread(i)) > 0) {
+                                                send_proc(errConn, scratch, var);
+                                                appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                                                sig_exit  = TRUE;
+                                        }
+                                }
+#endif
                         }
                 } else {
+                        //
+                        // Start any worker processes (each creates its share of the test connections)
+                        //
+                        var = worker_start();
+#ifndef DISABLE_INT_TIMER
+                        if (var == 0 && repo.workerIndex > 0 && setitimer(ITIMER_REAL, &itime, NULL) != 0) { // Not inherited
+                                var = sprintf(scratch, "ITIMER ERROR: %s\n", strerror(errno));
+                        }
+#endif
+                        if (var == 0)
+                                rt_profile(); // Apply realtime profile to this process (if configured)
+                        if (var > 0) {
+                                send_proc(errConn, scratch, var);
+                                appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                                if (conf.jsonOutput) {
+                                        conn[errConn].endTime = repo.monoClock; // Schedule immediate exit
+                                } else {
+                                        sig_exit = TRUE;
+                                }
+                        }
                         var2 = 0; // Server index (distribute connections across servers)
-                        for (j = 0; j < conf.maxConnCount; j++) {
+                        for (j = 0; j < conf.maxConnCount && appstatus == STATUS_ERROR; j++) {
+                                if (j % conf.workerCount != repo.workerIndex) { // Test connection of another worker
+                                        if (++var2 >= repo.serverCount)
+                                                var2 = 0;
+                                        continue;
+                                }
                                 if ((i = new_conn(-1, NULL, 0, T_UDP, &recv_proc, &service_setupresp)) < 0) {
                                         appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
                                         if (conf.jsonOutput) {
-                                                tspeccpy(&conn[errConn].endTime, &repo.systemClock); // Schedule immediate exit
+                                                conn[errConn].endTime = repo.monoClock; // Schedule immediate exit
                                         } else {
                                                 sig_exit = TRUE;
                                         }
@@ -544,7 +661,7 @@ int main(int argc, char **argv) {
                                 } else if (send_setupreq(i, j, var2) < 0) {
                                         appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
                                         if (conf.jsonOutput) {
-                                                tspeccpy(&conn[errConn].endTime, &repo.systemClock); // Schedule immediate exit
+                                                conn[errConn].endTime = repo.monoClock; // Schedule immediate exit
                                         } else {
                                                 sig_exit = TRUE;
                                         }
@@ -582,13 +699,23 @@ int main(int argc, char **argv) {
                                 if ((unsigned int) readyfds > psM->fdReadySize)
                                         psM->fdReadySize = (unsigned int) readyfds;
                         }
+                        //
+                        // Dispatch ready FDs in passes (round robin, starting at a rotated FD) until all data is read, subject
+                        // to a read budget per FD and a time budget for the dispatch so that timers are not delayed (remaining
+                        // data is reported again by level-triggered epoll_wait)
+                        //
+                        clock_update();
+                        dispstart = repo.monoClock;
+                        dispFirst++;
                         fdpass = 0;
                         do {
                                 //
                                 // Do single read (up to RECVMMSG_SIZE) from each ready FD
                                 //
                                 var2 = 0; // Track if any data is read on this pass
-                                for (j = 0; j < readyfds; j++) {
+                                for (k = 0; k < readyfds; k++) {
+                                        j = (int) ((dispFirst + (unsigned int) k) % (unsigned int) readyfds);
+
                                         //
                                         // Extract connection from user data
                                         //
@@ -613,14 +740,51 @@ int main(int argc, char **argv) {
                                         //
                                         if (fdpass == 0) {
                                                 conn[i].dataReady = TRUE;
+                                                dispReads[j]      = 0;
                                         } else if (!conn[i].dataReady) {
                                                 continue; // Nothing to do for this connection
                                         }
 
                                         //
-                                        // Update local copy of system time clock
+                                        // Update local copy of system time clock (already current for first FD), and end dispatch
+                                        // if time budget exhausted (after first pass, so each ready FD is serviced at least once)
                                         //
-                                        clock_gettime(CLOCK_REALTIME, &repo.systemClock);
+                                        if (fdpass > 0 || k > 0)
+                                                clock_update();
+                                        if (fdpass > 0) {
+                                                if (nsusec(repo.monoClock - dispstart) >= DISPATCH_TIME) {
+                                                        if (conf.psFile != NULL)
+                                                                psA->dispTimeLimit++;
+                                                        var2 = 0; // End passes
+                                                        break;
+                                                }
+                                        }
+
+#ifdef HAVE_TX_TIMESTAMPS
+                                        //
+                                        // Collect transmit timestamps from socket error queue, clearing the error indication if
+                                        // it was only due to them (skip read if socket is not also readable or writable)
+                                        //
+                                        if (fdpass == 0 && (epoll_events[j].events & EPOLLERR) && conn[i].txTimestamp) {
+                                                if (service_txtstamp(i) > 0) {
+                                                        epoll_events[j].events &= ~EPOLLERR;
+                                                        if (!(epoll_events[j].events & (EPOLLIN | EPOLLOUT | EPOLLHUP))) {
+                                                                conn[i].dataReady = FALSE;
+                                                                continue;
+                                                        }
+                                                }
+                                        }
+#endif
+                                        //
+                                        // Send any deferred datagrams if socket became writable (skip read if not also readable)
+                                        //
+                                        if (fdpass == 0 && (epoll_events[j].events & EPOLLOUT)) {
+                                                flush_txqueue(i);
+                                                if (!(epoll_events[j].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+                                                        conn[i].dataReady = FALSE;
+                                                        continue;
+                                                }
+                                        }
 
                                         //
                                         // Execute primary and secondary actions
@@ -630,6 +794,11 @@ int main(int argc, char **argv) {
                                         if (pristatus > 0) {
                                                 var2++; // Indicate data was read on this pass
                                                 secstatus = (conn[i].secAction)(i);
+                                                if (++dispReads[j] >= DISPATCH_READS && conn[i].dataReady) {
+                                                        conn[i].dataReady = FALSE; // Read budget exhausted for this dispatch
+                                                        if (conf.psFile != NULL)
+                                                                psA->dispReadLimit++;
+                                                }
                                         } else if (pristatus == 0) {
                                                 conn[i].dataReady = FALSE; // Indicate all data has been read from this connection
                                         }
@@ -648,6 +817,14 @@ int main(int argc, char **argv) {
                                         break;
                         } while (var2 > 0 && sig_alrm == 0); // Do another pass if any data was read AND alarm hasn't fired
                 }
+#ifdef CONTROL_THREAD
+
+                //
+                // Complete setup requests handed over by control thread
+                //
+                if (repo.isServer)
+                        service_ctlqueue();
+#endif
 
                 //
                 // Process timers
@@ -669,7 +846,7 @@ int main(int argc, char **argv) {
                         //
                         // Update local copy of system time clock
                         //
-                        clock_gettime(CLOCK_REALTIME, &repo.systemClock);
+                        clock_update();
 
                         //
                         // Check each connection for timer expiry
@@ -678,8 +855,8 @@ int main(int argc, char **argv) {
                                 //
                                 // Check connection end time first
                                 //
-                                if (tspecisset(&conn[i].endTime)) {
-                                        if (tspeccmp(&repo.systemClock, &conn[i].endTime, >)) {
+                                if (conn[i].endTime != 0) {
+                                        if (repo.monoClock > conn[i].endTime) {
                                                 var2 = 0; // End time message length already output
                                                 if (repo.isServer) {
                                                         var2 = server_finish(i); // Finalize server processing
@@ -689,7 +866,7 @@ int main(int argc, char **argv) {
                                                         }
                                                 } else {
                                                         if (i == aggConn) {
-                                                                if (conf.jsonOutput) {
+                                                                if (conf.jsonOutput && repo.workerIndex == 0) {
                                                                         appstatus = json_finish(); // Finalize JSON processing
                                                                 } else {
                                                                         appstatus = repo.endTimeStatus;
@@ -720,29 +897,66 @@ int main(int argc, char **argv) {
                                 // Process timer action routines using elapsed time
                                 //
                                 var2 = 0;
-                                if (tspecisset(&conn[i].timer1Thresh)) {
-                                        if (tspeccmp(&repo.systemClock, &conn[i].timer1Thresh, >)) {
+                                if (conn[i].timer1Thresh != 0) {
+                                        if (repo.monoClock > conn[i].timer1Thresh) {
+                                                if (conf.psFile != NULL && conn[i].testAction == TEST_ACT_TEST) {
+                                                        // Update timer lateness of test connection (send/status timer)
+                                                        var = (int) nsusec(repo.monoClock - conn[i].timer1Thresh);
+                                                        psA->timLateSum += (unsigned long long) var;
+                                                        psA->timLateCount++;
+                                                        if ((unsigned int) var > psM->timLateMax)
+                                                                psM->timLateMax = (unsigned int) var;
+                                                }
                                                 (conn[i].timer1Action)(i);
                                                 var2++;
                                         }
                                 }
-                                if (tspecisset(&conn[i].timer2Thresh)) {
-                                        if (tspeccmp(&repo.systemClock, &conn[i].timer2Thresh, >)) {
+                                if (conn[i].timer2Thresh != 0) {
+                                        if (repo.monoClock > conn[i].timer2Thresh) {
                                                 (conn[i].timer2Action)(i);
                                                 var2++;
                                         }
                                 }
-                                if (tspecisset(&conn[i].timer3Thresh)) {
-                                        if (tspeccmp(&repo.systemClock, &conn[i].timer3Thresh, >)) {
+                                if (conn[i].timer3Thresh != 0) {
+                                        if (repo.monoClock > conn[i].timer3Thresh) {
                                                 (conn[i].timer3Action)(i);
                                                 var2++;
                                         }
                                 }
                                 if (var2 > 0) { // Update local copy of system time clock if work was done
-                                        clock_gettime(CLOCK_REALTIME, &repo.systemClock);
+                                        clock_update();
                                 }
                         }
 
+                        //
+                        // Output aggregated error events and write buffered log file output (when due)
+                        //
+                        log_flush(FALSE);
+
+                        //
+                        // Sample measured utilization for admission control (when due)
+                        //
+                        if (conf.utilTarget > 0) {
+                                upd_utilization();
+                        }
+#ifndef CONTROL_THREAD
+
+                        //
+                        // Replenish test socket pool (owned by control thread when used)
+                        //
+                        if (repo.isServer) {
+                                sockpool_refill();
+                        }
+#endif
+
+                        //
+                        // Check for preforked server processes that have ended (reclaiming their bandwidth)
+                        //
+                        if (repo.isServer && conf.workerCount > 1) {
+                                if ((var = prefork_check()) > 0)
+                                        send_proc(errConn, scratch, var);
+                        }
+
                         //
                         // Adjust system interval timer (if needed) based on server connection count
                         //
@@ -770,6 +984,23 @@ int main(int argc, char **argv) {
                 }
         }
 
+#ifdef CONTROL_THREAD
+        if (repo.isServer)
+                stop_ctlthread();
+#endif
+        if (!repo.isServer)
+                worker_finish();
+        if (repo.isServer) {
+                sockpool_close();
+                prefork_finish();
+        }
+
+        //
+        // Output any remaining aggregated error events and buffered log file output
+        //
+        if (conn != NULL && errConn >= 0)
+                log_flush(TRUE);
+
         //
         // Close files and epoll FD
         //
@@ -786,13 +1017,11 @@ int main(int argc, char **argv) {
         // Cleanup and free memory
         //
         free(repo.sendingRates);
-        free(repo.sndBuffer);
-        free(repo.defBuffer);
-        free(repo.randData);
-        free(repo.sndBufRand);
-        free(conn);
+        iobuf_free();
         if (repo.psBuffer != NULL)
                 free(repo.psBuffer);
+        if (repo.srcLimit != NULL)
+                free(repo.srcLimit);
 
         //
         // Stop system timer
@@ -843,7 +1072,7 @@ void signal_exit(int signal) {
 //
 int proc_parameters(int argc, char **argv, int fd) {
         int i, j, var, value;
-        char *lbuf, *optstring = "ud46C:x1evsf:jTDXSO:B:ri:oRa:y:K:m:G:nI:t:P:p:A:b:L:U:F:c:h:q:E:Ml:k:Z:?";
+        char *lbuf, *optstring = "ud46C:w:J:V:x1evsf:jTDXSO:B:QW:Y:z:g:ri:oH:Ra:y:K:m:G:nNI:t:P:p:A:b:L:U:F:c:h:q:E:Ml:k:Z:?";
 
         //
         // Clear configuration and global repository data
@@ -951,15 +1180,17 @@ int proc_parameters(int argc, char **argv, int fd) {
         } else {
                 conf.maxConnections = MAX_SERVER_CONN;
         }
-        conf.addrFamily   = AF_UNSPEC;
-        conf.minConnCount = DEF_MC_COUNT;
-        conf.maxConnCount = DEF_MC_COUNT;
-        conf.errSuppress  = TRUE;
-        conf.jumboStatus  = DEF_JUMBO_STATUS;
-        conf.rateAdjAlgo  = DEF_RA_ALGO;
-        conf.useOwDelVar  = DEF_USE_OWDELVAR;
-        conf.ignoreOooDup = DEF_IGNORE_OOODUP;
-        conf.seqNumAdjust = DEF_SEQNUM_ADJ;
+        conf.addrFamily     = AF_UNSPEC;
+        conf.minConnCount   = DEF_MC_COUNT;
+        conf.maxConnCount   = DEF_MC_COUNT;
+        conf.workerCount    = DEF_WORKERS;
+        conf.errSuppress    = TRUE;
+        conf.jumboStatus    = DEF_JUMBO_STATUS;
+        conf.rateAdjAlgo    = DEF_RA_ALGO;
+        conf.useOwDelVar    = DEF_USE_OWDELVAR;
+        conf.ignoreOooDup   = DEF_IGNORE_OOODUP;
+        conf.seqNumAdjust   = DEF_SEQNUM_ADJ;
+        conf.excludeLocDrop = DEF_EXCL_LOCDROP;
         if (!repo.isServer) {
                 // Default values
                 conf.dscpEcn     = DEF_DSCPECN_BYTE;
@@ -990,6 +1221,7 @@ int proc_parameters(int argc, char **argv, int fd) {
         repo.intfFD        = -1;           // No file descriptor
         repo.intfFDAlt     = -1;           // No file descriptor
         repo.keyIndex      = -1;           // No key index (used when client)
+        repo.rtCpu         = -1;           // Data-plane not pinned
 
         //
         // Parse remaining parameters
@@ -1037,6 +1269,40 @@ int proc_parameters(int argc, char **argv, int fd) {
                         }
                         conf.maxConnCount = value;
                         break;
+                case 'w':
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_WORKERS, MAX_WORKERS)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.workerCount = value;
+                        break;
+                case 'J':
+                        for (lbuf = optarg, conf.rtCpuCount = 0; lbuf != NULL; lbuf = strchr(lbuf, ',')) {
+                                if (*lbuf == ',')
+                                        lbuf++;
+                                value = atoi(lbuf);
+                                if ((var = param_error(value, 0, CPU_SETSIZE - 1)) > 0) {
+                                        var = write(fd, scratch, var);
+                                        return ERROR_CONF_GENERIC;
+                                }
+                                if (conf.rtCpuCount == MAX_RT_CPUS) {
+                                        var = sprintf(scratch, "ERROR: Realtime profile CPU list exceeds maximum (%d)\n",
+                                                      MAX_RT_CPUS);
+                                        var = write(fd, scratch, var);
+                                        return ERROR_CONF_GENERIC;
+                                }
+                                conf.rtCpu[conf.rtCpuCount++] = value;
+                        }
+                        break;
+                case 'V':
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_RT_PRIORITY, MAX_RT_PRIORITY)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.rtPriority = value;
+                        break;
                 case 'x':
                         if (!repo.isServer) {
                                 var = sprintf(scratch, "ERROR: Execution as daemon only valid when server\n");
@@ -1154,6 +1420,20 @@ int proc_parameters(int argc, char **argv, int fd) {
                         }
                         conf.useOwDelVar = !DEF_USE_OWDELVAR; // Not the default
                         break;
+                case 'H':
+                        if (repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Delay variation percentile only set by client\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_PDV_PCT, MAX_PDV_PCT)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.pdvPercentile = value;
+                        conf.useOwDelVar   = TRUE; // Percentile applies to One-Way Delay variation
+                        break;
                 case 'R':
                         if (repo.isServer) {
                                 var = sprintf(scratch, "ERROR: Option to ignore Out-of-Order/Duplicates only set by client\n");
@@ -1225,6 +1505,74 @@ int proc_parameters(int argc, char **argv, int fd) {
                 case 'n':
                         conf.seqNumAdjust = !DEF_SEQNUM_ADJ; // Not the default
                         break;
+                case 'N':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Exclusion of local receive drops only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.excludeLocDrop = !DEF_EXCL_LOCDROP; // Not the default
+                        break;
+                case 'Q':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Capacity calibration only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.calibrate = TRUE;
+                        break;
+                case 'W':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Utilization target only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_UTIL_TARGET, MAX_UTIL_TARGET)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.utilTarget = value;
+                        break;
+                case 'Y':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Source rate limit only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_SRC_RATE, MAX_SRC_RATE)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.srcRate = value;
+                        break;
+                case 'z':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Source connection limit only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_SRC_CONN, MAX_SRC_CONN)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.srcMaxConn = value;
+                        break;
+                case 'g':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Shared test sockets only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_SHARED_SOCK, MAX_SHARED_SOCK)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.sharedSock = value;
+                        break;
                 case 'I':
                         // Server will use as configured maximum
                         lbuf = optarg;
@@ -1283,6 +1631,10 @@ int proc_parameters(int argc, char **argv, int fd) {
                         }
                         break;
                 case 'b':
+                        if (strcmp(optarg, SOCKET_BUF_AUTO) == 0) {
+                                conf.sockBufAuto = TRUE; // Initial (default) size is tuned once testing starts
+                                break;
+                        }
                         value = atoi(optarg);
                         if ((var = param_error(value, MIN_SOCKET_BUF, MAX_SOCKET_BUF)) > 0) {
                                 var = write(fd, scratch, var);
@@ -1369,11 +1721,6 @@ int proc_parameters(int argc, char **argv, int fd) {
                         conf.seqErrThresh = value;
                         break;
                 case 'E':
-                        if (repo.isServer) {
-                                var = sprintf(scratch, "ERROR: Local interface option only available to client\n");
-                                var = write(fd, scratch, var);
-                                return ERROR_CONF_GENERIC;
-                        }
                         strncpy(conf.intfName, optarg, IFNAMSIZ + 1);
                         conf.intfName[IFNAMSIZ] = '\0';
                         break;
@@ -1434,6 +1781,7 @@ int proc_parameters(int argc, char **argv, int fd) {
                                       "       -4           Use only IPv4 address family (AF_INET)\n"
                                       "       -6           Use only IPv6 address family (AF_INET6)\n"
                                       "(c)    -C cnt[-max] Multi-connection count [Default %d per server]\n"
+                                      "       -w cnt       Worker processes [Client: spread connections, Server: share port]\n"
                                       "(s)    -x           Execute server as background (daemon) process\n"
                                       "(s)    -1           Server exits after one test execution\n"
                                       "(e)    -e           Disable suppression of socket (send/receive) errors\n",
@@ -1449,12 +1797,22 @@ int proc_parameters(int argc, char **argv, int fd) {
                                       "(m)    -X           Randomize datagram payload (else zeroes)\n"
                                       "       -S           Show server sending rate table and exit\n"
                                       "(o)    -O [+]file   Output (export) file of received load metadata\n"
-                                      "       -B mbps      Max bandwidth required by client OR available to server\n"
+                                      "       -B mbps      Max bandwidth required by client OR available to server\n");
+                        var = write(fd, scratch, var);
+                        var = sprintf(scratch,
+                                      "(s)    -Q           Calibrate available bandwidth via loopback benchmark\n"
+                                      "(s)    -W pct       Admit tests only below measured utilization target\n"
+                                      "(s)    -Y rate      Limit setup requests per second from a source prefix\n"
+                                      "(s)    -z cnt       Limit test connections from a source prefix\n"
+                                      "(s)    -g cnt       Use shared test sockets (demultiplexed by client address)\n"
+                                      "       -J cpu,...   Pin data-plane of each process to a CPU of the list\n"
+                                      "       -V prio      Realtime (SCHED_FIFO) priority with locked memory\n"
                                       "       -r           Display loss ratio instead of delivered percentage\n"
                                       "(c,b)  -i [-]count  Display bimodal maxima (specify initial sub-intervals)\n"
                                       "(c)    -o           Use One-Way Delay instead of RTT for delay variation\n"
+                                      "(c)    -H pct       Use percentile (%d - %d) of One-Way Delay variation (implies '-o')\n"
                                       "(m,v)  -m value     Packet marking octet (DSCP+ECN) [Default %d]\n",
-                                      DEF_DSCPECN_BYTE);
+                                      MIN_PDV_PCT, MAX_PDV_PCT, DEF_DSCPECN_BYTE);
                         var = write(fd, scratch, var);
                         var = sprintf(scratch,
                                       "(c)    -R           Include Out-of-Order/Duplicate datagrams\n"
@@ -1463,15 +1821,16 @@ int proc_parameters(int argc, char **argv, int fd) {
                                       "       -K file      Key file containing authentication keys\n"
                                       "(s)    -G file      Periodic server performance statistics (JSON)\n"
                                       "       -n           No adjustment to sequence numbers from backpressure\n"
+                                      "(s)    -N           Exclude local receive drops from rate adjustment\n"
                                       "(m,i)  -I [%c]index  Index of sending rate (see '-S') [Default %c0 = <Auto>]\n"
                                       "(m)    -t time      Test interval time in seconds [Default %d, Max %d]\n"
                                       "(c)    -P period    Sub-interval period in ms [Default %d]\n"
                                       "       -p port      Default port number used for control [Default %d]\n"
                                       "(c)    -A algo      Rate adjustment algorithm (%s - %s) [Default %s]\n"
-                                      "       -b buffer    Socket buffer request size (SO_SNDBUF/SO_RCVBUF)\n",
+                                      "       -b buffer    Socket buffer request size (SO_SNDBUF/SO_RCVBUF) OR '%s'\n",
                                       AUTH_KEY_SIZE, DEF_KEY_ID, SRIDX_ISSTART_PREFIX, SRIDX_ISSTART_PREFIX, DEF_TESTINT_TIME,
                                       MAX_TESTINT_TIME, DEF_SUBINT_PERIOD, DEF_CONTROL_PORT, rateAdjAlgo[CHTA_RA_ALGO_MIN],
-                                      rateAdjAlgo[CHTA_RA_ALGO_MAX], rateAdjAlgo[DEF_RA_ALGO]);
+                                      rateAdjAlgo[CHTA_RA_ALGO_MAX], rateAdjAlgo[DEF_RA_ALGO], SOCKET_BUF_AUTO);
                         var = write(fd, scratch, var);
                         var = sprintf(scratch,
                                       "(c)    -L delvar    Low delay variation threshold in ms [Default %d]\n"
@@ -1480,7 +1839,7 @@ int proc_parameters(int argc, char **argv, int fd) {
                                       "(c)    -c thresh    Congestion slow adjustment threshold [Default %d]\n"
                                       "(c)    -h delta     High-speed (row adjustment) delta [Default %d]\n"
                                       "(c)    -q seqerr    Sequence error threshold [Default %d]\n"
-                                      "(c)    -E intf      Show local interface traffic rate (ex. eth0)\n"
+                                      "       -E intf      Local interface traffic rate OR server statistics (ex. eth0)\n"
                                       "(c)    -M           Use local interface rate to determine maximum\n"
                                       "(s)    -l logfile   Log file name when executing as daemon\n"
                                       "(s)    -k logsize   Log file maximum size in KBytes [Default %d]\n"
@@ -1597,6 +1956,150 @@ int proc_parameters(int argc, char **argv, int fd) {
 }
 //----------------------------------------------------------------------------
 //
+// Obtain (default) huge page size from /proc/meminfo, else assume HUGEPAGE_SIZE (2 MB)
+//
+size_t hugepage_size(void) {
+        size_t size = HUGEPAGE_SIZE;
+        unsigned long kb;
+        char line[STRING_SIZE / 8];
+        FILE *f;
+
+        if ((f = fopen("/proc/meminfo", "r")) == NULL)
+                return size;
+        while (fgets(line, sizeof(line), f) != NULL) {
+                if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+                        if (kb > 0 && ((kb * 1024) & (kb * 1024 - 1)) == 0) // Must be a power of two (for alignment)
+                                size = (size_t) kb * 1024;
+                        break;
+                }
+        }
+        fclose(f);
+        return size;
+}
+//
+// Obtain size of transparent huge pages (PMD size, which may differ from the default explicit huge page size),
+// else assume HUGEPAGE_SIZE (2 MB)
+//
+size_t thp_size(void) {
+        size_t size = HUGEPAGE_SIZE;
+        unsigned long bytes;
+        FILE *f;
+
+        if ((f = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r")) == NULL)
+                return size;
+        if (fscanf(f, "%lu", &bytes) == 1) {
+                if (bytes > 0 && (bytes & (bytes - 1)) == 0) // Must be a power of two (for alignment)
+                        size = (size_t) bytes;
+        }
+        fclose(f);
+        return size;
+}
+//----------------------------------------------------------------------------
+//
+// Allocate I/O buffers and connection table from a single zeroed region, backed by huge pages when available to
+// reduce TLB pressure at high packet rates. Explicit huge pages (MAP_HUGETLB) are preferred, else transparent
+// huge pages are advised (MADV_HUGEPAGE) on an aligned mapping, with a fallback to the heap.
+//
+// Explicit huge pages are not used when worker or server processes are forked, as a copy-on-write fault of a
+// private huge page mapping fails (SIGBUS) once the huge page pool is exhausted
+//
+BOOL iobuf_alloc(void) {
+        size_t size, maplen = 0, part[IOBUF_PARTS];
+        char *buf = NULL;
+        int i;
+#ifdef HAVE_HUGEPAGES
+        char *raw;
+        size_t len, lead, hpsize;
+#endif
+
+        //
+        // Obtain size of each part (cache line aligned) and of region
+        //
+        part[0] = SND_BUFFER_SIZE;
+        part[1] = SND_BUFFER_SIZE;
+        part[2] = RCV_BUFFER_SIZE;
+        part[3] = MAX_JPAYLOAD_SIZE;
+        part[4] = (size_t) conf.maxConnections * sizeof(struct connection);
+        for (i = 0, size = 0; i < IOBUF_PARTS; i++) {
+                part[i] = (part[i] + IOBUF_ALIGN - 1) & ~((size_t) IOBUF_ALIGN - 1);
+                size += part[i];
+        }
+        repo.ioBufPages = IOBUF_HEAP;
+#ifdef HAVE_HUGEPAGES
+#ifdef MAP_HUGETLB
+        if (conf.workerCount <= 1) {
+                //
+                // Explicit huge page mapping must be a multiple of the huge page size
+                //
+                hpsize = hugepage_size();
+                maplen = (size + hpsize - 1) & ~(hpsize - 1);
+                buf    = mmap(NULL, maplen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (buf == MAP_FAILED)
+                        buf = NULL;
+                else
+                        repo.ioBufPages = IOBUF_HUGETLB;
+        }
+#endif
+        if (buf == NULL) {
+                //
+                // Over-allocate to trim mapping to a transparent huge page boundary, as required for them to be used
+                // (mapping itself only needs to be a multiple of the base page size)
+                //
+                hpsize = thp_size();
+                len    = (size_t) sysconf(_SC_PAGESIZE);
+                maplen = (size + len - 1) & ~(len - 1);
+                len    = maplen + hpsize;
+                raw    = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (raw != MAP_FAILED) {
+                        lead = (hpsize - ((uintptr_t) raw & (hpsize - 1))) & (hpsize - 1);
+                        if (lead > 0)
+                                munmap(raw, lead);
+                        munmap(raw + lead + maplen, len - lead - maplen);
+                        buf             = raw + lead;
+                        repo.ioBufPages = IOBUF_THP;
+#ifdef MADV_HUGEPAGE
+                        if (madvise(buf, maplen, MADV_HUGEPAGE) != 0)
+                                repo.ioBufPages = IOBUF_HEAP; // Standard pages (still a valid mapping)
+#endif
+                }
+        }
+#endif
+        if (buf == NULL) {
+                if ((buf = calloc(1, size)) == NULL) // Requested size (no huge page rounding)
+                        return FALSE;
+                repo.ioBufPages = IOBUF_HEAP;
+                repo.ioBufSize  = 0; // Heap allocation (not mapped)
+        } else {
+                repo.ioBufSize = maplen;
+        }
+        repo.ioBuffer = buf;
+
+        //
+        // Assign parts
+        //
+        repo.sndBuffer  = buf;
+        repo.sndBufRand = (buf += part[0]);
+        repo.defBuffer  = (buf += part[1]);
+        repo.randData   = (buf += part[2]);
+        conn            = (struct connection *) (buf + part[3]);
+        return TRUE;
+}
+//
+// Release region of I/O buffers and connection table
+//
+void iobuf_free(void) {
+
+        if (repo.ioBuffer == NULL)
+                return;
+        if (repo.ioBufSize > 0)
+                munmap(repo.ioBuffer, repo.ioBufSize);
+        else
+                free(repo.ioBuffer);
+        repo.ioBuffer = NULL;
+        conn          = NULL;
+}
+//----------------------------------------------------------------------------
+//
 // Check parameter range
 //
 // Populate scratch buffer and return length on error
@@ -1763,15 +2266,16 @@ int read_keyfile(int fd) {
 //
 int server_finish(int connindex) {
         register struct connection *c = &conn[connindex];
-        int var;
+        int var, usbw, dsbw, conns;
         struct perfStatsCounters *psC = &repo.psCounters;
 
         if (!c->connected)
                 psC->timeoutAwaitingAct++;
 
         var = 0;
+        ledger_update(FALSE, 0, -1); // Remove test connection from ledger
         if (conf.maxBandwidth > 0) {
-                // Adjust current upstream/downstream bandwidth
+                // Adjust current upstream/downstream bandwidth (of this process and host-wide)
                 if (c->testType == TEST_TYPE_US) {
                         if ((repo.usBandwidth -= c->maxBandwidth) < 0)
                                 repo.usBandwidth = 0;
@@ -1779,9 +2283,11 @@ int server_finish(int connindex) {
                         if ((repo.dsBandwidth -= c->maxBandwidth) < 0)
                                 repo.dsBandwidth = 0;
                 }
+                ledger_update(c->testType == TEST_TYPE_US, -c->maxBandwidth, 0);
                 if (conf.verbose) {
-                        var = sprintf(scratch, "[%d]End time reached (New USBW: %d, DSBW: %d)\n", connindex, repo.usBandwidth,
-                                      repo.dsBandwidth);
+                        ledger_totals(&usbw, &dsbw, &conns);
+                        var = sprintf(scratch, "[%d]End time reached (New USBW: %d, DSBW: %d, Conns: %d)\n", connindex, usbw,
+                                      dsbw, conns);
                         send_proc(monConn, scratch, var);
                 }
         }
@@ -1799,7 +2305,7 @@ int json_finish() {
         // Add final items to output object and add it to top-level object
         //
         if (json_output) {
-                create_timestamp(&repo.systemClock, TRUE);
+                create_timestamp(repo.systemClock, TRUE);
                 cJSON_AddStringToObject(json_output, "EOMTime", scratch);
                 //
                 if (repo.endTimeStatus == STATUS_SUCCESS) {
@@ -1842,22 +2348,24 @@ int json_finish() {
 int proc_pstats_file(int connindex, BOOL init) {
         register struct connection *c = &conn[connindex];
         time_t ttime;
-        struct timespec tspecvar;
         char fname[STRING_SIZE];
 
         //
         // Set next file write expiry time
         //
-        repo.psFileTime    = repo.systemClock.tv_sec + STATS_FILE_INT;
+        repo.psFileTime    = nssec(repo.systemClock) + STATS_FILE_INT;
         repo.psRecordCount = 0; // Reset record count
 
         //
         // Replace date/time conversion specifications in file name with current values
         //
-        ttime = (repo.systemClock.tv_sec / STATS_FILE_INT) * STATS_FILE_INT; // Truncate to file interval
-        if (strftime(scratch, STRING_SIZE, conf.psFile, localtime(&ttime)) == 0) {
+        ttime = (nssec(repo.systemClock) / STATS_FILE_INT) * STATS_FILE_INT; // Truncate to file interval
+        if (strftime(scratch, STRING_SIZE - 8, conf.psFile, localtime(&ttime)) == 0) {
                 return sprintf(scratch, "ERROR: Performance statistics file name length exceeds maximum\n");
         }
+        if (repo.workerIndex > 0) { // Each preforked server process uses its own file
+                sprintf(&scratch[strlen(scratch)], ".%d", repo.workerIndex);
+        }
 
         //
         // Create temporary file name used while open for writing
@@ -1892,21 +2400,17 @@ int proc_pstats_file(int connindex, BOOL init) {
                 //
                 // Start interval timer for processing global maximums
                 //
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = STATS_GMAX_TIMER * NSECINMSEC;
-                tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+                c->timer1Thresh = repo.monoClock + STATS_GMAX_TIMER * NSECINMSEC;
                 c->timer1Action = &proc_pstats_max;
                 //
                 // Start interval timer for processing records
                 //
-                tspecvar.tv_sec  = STATS_RECORD_INT;
-                tspecvar.tv_nsec = 0;
-                tspecplus(&repo.systemClock, &tspecvar, &c->timer2Thresh);
+                c->timer2Thresh = repo.monoClock + (nstime_t) STATS_RECORD_INT * NSECINSEC;
                 c->timer2Action = &proc_pstats_rec;
                 //
                 // Save time for initial record
                 //
-                tspeccpy(&repo.psRecordTime, &repo.systemClock);
+                repo.psRecordTime = repo.systemClock;
                 //
                 // Allocate JSON output buffer
                 //
@@ -1939,15 +2443,12 @@ int proc_pstats_file(int connindex, BOOL init) {
 int proc_pstats_max(int connindex) {
         register struct connection *c = &conn[connindex];
         int var;
-        struct timespec tspecvar;
         struct perfStatsMaximums *psM = &repo.psMaximums;
 
         //
         // Reset interval timer
         //
-        tspecvar.tv_sec  = 0;
-        tspecvar.tv_nsec = STATS_GMAX_TIMER * NSECINMSEC;
-        tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+        c->timer1Thresh = repo.monoClock + STATS_GMAX_TIMER * NSECINMSEC;
 
         //
         // Check current maximums
@@ -1970,10 +2471,10 @@ int proc_pstats_max(int connindex) {
 //
 int proc_pstats_rec(int connindex) {
         register struct connection *c = &conn[connindex];
-        int i, var;
+        int i, j, var;
         BOOL bvar;
         double dvar, delta;
-        struct timespec tspecvar;
+        struct intfCounters intfdelta;
         char *pvar, *booltext[2] = {"false", "true"};
         struct perfStatsCounters *psC = &repo.psCounters;
         struct perfStatsMaximums *psM = &repo.psMaximums;
@@ -1982,9 +2483,7 @@ int proc_pstats_rec(int connindex) {
         //
         // Reset interval timer
         //
-        tspecvar.tv_sec  = STATS_RECORD_INT;
-        tspecvar.tv_nsec = 0;
-        tspecplus(&repo.systemClock, &tspecvar, &c->timer2Thresh);
+        c->timer2Thresh = repo.monoClock + (nstime_t) STATS_RECORD_INT * NSECINSEC;
 
         //
         // Do initialization on first record
@@ -2012,15 +2511,56 @@ int proc_pstats_rec(int connindex) {
                 bvar = TRUE;
 #endif
                 i += sprintf(&repo.psBuffer[i], "\"gso_enabled\": %s,\n", booltext[bvar]);
+                i += sprintf(&repo.psBuffer[i], "\"gso_available\": %s,\n", booltext[repo.gsoAvail]);
+                i += sprintf(&repo.psBuffer[i], "\"gso_max_segments\": %d,\n", repo.gsoMaxSegs);
+                i += sprintf(&repo.psBuffer[i], "\"tx_method_probe\": [");
+                for (var = 0; var < TXPROBE_BURSTS; var++) {
+                        if (var > 0) {
+                                repo.psBuffer[i++] = ',';
+                                repo.psBuffer[i++] = ' ';
+                        }
+                        i += sprintf(&repo.psBuffer[i], "{\"burst_size\": %d, \"method\": \"%s\", \"cost_ns\": %d}",
+                                     txProbeBurst[var], txMethodText[repo.txProbeMethod[var]], repo.txProbeCost[var]);
+                }
+                i += sprintf(&repo.psBuffer[i], "],\n");
+                i += sprintf(&repo.psBuffer[i], "\"clock_source\": \"%s\",\n", clockSrcText[repo.clockSource]);
+                i += sprintf(&repo.psBuffer[i], "\"clock_read_probe\": [");
+                for (var = j = 0; var < CLOCK_SRC_COUNT; var++) {
+                        if (repo.clockReadCost[var] == 0)
+                                continue;
+                        if (j++ > 0) {
+                                repo.psBuffer[i++] = ',';
+                                repo.psBuffer[i++] = ' ';
+                        }
+                        i += sprintf(&repo.psBuffer[i], "{\"clock\": \"%s\", \"cost_ns\": %d}", clockSrcText[var],
+                                     repo.clockReadCost[var]);
+                }
+                i += sprintf(&repo.psBuffer[i], "],\n");
                 i += sprintf(&repo.psBuffer[i], "\"max_connections\": %d,\n", conf.maxConnections - repo.idleConnIndex - 1);
                 i += sprintf(&repo.psBuffer[i], "\"max_bandwidth\": %d,\n", conf.maxBandwidth);
+                if (conf.calibrate) {
+                        i += sprintf(&repo.psBuffer[i],
+                                     "\"calibration\": {\"tx_packet_rate\": %.0f, \"rx_packet_rate\": %.0f, "
+                                     "\"rate_mbps\": %.2f, \"capacity_mbps\": %d, \"dtlb_miss_per_datagram\": %.3f},\n",
+                                     repo.calibTxPps, repo.calibRxPps, repo.calibMbps, repo.calibCapacity, repo.calibDtlbMiss);
+                }
+                i += sprintf(&repo.psBuffer[i], "\"utilization_target\": %d,\n", conf.utilTarget);
+                i += sprintf(&repo.psBuffer[i], "\"source_rate_limit\": %d,\n", conf.srcRate);
+                i += sprintf(&repo.psBuffer[i], "\"source_connection_limit\": %d,\n", conf.srcMaxConn);
+                i += sprintf(&repo.psBuffer[i], "\"shared_sockets\": %d,\n", conf.sharedSock);
+                i += sprintf(&repo.psBuffer[i], "\"link_speed\": %d,\n", repo.linkSpeed);
+                i += sprintf(&repo.psBuffer[i], "\"socket_buffer_auto\": %s,\n", booltext[conf.sockBufAuto]);
+                i += sprintf(&repo.psBuffer[i], "\"io_buffer_pages\": \"%s\",\n", ioBufText[repo.ioBufPages]);
+                i += sprintf(&repo.psBuffer[i], "\"realtime\": {\"cpu\": %d, \"priority\": %d, \"memory_locked\": %s},\n",
+                             repo.rtCpu, conf.rtPriority, booltext[repo.rtLocked]);
+                i += sprintf(&repo.psBuffer[i], "\"interface_name\": \"%s\",\n", conf.intfName);
 
                 //
                 // Add start time info for file
                 //
-                i += sprintf(&repo.psBuffer[i], "\"start_timestamp\": %ld.%06ld,\n", repo.psRecordTime.tv_sec,
-                             repo.psRecordTime.tv_nsec / NSECINUSEC);
-                create_timestamp(&repo.psRecordTime, FALSE);
+                i += sprintf(&repo.psBuffer[i], "\"start_timestamp\": %ld.%06ld,\n", nssec(repo.psRecordTime),
+                             nsnsec(repo.psRecordTime) / NSECINUSEC);
+                create_timestamp(repo.psRecordTime, FALSE);
                 i += sprintf(&repo.psBuffer[i], "\"start_datetime\": \"%s\",\n", scratch);
 
                 //
@@ -2040,9 +2580,9 @@ int proc_pstats_rec(int connindex) {
         //
         repo.psBuffer[i++] = '{';
         repo.psBuffer[i++] = '\n';
-        i += sprintf(&repo.psBuffer[i], "\t\"start_timestamp\": %ld.%06ld,\n", repo.psRecordTime.tv_sec,
-                     repo.psRecordTime.tv_nsec / NSECINUSEC);
-        create_timestamp(&repo.psRecordTime, FALSE);
+        i += sprintf(&repo.psBuffer[i], "\t\"start_timestamp\": %ld.%06ld,\n", nssec(repo.psRecordTime),
+                     nsnsec(repo.psRecordTime) / NSECINUSEC);
+        create_timestamp(repo.psRecordTime, FALSE);
         i += sprintf(&repo.psBuffer[i], "\t\"start_datetime\": \"%s\",\n", scratch);
 
         //
@@ -2057,10 +2597,15 @@ int proc_pstats_rec(int connindex) {
         //----------------------------------------------------------------------
         i += sprintf(&repo.psBuffer[i], "\t\t},\n\t\t\"system\": {\n");
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_overrun_size\": %u,\n", psM->txOverrunSize);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_queue_size\": %u,\n", psM->txQueueSize);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"socket_buffer_kbytes\": %u,\n", psM->sockBufTotal);
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_burst_size\": %u,\n", psM->txBurstSize);
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_burst_size\": %u,\n", psM->rxBurstSize);
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"fd_ready_size\": %u,\n", psM->fdReadySize);
-        i += sprintf(&repo.psBuffer[i], "\t\t\t\"timer_coalesce_size\": %u\n", psM->timCoalesceSize);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"timer_coalesce_size\": %u,\n", psM->timCoalesceSize);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"timer_late_usec\": %u,\n", psM->timLateMax);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_qdisc_usec\": %u,\n", psM->txQdiscMax);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_host_queue_usec\": %u\n", psM->txHostQMax);
         i += sprintf(&repo.psBuffer[i], "\t\t}\n");
         //
         i += sprintf(&repo.psBuffer[i], "\t},\n");
@@ -2069,8 +2614,7 @@ int proc_pstats_rec(int connindex) {
         //
         // Calculate time delta since last record for averaging
         //
-        tspecminus(&repo.systemClock, &repo.psRecordTime, &tspecvar);
-        delta = (double) tspecmsec(&tspecvar);
+        delta = (double) nsmsec(repo.systemClock - repo.psRecordTime);
 
         //
         // Add averages for this record
@@ -2098,6 +2642,8 @@ int proc_pstats_rec(int connindex) {
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_datagram_rate\": %.2f,\n", dvar);
         dvar = ((double) psA->rxSeqErrLoss * MSECINSEC) / delta;
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_loss_rate\": %.2f,\n", dvar);
+        dvar = ((double) psA->rxLocalDrops * MSECINSEC) / delta;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_local_drop_rate\": %.2f,\n", dvar);
         dvar = ((double) psA->rxSeqErrOooDup * MSECINSEC) / delta;
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_ooo_dup_rate\": %.2f\n", dvar);
         //----------------------------------------------------------------------
@@ -2108,6 +2654,10 @@ int proc_pstats_rec(int connindex) {
         if (psA->txOverrunCount > 0)
                 dvar = (double) psA->txOverrunTotal / (double) psA->txOverrunCount;
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_overrun_size\": %.2f,\n", dvar);
+        dvar = ((double) psA->txDeferred * MSECINSEC) / delta;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_deferred_rate\": %.2f,\n", dvar);
+        dvar = ((double) psA->txExpired * MSECINSEC) / delta;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_expired_rate\": %.2f,\n", dvar);
         dvar = ((double) psA->txBurstCount * MSECINSEC) / delta;
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_burst_rate\": %.2f,\n", dvar);
         dvar = 0;
@@ -2131,7 +2681,57 @@ int proc_pstats_rec(int connindex) {
         dvar = 0;
         if (psA->timCoalesceCount > 0)
                 dvar = (double) psA->timCoalesceTotal / (double) psA->timCoalesceCount;
-        i += sprintf(&repo.psBuffer[i], "\t\t\t\"timer_coalesce_size\": %.2f\n", dvar);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"timer_coalesce_size\": %.2f,\n", dvar);
+        dvar = 0;
+        if (psA->timLateCount > 0)
+                dvar = (double) psA->timLateSum / (double) psA->timLateCount;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"timer_late_usec\": %.2f,\n", dvar);
+        dvar = 0;
+        if (psA->txQdiscCount > 0)
+                dvar = (double) psA->txQdiscSum / (double) psA->txQdiscCount;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_qdisc_usec\": %.2f,\n", dvar);
+        dvar = 0;
+        if (psA->txHostQCount > 0)
+                dvar = (double) psA->txHostQSum / (double) psA->txHostQCount;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_host_queue_usec\": %.2f,\n", dvar);
+        dvar = ((double) psA->txTsMissed * MSECINSEC) / delta;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_tstamp_missed_rate\": %.2f,\n", dvar);
+        dvar = ((double) psA->dispReadLimit * MSECINSEC) / delta;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"dispatch_read_limit_rate\": %.2f,\n", dvar);
+        dvar = ((double) psA->dispTimeLimit * MSECINSEC) / delta;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"dispatch_time_limit_rate\": %.2f,\n", dvar);
+        dvar = 0;
+        if (psA->ctrlRxCount > 0)
+                dvar = (double) psA->ctrlRxTotal / (double) psA->ctrlRxCount;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"ctrl_rx_batch_size\": %.2f,\n", dvar);
+        dvar = 0;
+        if (psA->ctrlTxCount > 0)
+                dvar = (double) psA->ctrlTxTotal / (double) psA->ctrlTxCount;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"ctrl_tx_batch_size\": %.2f,\n", dvar);
+        dvar = ((double) psA->clockReads * MSECINSEC) / delta;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"clock_read_rate\": %.2f,\n", dvar);
+        dvar = ((double) psA->clockReads * repo.clockReadCost[repo.clockSource] * 100.0) / (delta * NSECINMSEC);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"clock_read_time_pct\": %.4f\n", dvar);
+        //----------------------------------------------------------------------
+        if (sample_intf_stats(&intfdelta, &repo.intfCountPs)) {
+                i += sprintf(&repo.psBuffer[i], "\t\t},\n\t\t\"interface\": {\n");
+                dvar = ((double) intfdelta.rxBytes * 8.0) / delta / MSECINSEC;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_rate_mbps\": %.2f,\n", dvar);
+                dvar = ((double) intfdelta.txBytes * 8.0) / delta / MSECINSEC;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_rate_mbps\": %.2f,\n", dvar);
+                dvar = ((double) intfdelta.rxPackets * MSECINSEC) / delta;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_packet_rate\": %.2f,\n", dvar);
+                dvar = ((double) intfdelta.txPackets * MSECINSEC) / delta;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_packet_rate\": %.2f,\n", dvar);
+                dvar = ((double) intfdelta.rxDropped * MSECINSEC) / delta;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_drop_rate\": %.2f,\n", dvar);
+                dvar = ((double) intfdelta.txDropped * MSECINSEC) / delta;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_drop_rate\": %.2f,\n", dvar);
+                dvar = ((double) intfdelta.rxErrors * MSECINSEC) / delta;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_error_rate\": %.2f,\n", dvar);
+                dvar = ((double) intfdelta.txErrors * MSECINSEC) / delta;
+                i += sprintf(&repo.psBuffer[i], "\t\t\t\"tx_error_rate\": %.2f\n", dvar);
+        }
         //----------------------------------------------------------------------
         i += sprintf(&repo.psBuffer[i], "\t\t},\n\t\t\"status\": {\n");
         dvar = ((double) psA->txStatusMsgs * MSECINSEC) / delta;
@@ -2154,9 +2754,9 @@ int proc_pstats_rec(int connindex) {
         //
         // Add end time info for this record
         //
-        i += sprintf(&repo.psBuffer[i], "\t\"end_timestamp\": %ld.%06ld,\n", repo.systemClock.tv_sec,
-                     repo.systemClock.tv_nsec / NSECINUSEC);
-        create_timestamp(&repo.systemClock, FALSE);
+        i += sprintf(&repo.psBuffer[i], "\t\"end_timestamp\": %ld.%06ld,\n", nssec(repo.systemClock),
+                     nsnsec(repo.systemClock) / NSECINUSEC);
+        create_timestamp(repo.systemClock, FALSE);
         i += sprintf(&repo.psBuffer[i], "\t\"end_datetime\": \"%s\"\n", scratch);
         repo.psBuffer[i++] = '}';
 
@@ -2165,12 +2765,12 @@ int proc_pstats_rec(int connindex) {
         //
         repo.psBufSize = i;   // Restore saved buffer size for next record
         repo.psRecordCount++; // Increment record count
-        tspeccpy(&repo.psRecordTime, &repo.systemClock);
+        repo.psRecordTime = repo.systemClock;
 
         //
         // Finalize performance statistics file if file time exceeded
         //
-        if (repo.systemClock.tv_sec >= repo.psFileTime) {
+        if (nssec(repo.systemClock) >= repo.psFileTime) {
                 //
                 // End arrary of records and add record count
                 //
@@ -2191,6 +2791,13 @@ int proc_pstats_rec(int connindex) {
                 i += sprintf(&repo.psBuffer[i], "\t\t\"invalid_protocol_ver\": %u,\n", psC->invalidProtocolVer);
                 i += sprintf(&repo.psBuffer[i], "\t\t\"invalid_setup_option\": %u,\n", psC->invalidSetupOption);
                 i += sprintf(&repo.psBuffer[i], "\t\t\"bandwidth_exceeded\": %u,\n", psC->bandwidthExceeded);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"utilization_exceeded\": %u,\n", psC->utilizationExceeded);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"source_rate_limited\": %u,\n", psC->srcRateLimited);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"source_connection_limited\": %u,\n", psC->srcConnLimited);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"setup_queue_full\": %u,\n", psC->setupQueueFull);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"ctrl_socket_drops\": %u,\n", psC->ctrlSocketDrops);
+                psC->sockPoolEmpty += sockpool_empty();
+                i += sprintf(&repo.psBuffer[i], "\t\t\"socket_pool_empty\": %u,\n", psC->sockPoolEmpty);
                 i += sprintf(&repo.psBuffer[i], "\t\t\"connection_create_fail\": %u,\n", psC->connCreateFail);
                 i += sprintf(&repo.psBuffer[i], "\t\t\"legacy_protocol_ver\": %u\n", psC->legacyProtocolVer);
                 //----------------------------------------------------------------------
@@ -2214,20 +2821,28 @@ int proc_pstats_rec(int connindex) {
                 i += sprintf(&repo.psBuffer[i], "\t\t\"load_invalid_checksum\": %u,\n", psC->loadInvalidChksum);
                 i += sprintf(&repo.psBuffer[i], "\t\t\"status_invalid_size\": %u,\n", psC->statusInvalidSize);
                 i += sprintf(&repo.psBuffer[i], "\t\t\"status_invalid_format\": %u,\n", psC->statusInvalidFormat);
-                i += sprintf(&repo.psBuffer[i], "\t\t\"status_invalid_checksum\": %u\n", psC->statusInvalidChksum);
-                i += sprintf(&repo.psBuffer[i], "\t}\n");
+                i += sprintf(&repo.psBuffer[i], "\t\t\"status_invalid_checksum\": %u,\n", psC->statusInvalidChksum);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"shared_unmatched\": %u,\n", psC->sharedUnmatched);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"shared_socket_drops\": %u,\n", psC->sharedSocketDrops);
+                i += sprintf(&repo.psBuffer[i], "\t\t\"gso_fallback\": %u\n", psC->gsoFallback);
+                i += sprintf(&repo.psBuffer[i], "\t}");
+                if (repo.srcLimit != NULL) {
+                        i += sprintf(&repo.psBuffer[i], ",\n\t\"sources\": [");
+                        i += pstats_sources(&repo.psBuffer[i]);
+                        i += sprintf(&repo.psBuffer[i], "]");
+                }
+                repo.psBuffer[i++] = '\n';
                 //
                 i += sprintf(&repo.psBuffer[i], "},\n");
 
                 //
                 // Add end time info for file
                 //
-                tspecminus(&repo.systemClock, &repo.startTime, &tspecvar);
-                i += sprintf(&repo.psBuffer[i], "\"process_uptime\": %ld,\n", tspecvar.tv_sec);
+                i += sprintf(&repo.psBuffer[i], "\"process_uptime\": %ld,\n", nssec(repo.monoClock - repo.startTime));
                 //
-                i += sprintf(&repo.psBuffer[i], "\"end_timestamp\": %ld.%06ld,\n", repo.systemClock.tv_sec,
-                             repo.systemClock.tv_nsec / NSECINUSEC);
-                create_timestamp(&repo.systemClock, FALSE);
+                i += sprintf(&repo.psBuffer[i], "\"end_timestamp\": %ld.%06ld,\n", nssec(repo.systemClock),
+                             nsnsec(repo.systemClock) / NSECINUSEC);
+                create_timestamp(repo.systemClock, FALSE);
                 i += sprintf(&repo.psBuffer[i], "\"end_datetime\": \"%s\"\n", scratch);
                 repo.psBuffer[i++] = '}';
                 repo.psBuffer[i++] = '\n';
@@ -2245,3 +2860,56 @@ int proc_pstats_rec(int connindex) {
         return 0;
 }
 //----------------------------------------------------------------------------
+//
+// Add source prefixes with the most rejected setup requests (up to SRCLIM_EXPORT_MAX) to buffer
+//
+// Rejection counts of all source prefixes are reset for the next performance statistics file
+//
+int pstats_sources(char *buf) {
+        int i, j, k, plen, var = 0;
+        unsigned int total, best;
+        struct srcLimit *s;
+        char addrstr[INET6_ADDR_STRLEN];
+
+        for (k = 0; k < SRCLIM_EXPORT_MAX; k++) {
+                //
+                // Find source prefix with next highest rejection count
+                //
+                j    = -1;
+                best = 0;
+                for (i = 0; i < SRCLIM_TABLE_SIZE; i++) {
+                        s     = &repo.srcLimit[i];
+                        total = s->rateLimited + s->connLimited;
+                        if (s->inUse && total > best) {
+                                best = total;
+                                j    = i;
+                        }
+                }
+                if (j < 0)
+                        break;
+                s = &repo.srcLimit[j];
+                if (IN6_IS_ADDR_V4MAPPED(&s->prefix)) {
+                        inet_ntop(AF_INET, &s->prefix.s6_addr[12], addrstr, sizeof(addrstr));
+                        plen = SRCLIM_PREFIX4;
+                } else {
+                        inet_ntop(AF_INET6, &s->prefix, addrstr, sizeof(addrstr));
+                        plen = SRCLIM_PREFIX6;
+                }
+                if (k > 0)
+                        buf[var++] = ',';
+                var += sprintf(&buf[var],
+                               "\n\t\t{\"prefix\": \"%s/%d\", \"rate_limited\": %u, \"connection_limited\": %u, "
+                               "\"connections\": %d}",
+                               addrstr, plen, s->rateLimited, s->connLimited, s->connCount);
+                s->rateLimited = s->connLimited = 0; // Exclude from further selection
+        }
+        if (var > 0)
+                var += sprintf(&buf[var], "\n\t");
+
+        for (i = 0; i < SRCLIM_TABLE_SIZE; i++) {
+                repo.srcLimit[i].rateLimited = 0;
+                repo.srcLimit[i].connLimited = 0;
+        }
+        return var;
+}
+//----------------------------------------------------------------------------
@@ -60,7 +60,9 @@
 #define MAX_SERVER_CONN    256                // Max server connections
 #define MAX_CLIENT_CONN    (MAX_MC_COUNT + 1) // Max client connections (plus aggregate)
 #define MAX_EPOLL_EVENTS   MAX_SERVER_CONN    // Max epoll events handled at one time
-#define AGG_QUERY_TIME     10                 // Query timer for aggregate connection (ms)
+#define AGG_QUERY_TIME     100                // Query timer for aggregate connection [housekeeping] (ms)
+#define AGG_WORKER_TIME    10                 // Query timer for aggregate connection [worker processes] (ms)
+#define AGG_SLOTS          4                  // Aggregation slots of upcoming sub-intervals
 #define IDLE_INTERVAL_USEC 10000              // Idle interval timer [server idle] (us)
 #define MIN_RANDOM_START   5                  // Minimum used for random I/O start (ms)
 #define MAX_RANDOM_START   50                 // Maximum used for random I/O start (ms)
@@ -69,6 +71,17 @@
 #define ALERT_MSG_LIMIT    10                 // Alert message limit
 #define INFO_MSG_LIMIT     10                 // Info message limit (per connection)
 #define WARNING_MSG_LIMIT  10                 // Warning message limit (per connection)
+#define LOG_AGG_INTERVAL   1000               // Aggregation interval of repeated error events (ms)
+#define LOG_FLUSH_INTERVAL 250                // Flush interval of buffered log file output (ms)
+#define LOG_BUFFER_SIZE    (STRING_SIZE * 16) // Log file output buffer size
+#define UTIL_SAMPLE_INT    1000               // Sampling interval of measured utilization for admission (ms)
+#define CTLQ_SIZE          256                // Queue size of setup requests from control thread (power of 2)
+#define CTL_POLL_TIME      100                // Poll timeout of control thread to check for exit (ms)
+#define CTRLMMSG_SIZE      64                 // Max control port datagrams per recvmmsg()/sendmmsg() (<= CTLQ_SIZE)
+#define SOCKPOOL_SIZE      32                 // Pre-created test sockets in pool (server)
+#define SOCKPOOL_REFILL    8                  // Max test sockets created per pool refill
+#define DISPATCH_READS     8                  // Max reads (each up to RECVMMSG_SIZE) per ready FD per dispatch
+#define DISPATCH_TIME      2000               // Max time per dispatch of ready FDs before servicing timers (us)
 #define WARNING_NOTRAFFIC  1                  // Receive traffic stopped warning threshold (sec)
 #define TIMEOUT_NOTRAFFIC  (WARNING_NOTRAFFIC + 2)
 //
@@ -76,10 +89,28 @@
 //
 #define STATS_RECORD_INT  10  // Record interval (sec)
 #define STATS_FILE_INT    300 // File interval (sec)
-#define STATS_BUFFER_SIZE (((STATS_FILE_INT / STATS_RECORD_INT) + 1) * 2048)
+#define STATS_BUFFER_SIZE (((STATS_FILE_INT / STATS_RECORD_INT) + 1) * 3072)
 #define STATS_GMAX_TIMER  500 // Timer for global maximums (ms)
 #define STATS_SCHEMA_VER  1.0 // Schema version of file and record format
 //
+// Per-source admission limits of setup requests (see struct srcLimit)
+//
+#define SRCLIM_TABLE_SIZE 1024 // Hashed table size of source prefixes (power of 2)
+#define SRCLIM_PROBE_MAX  8    // Max table entries probed per source prefix
+#define SRCLIM_PREFIX4    32   // Source prefix length (IPv4)
+#define SRCLIM_PREFIX6    64   // Source prefix length (IPv6)
+#define SRCLIM_BURST_SEC  2    // Token bucket depth in seconds of rate (but at least MAX_MC_COUNT)
+#define SRCLIM_EXPORT_MAX 8    // Max source prefixes included in performance statistics file
+//
+// Client worker processes, with sub-interval stats merged by parent via shared memory snapshots (see worker_start)
+//
+#define WORKER_SNAP_RING 8 // Sub-interval snapshots retained per worker (not yet merged by parent)
+//
+// Shared test sockets, with test traffic demultiplexed by remote address and port (see recv_shared)
+//
+#define DEMUX_TABLE_SIZE 1024 // Hashed table size of test connections (power of 2)
+#define DEMUX_RCV_SIZE   256  // Receive size per datagram (larger than any control or status PDU, load PDUs truncated)
+//
 // General status and status base values for warning and error ranges (ErrorStatus)
 //   See udpst_protocol.h for CHSR_CRSP_XXXX and CHTA_CRSP_XXXX values
 //
@@ -123,6 +154,16 @@
 #else
 #define SEND_TIMER_ADJ 0 // Set to zero when interval timer is disabled
 #endif
+//
+// Auto-tuned socket buffers (-b auto) are sized from the sending rate of a test connection, covering the greater of the
+// minimum RTT or a minimum window along with two sending ticks. Total buffering of all test connections is limited by
+// a global budget.
+//
+#define SOCKBUF_AUTO_MIN    65536      // Minimum auto-tuned socket buffer (bytes)
+#define SOCKBUF_AUTO_MAX    134217728  // Maximum auto-tuned socket buffer (bytes)
+#define SOCKBUF_AUTO_WINDOW 20         // Minimum buffering window (ms)
+#define SOCKBUF_AUTO_BUDGET 1073741824 // Global budget for auto-tuned socket buffers (bytes)
+#define SOCKBUF_AUTO_HYST   4          // Resize only when target differs by more than 1/Nth of current
 
 //----------------------------------------------------------------------------
 //
@@ -132,9 +173,16 @@
 #define DEF_USE_OWDELVAR     FALSE          // Use one-way delay instead of RTT
 #define DEF_IGNORE_OOODUP    TRUE           // Ignore Out-of-Order/Duplicate datagrams
 #define DEF_SEQNUM_ADJ       TRUE           // Adjust seq. numbers from backpressure
+#define DEF_EXCL_LOCDROP     FALSE          // Exclude local receive drops from rate adjustment
 #define DEF_MC_COUNT         1              // Multi-connection test count
 #define MIN_MC_COUNT         1              //
 #define MAX_MC_COUNT         24             //
+#define DEF_WORKERS          1              // Worker processes (client test connections, preforked servers)
+#define MIN_WORKERS          1              //
+#define MAX_WORKERS          8              //
+#define MAX_RT_CPUS          16             // CPUs of realtime profile (data-plane of each process pinned to one)
+#define MIN_RT_PRIORITY      1              // Realtime (SCHED_FIFO) priority with locked memory
+#define MAX_RT_PRIORITY      99             //
 #define DEF_DSCPECN_BYTE     0              // DSCP+ECN byte for testing
 #define MIN_DSCPECN_BYTE     0              //
 #define MAX_DSCPECN_BYTE     UINT8_MAX      //
@@ -157,6 +205,7 @@
 #define DEF_SOCKET_BUF       1024000        // Socket buffer to request
 #define MIN_SOCKET_BUF       0              // (0 = System default/minimum)
 #define MAX_SOCKET_BUF       16777216       //
+#define SOCKET_BUF_AUTO      "auto"         // Keyword for auto-tuned socket buffers
 #define DEF_LOW_THRESH       30             // Low delay variation threshold (ms)
 #define MIN_LOW_THRESH       1              //
 #define MAX_LOW_THRESH       10000          //
@@ -181,6 +230,18 @@
 #define MIN_REQUIRED_BW      0              // Required OR available bandwidth (Mbps)
 #define MAX_CLIENT_BW        INT16_MAX      // (MSb for direction [CHSR_USDIR_BIT])
 #define MAX_SERVER_BW        100000         //
+#define DEF_UTIL_TARGET      0              // Utilization target for admission (%)
+#define MIN_UTIL_TARGET      1              //
+#define MAX_UTIL_TARGET      100            //
+#define DEF_SRC_RATE         0              // Setup requests per second per source prefix
+#define MIN_SRC_RATE         1              //
+#define MAX_SRC_RATE         1000           //
+#define DEF_SRC_CONN         0              // Max test connections per source prefix
+#define MIN_SRC_CONN         1              //
+#define MAX_SRC_CONN         MAX_SERVER_CONN //
+#define DEF_SHARED_SOCK      0              // Shared test sockets (SO_REUSEPORT group)
+#define MIN_SHARED_SOCK      1              //
+#define MAX_SHARED_SOCK      16             //
 #define DEF_RA_ALGO          CHTA_RA_ALGO_B // Default rate adjustment algorithm
 #define DEF_KEY_ID           0              // Key ID
 #define MIN_KEY_ID           0              //
@@ -188,6 +249,9 @@
 #define DEF_ECN_CE_TH        0              // ECN CE threshold
 #define MIN_ECN_CE_TH        1              //
 #define MAX_ECN_CE_TH        UINT8_MAX      //
+#define DEF_PDV_PCT          0              // Delay variation percentile for rate adjustment (0 = average)
+#define MIN_PDV_PCT          50             //
+#define MAX_PDV_PCT          99             //
 
 //----------------------------------------------------------------------------
 //
@@ -217,8 +281,63 @@
 #define GSO_CMSG_LEN    (CMSG_LEN(sizeof(uint16_t)))
 #define GSO_CMSG_SIZE   (CMSG_SPACE(sizeof(uint16_t)))
 #ifndef UDP_MAX_SEGMENTS
-#define UDP_MAX_SEGMENTS (1 << 6UL)
+#define UDP_MAX_SEGMENTS (1 << 7UL) // Segment limit of newer kernels (verified by startup probe)
 #endif
+#define GSO_LEGACY_SEGMENTS (1 << 6UL) // Segment limit of older kernels
+//
+// Transmit methods selected at runtime (per connection and burst size) based on startup probe
+//
+#define TXM_SENDMSG        0
+#define TXM_SENDMMSG       1
+#define TXM_GSO            2
+#define TXM_COUNT          3
+#define TXPROBE_BURSTS     4  // Number of probed burst sizes (see udpst_data.c)
+#define TXPROBE_MAXBURST   64 // Largest probed burst size
+#define TXPROBE_ITERATIONS 32 // Iterations per probed burst size and method
+#define TXPROBE_RUNS       3  // Measurement runs per probed burst size and method (best is used)
+//
+// Hot path feature set of test connection, used to select specialized load PDU send/receive variants (see select_hotpath)
+//
+#define HP_ECN     0x01 // ECN processing of received load PDUs
+#define HP_EXPORT  0x02 // Export (output file) of received load PDU metadata
+#define HP_RANDPAY 0x04 // Payload randomization of sent load PDUs
+#define HP_PSTATS  0x08 // Performance statistics of sent load PDUs
+#define HP_SEQADJ  0x10 // Sequence number adjustment for load PDUs not accepted
+#define HP_SHARED  0x20 // Shared test socket
+#define HP_RXMASK  (HP_ECN | HP_EXPORT)
+#define HP_TXMASK  (HP_RANDPAY | HP_PSTATS | HP_SEQADJ | HP_SHARED)
+//
+// Backing of region containing I/O buffers and connection table (see iobuf_alloc)
+//
+#define IOBUF_HEAP    0
+#define IOBUF_THP     1
+#define IOBUF_HUGETLB 2
+#define IOBUF_PARTS   5                 // Send, random send, receive, random payload, connection table
+#define IOBUF_ALIGN   64                // Alignment of each part (cache line)
+#define HUGEPAGE_SIZE (2 * 1024 * 1024) // Default explicit and transparent huge page size (see iobuf_alloc)
+//
+// Clock sources (see clock_update), pacing uses a monotonic source and wall clock (for PDU timestamps and output)
+// is derived from it using an offset that is resynchronized periodically (also rebases TSC conversion)
+//
+#define CLOCK_SRC_REAL    0    // CLOCK_REALTIME (probed for reference only)
+#define CLOCK_SRC_MONO    1    // CLOCK_MONOTONIC
+#define CLOCK_SRC_TSC     2    // Time stamp counter calibrated against CLOCK_MONOTONIC (see HAVE_TSC_CLOCK)
+#define CLOCK_SRC_COUNT   3
+#define CLOCK_SYNC_INT    1000 // Wall clock offset resync interval (ms)
+#define CLOCK_PROBE_READS 1024 // Reads per clock source during startup probe
+#define TSC_CALIB_TIME    10   // Initial TSC calibration time (ms)
+//
+// Startup capacity calibration (server) sends at the maximum sending rate over a loopback connection pair
+//
+#define CALIB_DURATION 1000 // Calibration duration (ms)
+#define CALIB_HEADROOM 80   // Capacity applied as percentage of measured rate
+//
+// Deferred transmit queue retains datagrams not accepted by a full socket send buffer until it becomes
+// writable (EPOLLOUT), as long as they can be sent within the maximum delay (else they are expired)
+//
+#define TXQ_BUFFER_SIZE (DEF_BUFFER_SIZE * 4)      // Queue buffer size (allocated only when needed)
+#define TXQ_MAX_ENTRIES ((MAX_BURST_SIZE + 1) * 2) // Max queued messages (datagrams or GSO buffers)
+#define TXQ_MAX_DELAY   5                          // Max delay of deferred datagrams (ms)
 //
 // Receive buffer is used to read RECVMMSG_SIZE messages (of size RCV_HEADER_SIZE) when using recvmmsg()
 //   Limit: RECVMMSG_SIZE <= DEF_BUFFER_SIZE / RCV_HEADER_SIZE
@@ -264,6 +383,10 @@ struct configuration {
         BOOL ipv6Only;                   // Only allow IPv6 testing
         int minConnCount;                // Minimum multi-connection count
         int maxConnCount;                // Maximum multi-connection count
+        int workerCount;                 // Worker processes (client test connections, preforked servers)
+        int rtCpu[MAX_RT_CPUS];          // CPUs of realtime profile
+        int rtCpuCount;                  // CPUs of realtime profile (count)
+        int rtPriority;                  // Realtime (SCHED_FIFO) priority [0 = disabled]
         BOOL isDaemon;                   // Execute as daemon
         BOOL oneTest;                    // Exit after one test (server only)
         BOOL errSuppress;                // Suppress send/receive errors
@@ -281,8 +404,10 @@ struct configuration {
         BOOL showLossRatio;              // Display loss ratio
         int bimodalCount;                // Bimodal initial sub-interval count
         BOOL useOwDelVar;                // Use one-way delay instead of RTT
+        int pdvPercentile;               // One-way delay variation percentile for rate adjustment
         BOOL ignoreOooDup;               // Ignore Out-of-Order/Duplicate datagrams
         BOOL seqNumAdjust;               // Adjust seq. numbers from backpressure
+        BOOL excludeLocDrop;             // Exclude local receive drops from rate adjustment
         char authKey[AUTH_KEY_SIZE + 4]; // Authentication key (from command-line)
         int keyId;                       // Authentication key ID
         char *keyFile;                   // Authentication key file
@@ -295,6 +420,7 @@ struct configuration {
         int controlPort;                 // Control port number for setup requests
         int sockSndBuf;                  // Socket send buffer size
         int sockRcvBuf;                  // Socket receive buffer size
+        BOOL sockBufAuto;                // Auto-tune socket buffers from sending rate
         int lowThresh;                   // Low delay variation threshold
         int upperThresh;                 // Upper delay variation threshold
         int trialInt;                    // Status feedback/trial interval (ms)
@@ -302,6 +428,11 @@ struct configuration {
         int highSpeedDelta;              // High-speed row adjustment delta
         int seqErrThresh;                // Sequence error threshold
         int maxBandwidth;                // Required OR available bandwidth
+        BOOL calibrate;                  // Calibrate available bandwidth at startup
+        int utilTarget;                  // Utilization target for admission (%)
+        int srcRate;                     // Setup requests per second per source prefix
+        int srcMaxConn;                  // Max test connections per source prefix
+        int sharedSock;                  // Shared test sockets (0 = socket per test)
         BOOL intfForMax;                 // Local interface used for maximum
         char intfName[IFNAMSIZ + 4];     // Local interface for supplemental data
         int logFileMax;                  // Maximum log file size
@@ -348,14 +479,22 @@ struct perfStatsMaximums {
         unsigned int dsBandwidth;     // Downstream bandwidth allocated
         unsigned int txOverrunSize;   // Queued transmit overrun size
         unsigned int txBurstSize;     // Transmit burst size
+        unsigned int txQueueSize;     // Deferred transmit queue size
+        unsigned int sockBufTotal;    // Auto-tuned socket buffer total (KBytes)
         unsigned int rxBurstSize;     // Received burst size
         unsigned int fdReadySize;     // FD ready size
         unsigned int timCoalesceSize; // Timer coalesce size
+        unsigned int timLateMax;      // Timer lateness (us)
+        unsigned int txQdiscMax;      // Transmit packet scheduler (qdisc) queueing (us)
+        unsigned int txHostQMax;      // Transmit host queueing (us)
 };
 struct perfStatsAverages {
         unsigned long long qdBytes;    // Queued transmit bytes (64 bits)
         unsigned long long txBytes;    // Transmitted bytes (64 bits)
         unsigned long long rxBytes;    // Received bytes (64 bits)
+        unsigned long long timLateSum; // Timer lateness sum (us, 64 bits)
+        unsigned long long txQdiscSum; // Transmit qdisc queueing sum (us, 64 bits)
+        unsigned long long txHostQSum; // Transmit host queueing sum (us, 64 bits)
         unsigned int qdDatagrams;      // Queued transmit datagrams
         unsigned int txDatagrams;      // Transmitted datagrams
         unsigned int rxDatagrams;      // Received datagrams
@@ -363,16 +502,30 @@ struct perfStatsAverages {
         unsigned int txSeqErrOooDup;   // Transmitted out-of-order + duplicates
         unsigned int rxSeqErrLoss;     // Received loss
         unsigned int rxSeqErrOooDup;   // Received out-of-order + duplicates
+        unsigned int rxLocalDrops;     // Received local (socket overflow) drops
         unsigned int txOverrunCount;   // Queued transmit overrun indications
         unsigned int txOverrunTotal;   // Queued transmit overrun total count
         unsigned int txBurstCount;     // Transmitted bursts
         unsigned int txBurstTotal;     // Transmitted burst total count
+        unsigned int txDeferred;       // Deferred transmit datagrams
+        unsigned int txExpired;        // Expired deferred transmit datagrams
         unsigned int rxBurstCount;     // Received bursts
         unsigned int rxBurstTotal;     // Received burst total count
         unsigned int fdReadyCount;     // FD ready indications
         unsigned int fdReadyTotal;     // FD ready total count
         unsigned int timCoalesceCount; // Timer coalesce count
         unsigned int timCoalesceTotal; // Timer coalesce total
+        unsigned int timLateCount;     // Timer lateness samples
+        unsigned int txQdiscCount;     // Transmit qdisc queueing samples
+        unsigned int txHostQCount;     // Transmit host queueing samples
+        unsigned int txTsMissed;       // Transmit timestamps missed (dropped or unmatched)
+        unsigned int dispReadLimit;    // Dispatch read budget exhausted (per FD)
+        unsigned int dispTimeLimit;    // Dispatch time budget exhausted
+        unsigned int ctrlRxCount;      // Control port receive calls
+        unsigned int ctrlRxTotal;      // Control port received datagrams
+        unsigned int ctrlTxCount;      // Control port send calls
+        unsigned int ctrlTxTotal;      // Control port sent datagrams
+        unsigned int clockReads;       // Clock reads (pacing and wall clock update)
         unsigned int txStatusMsgs;     // Transmitted status messages
         unsigned int rxStatusMsgs;     // Received status messages
         unsigned int locStatusLoss;    // Local status messages lost
@@ -380,6 +533,16 @@ struct perfStatsAverages {
         unsigned int locTrafficStop;   // Local traffic stop indications
         unsigned int remTrafficStop;   // Remote traffic stop indications
 };
+struct intfCounters {
+        unsigned long long rxBytes;   // Received bytes
+        unsigned long long txBytes;   // Transmitted bytes
+        unsigned long long rxPackets; // Received packets
+        unsigned long long txPackets; // Transmitted packets
+        unsigned long long rxDropped; // Received packets dropped
+        unsigned long long txDropped; // Transmit packets dropped
+        unsigned long long rxErrors;  // Receive errors
+        unsigned long long txErrors;  // Transmit errors
+};
 struct perfStatsCounters {
         unsigned int setupRequestCnt;     // Setup request count
         unsigned int setupAcceptCnt;      // Setup accepted count
@@ -387,6 +550,12 @@ struct perfStatsCounters {
         unsigned int invalidProtocolVer;  // Invalid protocol version
         unsigned int invalidSetupOption;  // Invalid setup option
         unsigned int bandwidthExceeded;   // Bandwidth exceeded
+        unsigned int utilizationExceeded; // Utilization target exceeded
+        unsigned int srcRateLimited;      // Setup request dropped (source rate limit)
+        unsigned int srcConnLimited;      // Setup request rejected (source connection limit)
+        unsigned int setupQueueFull;      // Setup request dropped (control queue full)
+        unsigned int ctrlSocketDrops;     // Setup request dropped (control socket receive overflow)
+        unsigned int sockPoolEmpty;       // Test socket created while socket pool was empty
         unsigned int connCreateFail;      // Connection creation failure
         unsigned int legacyProtocolVer;   // Connection with legacy protocol
         unsigned int timeoutAwaitingAct;  // Timeout awaiting test activation
@@ -405,14 +574,42 @@ struct perfStatsCounters {
         unsigned int statusInvalidSize;   // Invalid status msg size
         unsigned int statusInvalidFormat; // Invalid status msg format
         unsigned int statusInvalidChksum; // Invalid status msg checksum
+        unsigned int sharedUnmatched;     // Datagram on shared test socket not matching a connection
+        unsigned int sharedSocketDrops;   // Datagram dropped by shared test socket (receive overflow)
+        unsigned int gsoFallback;         // GSO send fallback to sendmmsg()
+};
+//
+// Source prefix entry of hashed per-source admission limit table
+//
+struct srcLimit {
+        struct in6_addr prefix;   // Source prefix (IPv4 as IPv4-mapped)
+        BOOL inUse;               // Entry in use
+        unsigned int tokens;      // Setup request tokens available (scaled by MSECINSEC)
+        long long lastMsec;       // Time of last token refill (ms)
+        int connCount;            // Active test connections
+        unsigned int rateLimited; // Setup requests dropped by rate limit
+        unsigned int connLimited; // Setup requests rejected by connection limit
 };
 struct repository {
-        struct timespec systemClock;          // Clock reference (CLOCK_REALTIME)
-        struct timespec startTime;            // Process start time
+        nstime_t systemClock;                 // Clock reference (wall clock, nsec)
+        nstime_t monoClock;                   // Pacing clock reference (monotonic, nsec)
+        nstime_t wallOffset;                  // Offset of wall clock from pacing clock
+        nstime_t clockSyncTime;               // Next wall clock offset resync (pacing clock)
+        int clockSource;                      // Pacing clock source (CLOCK_SRC_x)
+        int clockReadCost[CLOCK_SRC_COUNT];   // Clock read cost per source (ns, 0 if unavailable)
+        unsigned long long tscBase;           // TSC value at last rebase
+        nstime_t tscBaseNs;                   // Pacing clock at last rebase
+        unsigned long long tscCal;            // TSC value at start of calibration
+        nstime_t tscCalNs;                    // Monotonic clock at start of calibration
+        double tscNsPerTick;                  // Calibrated TSC period (ns)
+        nstime_t startTime;                   // Process start time
         int epollFD;                          // Epoll file descriptor
         int maxConnIndex;                     // Largest (current) connection index
         int idleConnIndex;                    // Idle connection index
         int mcIdent;                          // Multi-connection identifier
+        int workerIndex;                      // Worker/server process index (0 if parent)
+        int rtCpu;                            // CPU of pinned data-plane (-1 if not pinned)
+        BOOL rtLocked;                        // Memory locked by realtime profile
         struct sendingRate *sendingRates;     // Sending rate table (array)
         int maxSendingRates;                  // Size (rows) of sending rate table
         char *sndBuffer;                      // Send buffer for load PDUs
@@ -422,6 +619,7 @@ struct repository {
         char *rcvDataPtr;                     // Received data pointer for load PDUs
         int rcvDataSize;                      // Received data size in default buffer
         int rcvEcnBits;                       // Received ECN bits in packet header
+        nstime_t rcvTime;                     // Receive time of datagram (kernel timestamp if available)
         struct sockaddr_storage remSas;       // Remote IP sockaddr storage
         socklen_t remSasLen;                  // Remote IP sockaddr storage length
         BOOL isServer;                        // Execute as server
@@ -429,8 +627,20 @@ struct repository {
         int serverCount;                      // Size of server structure array
         int hSpeedThresh;                     // Index of high-speed threshold
         int logFileSize;                      // Current log file size
+        long long sockBufTotal;               // Total of auto-tuned socket buffers
+        BOOL sockBufNoForce;                  // SO_*BUFFORCE not permitted (unprivileged)
+        nstime_t logFlushTime;                // Next log flush and event aggregation check
         int usBandwidth;                      // Current upstream bandwidth
         int dsBandwidth;                      // Current downstream bandwidth
+        int linkSpeed;                        // Link speed of local interface (Mbps)
+        unsigned long long utilBytes[2];      // Delivered bytes for utilization (transmit/receive)
+        unsigned long long utilBytesLast[2];  // Delivered bytes at last utilization sample
+        struct intfCounters intfCountUtil;    // Interface counters at last utilization sample
+        nstime_t utilTime;                    // Time of last utilization sample
+        nstime_t utilCpuTime;                 // Process CPU time at last utilization sample
+        double utilMbps[2];                   // Measured utilization (transmit/receive Mbps)
+        double utilCpu;                       // Measured CPU utilization (%)
+        int utilPending[2];                   // Bandwidth admitted since last sample (transmit/receive)
         int endTimeStatus;                    // Exit status when end time expires
         int actConnCount;                     // Active testing connection count
         int sisConnCount;                     // Sub-interval stats connection count
@@ -444,17 +654,38 @@ struct repository {
         int intfFDAlt;                        // Interface FD (alternate direction)
         unsigned long long intfBytes;         // Last byte counter of interface data
         unsigned long long intfBytesAlt;      // Interface data (alternate direction)
-        struct timespec intfTime;             // Sample time of interface data
-        struct timespec timeOfMax[2];         // Time of maximums (bimodal)
+        nstime_t intfTime;                    // Sample time of interface data
+        BOOL intfNetlink;                     // Interface data via netlink (intfFD is netlink socket)
+        int intfIndex;                        // Interface index (netlink)
+        struct intfCounters intfCount;        // Last interface counters (netlink)
+        struct intfCounters intfCountPs;      // Interface counters at last performance statistics record
+        struct intfCounters intfCountDbg;     // Interface counters at last debug message
+        nstime_t timeOfMax[2];                // Time of maximums (bimodal)
         char *psBuffer;                       // Performance statistics output buffer
         int psBufSize;                        // Performance statistics buffer size
         FILE *psFilePtr;                      // Performance statistics file pointer
         time_t psFileTime;                    // Performance statistics file time (sec)
-        struct timespec psRecordTime;         // Performance statistics record time
+        nstime_t psRecordTime;                // Performance statistics record time
         int psRecordCount;                    // Performance statistics record count
         struct perfStatsCounters psCounters;  // Performance statistics (Counters)
         struct perfStatsMaximums psMaximums;  // Performance statistics (Maximums)
         struct perfStatsAverages psAverages;  // Performance statistics (Averages)
+        BOOL gsoAvail;                        // GSO (UDP_SEGMENT) available at runtime
+        int gsoMaxSegs;                       // GSO maximum segments per send
+        int txProbeMethod[TXPROBE_BURSTS];    // Transmit method per probed burst size
+        int txProbeCost[TXPROBE_BURSTS];      // Transmit cost per datagram (ns)
+        double calibTxPps;                    // Calibrated transmit datagram rate (per core)
+        double calibRxPps;                    // Calibrated receive datagram rate (per core)
+        double calibMbps;                     // Calibrated L3 rate (per core, lower of transmit/receive)
+        int calibCapacity;                    // Capacity derived from calibration (Mbps)
+        double calibDtlbMiss;                 // Calibrated dTLB misses per transmitted datagram (< 0 if unavailable)
+        char *ioBuffer;                       // Region of I/O buffers and connection table
+        size_t ioBufSize;                     // Region size (0 if allocated from heap)
+        int ioBufPages;                       // Region backing (IOBUF_x)
+        struct srcLimit *srcLimit;            // Per-source admission limit table (allocated if enabled)
+        int sharedConn[MAX_SHARED_SOCK];      // Connections of shared test sockets
+        int sharedCount;                      // Shared test socket count
+        int sharedNext;                       // Shared test socket assigned to next test connection
         int actConnections[2];                // Active testing connections (bimodal)
         struct subIntStats sisMax[2];         // Sub-interval maximum stats (bimodal)
         unsigned int sisMaxCECount[2];        // Sub-interval maximum CE counts (bimodal)
@@ -472,6 +703,65 @@ struct repository {
 };
 //----------------------------------------------------------------------------
 //
+// Repeated error events aggregated per connection and event type (see LOG_AGG_INTERVAL)
+//
+#define LOG_EVT_OVERRUN 0 // Transmit overrun
+#define LOG_EVT_SENDERR 1 // Send error
+#define LOG_EVT_TXQEXP  2 // Deferred transmit queue expiry
+#define LOG_EVT_RECVERR 3 // Receive error
+#define LOG_EVT_SRCLIM  4 // Source admission limit
+#define LOG_EVT_DEMUX   5 // Shared test socket datagram not matching a test connection (or truncated)
+#define LOG_EVT_COUNT   6
+struct logEvent {
+        char *label;           // Event label used in summary
+        unsigned int count;    // Suppressed event count
+        unsigned int amount;   // Suppressed event amount (datagrams)
+        nstime_t start;        // Start of aggregation interval
+};
+//
+// Deferred transmit queue (see TXQ_XXX)
+//
+struct txQueueEntry {
+        int offset;           // Offset of message in buffer
+        unsigned int length;  // Message length
+        unsigned int segSize; // GSO segment size (zero if single datagram)
+        int dgCount;          // Datagram count of message
+        nstime_t enqTime;     // Time message was deferred (expires after TXQ_MAX_DELAY)
+};
+struct txQueue {
+        int head;                                   // Index of next entry to send
+        int tail;                                   // Index of next free entry
+        int used;                                   // Buffer bytes used
+        int dgCount;                                // Queued datagram count
+        BOOL epollOut;                              // EPOLLOUT event registered
+        struct txQueueEntry entry[TXQ_MAX_ENTRIES]; // Queued messages
+        char buffer[TXQ_BUFFER_SIZE];               // Queued message data
+};
+//
+// One-way delay variation sketch (log-linear histogram of microsecond values, see PDVSK_XXX)
+//
+#define PDVSK_SUBBITS  3                                                      // Sub-buckets per power of two (log2)
+#define PDVSK_SUBCOUNT (1 << PDVSK_SUBBITS)                                   //
+#define PDVSK_MAXBITS  24                                                     // Maximum value (log2, us), above MAX_UPPER_THRESH
+#define PDVSK_MAXVAL   ((1U << PDVSK_MAXBITS) - 1)                            //
+#define PDVSK_BUCKETS  (PDVSK_SUBCOUNT * (PDVSK_MAXBITS - PDVSK_SUBBITS + 1)) //
+struct pdvSketch {
+        unsigned int count;                 // Sample count
+        unsigned int bucket[PDVSK_BUCKETS]; // Sample counts per bucket
+};
+//
+// Transmit timestamps (SO_TIMESTAMPING) of final message of each load PDU burst (see TXTS_XXX)
+//
+#define TXTS_RING_SIZE 32        // Outstanding timestamped bursts per connection (power of two)
+#define TXTS_RECV_SIZE 16        // Error queue messages read per receive call
+#define TXTS_MAX_DELAY NSECINSEC // Largest plausible host queueing (ns), larger indicates mismatched key
+#define TXTS_WINDOW    64        // Bursts per minimum host queueing window (used for correction)
+struct txTsBurst {
+        unsigned int key;   // Timestamp key (SOF_TIMESTAMPING_OPT_ID) of final message
+        nstime_t sendTime;  // Send time of burst (as carried in load PDUs)
+        nstime_t schedTime; // Packet scheduler (qdisc) entry time, else zero
+};
+//
 // Data structure representing a connection to a device, file, socket, etc.
 //
 struct connection {
@@ -481,7 +771,8 @@ struct connection {
 #define T_CONSOLE  2
 #define T_LOG      3
 #define T_NULL     4
-#define T_MAXTYPES 5
+#define T_SHARED   5 // UDP test connection on shared test socket (descriptor not owned)
+#define T_MAXTYPES 6
         int type;       // Connection type
         int subType;    // Connection subtype
         BOOL connected; // Socket was connected
@@ -512,6 +803,11 @@ struct connection {
         struct sendingRate srStruct; // Sending rate structure
         int srAdjSuppCount;          // Sending rate adj. suppression count
         unsigned int lpduSeqNo;      // Load PDU sequence number
+        int gsoMaxPayload;           // Max payload allowed with GSO (0 = disabled)
+        int gsoMaxSegs;              // GSO maximum segments per send
+        int txMethod;                // Transmit method of current sending rate row
+        struct txQueue *txq;         // Deferred transmit queue (if allocated)
+        int sockBufSize;             // Auto-tuned socket buffer size (0 = not tuned)
         unsigned int spduSeqNo;      // Status PDU sequence number
         int spduSeqErr;              // Status PDU sequence error count
         //
@@ -537,6 +833,25 @@ struct connection {
         int ecnCEThresh;     // ECN CE threshold
         int ecnBleachCount;  // ECN bleach count (-1 after warning generated)
         //
+        BOOL rxDropTrack;        // Socket receive overflow (drop) tracking
+        unsigned int rxDropLast; // Last socket receive overflow counter
+        BOOL rxTimestamp;        // Kernel receive timestamps (SO_TIMESTAMPNS) of load PDUs
+        //
+        BOOL txTimestamp;                          // Transmit timestamps (SO_TIMESTAMPING) of load PDU bursts
+        unsigned int txTsKey;                      // Timestamp key of next timestamped burst
+        unsigned int txTsHead;                     // Oldest outstanding timestamped burst
+        unsigned int txTsTail;                     // Next timestamped burst
+        nstime_t txHostQueue;                      // Minimum host queueing (send to driver) of last window
+        nstime_t txHostQMin;                       // Minimum host queueing of current window
+        unsigned int txHostQSamples;               // Host queueing samples of current window
+        struct txTsBurst txTsRing[TXTS_RING_SIZE]; // Outstanding timestamped bursts
+        //
+        int srcLimSlot; // Source limit table entry (index + 1, else 0)
+        //
+        struct sockaddr_storage peerSas; // Remote address (connection on shared test socket)
+        socklen_t peerSasLen;            // Remote address length
+        int demuxNext;                   // Next connection in demux table chain (index + 1, else 0)
+        //
         int algoCRetryCount;  // AlgoC: Waiting timer till next multiplicative retry
         int algoCRetryThresh; // AlgoC: Threshold for multiplicative retry
         BOOL algoCUpdate;     // AlgoC: Indicates when max send rate was updated
@@ -545,17 +860,19 @@ struct connection {
         unsigned char clientKey[SHA256_KEY_LEN]; // Client key via KDF
         unsigned char serverKey[SHA256_KEY_LEN]; // Server key via KDF
         //
-        struct timespec endTime;      // Connection end time
+        nstime_t endTime;             // Connection end time
         int (*priAction)(int);        // Primary action upon IO
         int (*secAction)(int);        // Secondary action upon IO
-        struct timespec timer1Thresh; // First timer threshold
+        int hotPath;                  // Hot path feature set (HP_x)
+        int (*loadAction)(int);       // Load PDU receive variant of hot path feature set
+        nstime_t timer1Thresh;        // First timer threshold
         int (*timer1Action)(int);     // First action upon expiry
-        struct timespec timer2Thresh; // Second timer threshold
+        nstime_t timer2Thresh;        // Second timer threshold
         int (*timer2Action)(int);     // Second action upon expiry
-        struct timespec timer3Thresh; // Third timer threshold
+        nstime_t timer3Thresh;        // Third timer threshold
         int (*timer3Action)(int);     // Third action upon expiry
         //
-        struct timespec subIntClock; // Sub-interval clock
+        nstime_t subIntClock;        // Sub-interval clock
         unsigned int accumTime;      // Accumulated time
         unsigned int subIntSeqNo;    // Sub-interval sequence number
         struct subIntStats sisAct;   // Sub-interval active stats
@@ -563,6 +880,10 @@ struct connection {
         int subIntCount;             // Sub-interval count
         unsigned int sisActCECount;  // Sub-interval active CE count
         unsigned int sisSavCECount;  // Sub-interval saved CE count
+        unsigned int sisActDropCnt;  // Sub-interval active local drop count
+        unsigned int sisSavDropCnt;  // Sub-interval saved local drop count
+        struct pdvSketch sisActPdv;  // Sub-interval active delay variation sketch
+        struct pdvSketch sisSavPdv;  // Sub-interval saved delay variation sketch
         //
 #define LPDU_HISTORY_SIZE 32 // Size must be power of 2
 #define LPDU_HISTORY_MASK (LPDU_HISTORY_SIZE - 1)
@@ -574,7 +895,9 @@ struct connection {
         unsigned int seqErrDup;                      // Duplicate sum
         //
         BOOL useOwDelVar;          // Use one-way delay instead of RTT
+        int pdvPercentile;         // One-way delay variation percentile for rate adjustment (0 = average)
         int clockDeltaMin;         // Clock delta minimum
+        long long clockDeltaMinUs; // Clock delta minimum (us)
         unsigned int delayVarMin;  // Delay variation minimum
         unsigned int delayVarMax;  // Delay variation maximum
         unsigned int delayVarSum;  // Delay variation sum
@@ -585,18 +908,23 @@ struct connection {
         unsigned int rttVarCnt;    // RTT variation count
         BOOL delayMinUpd;          // Delay minimum(s) updated
         //
-        struct timespec trialIntClock; // Trial interval clock
+        nstime_t trialIntClock;        // Trial interval clock
         unsigned int tiDeltaTime;      // Trial interval delta time
         unsigned int tiRxDatagrams;    // Trial interval receive datagrams
         unsigned int tiRxBytes;        // Trial interval receive bytes
         unsigned int tiRxCECount;      // Trial interval receive CE count
+        unsigned int tiRxDropCnt;      // Trial interval receive local drop count
+        unsigned int tiDelayVarPct;    // Trial interval delay variation percentile (us)
+        struct pdvSketch tiPdv;        // Trial interval delay variation sketch
         //
         int infoCount;             // Info message count
         int warningCount;          // Warning message count
         BOOL rxStoppedLoc;         // Local receive traffic stopped indicator
         BOOL rxStoppedRem;         // Remote receive traffic stopped indicator
-        struct timespec pduRxTime; // Receive time of last load or status PDU
-        struct timespec spduTime;  // Send time in last received status PDU
+        nstime_t pduRxTime;        // Receive time of last load or status PDU
+        nstime_t spduTime;         // Send time in last received status PDU
+        //
+        struct logEvent logEvent[LOG_EVT_COUNT]; // Aggregated error events
 };
 //----------------------------------------------------------------------------
 
@@ -74,6 +74,35 @@ typedef int BOOL;
 #define NSECADJ      (NSECINUSEC / 2)       // nsec adjustment for rounding
 #define NSECADJ_MSEC (NSECINMSEC / 2)       // nsec adjustment for rounding
 
+//----------------------------------------------------------------------------
+// 64-bit nanosecond time (clock value or interval) and its operations
+//----------------------------------------------------------------------------
+typedef int64_t nstime_t;
+//
+// Read clock as nanosecond time
+//
+#define nsgettime(clk, nsp)                                                             \
+        do {                                                                            \
+                struct timespec _nstspec;                                               \
+                clock_gettime((clk), &_nstspec);                                        \
+                *(nsp) = (nstime_t) _nstspec.tv_sec * NSECINSEC + _nstspec.tv_nsec;     \
+        } while (0)
+//
+// Convert timespec to nanosecond time
+//
+#define tspec2ns(a) ((nstime_t) (a)->tv_sec * NSECINSEC + (a)->tv_nsec)
+//
+// Seconds and nanoseconds (within second) of nanosecond time, for protocol fields and output (non-negative values)
+//
+#define nssec(ns)  ((time_t) ((ns) / NSECINSEC))
+#define nsnsec(ns) ((long) ((ns) % NSECINSEC))
+//
+// Convert nanosecond time to us and ms (rounded, consistent with timespec conversions for negative values)
+//
+#define nsfloor(n, d) (((n) >= 0) ? (n) / (d) : ((n) - (d) + 1) / (d))
+#define nsusec(ns)    nsfloor((ns) + NSECADJ, NSECINUSEC)
+#define nsmsec(ns)    nsfloor((ns) + NSECADJ_MSEC, NSECINMSEC)
+
 //----------------------------------------------------------------------------
 // Macros for timespec operations
 //----------------------------------------------------------------------------
@@ -93,6 +93,15 @@
 #include <arpa/inet.h>
 #include <sys/epoll.h>
 #include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #ifdef AUTH_KEY_ENABLE
 #include <openssl/hmac.h>
 #include <openssl/x509.h>
@@ -131,6 +140,17 @@ BOOL verify_ctrlpdu(int, struct controlHdrSR *, struct controlHdrTA *, char *, c
 #ifdef __linux__
 int kdf_hmac_sha256(char *, uint32_t, unsigned char *, unsigned char *);
 #endif
+struct ctlJob;
+struct ctlResp;
+static int _setupreq(int, struct ctlJob *);
+static void _close_testfd(struct ctlJob *);
+static int _ctl_recvmmsg(int, struct ctlJob *, int, unsigned int *);
+static void _ctl_restore(struct ctlJob *);
+static struct ctlResp *_queue_setuprsp(int, struct controlHdrSR *, int, char *, char *);
+static void _flush_setuprsp(int);
+static int _srclimit_admit(void);
+static int _test_socket(BOOL, int);
+static int _sockpool_get(void);
 
 //----------------------------------------------------------------------------
 //
@@ -158,6 +178,82 @@ extern cJSON *json_top, *json_output;
 #define TESTHDR_LINE                                                                                                 \
         "%s%s Test Int(sec): %d, DelayVar Th(ms): %d-%d [%s], Trial Int(ms): %d, Ignore OoO/Dup: %s, Payload: %s,\n" \
         "  ID: %d, SR Index: %s, Cong. Th: %d, HS Delta: %d, SeqErr Th: %d, Algo: %s, Conn: %d, DSCP+ECN: %d, CE Th: %d%s\n"
+//
+// Setup request received and prepared by the control thread (see start_ctlthread())
+//
+struct ctlJob {
+        unsigned char pdu[CHSR_SIZE_CVER];  // Setup request PDU (as received)
+        int pduSize;                        // Actual size of received PDU
+        struct sockaddr_storage remSas;     // Source address
+        socklen_t remSasLen;                // Source address length
+        char addrstr[INET6_ADDR_STRLEN];    // Source address (text)
+        char portstr[8];                    // Source port (text)
+        BOOL authDone;                      // Authentication validated
+        int authStatus;                     // Authentication status (from validate_auth)
+        unsigned char ckey[SHA256_KEY_LEN]; // Client KDF key
+        unsigned char skey[SHA256_KEY_LEN]; // Server KDF key
+        int testFd;                         // Prepared (bound) test socket, else -1
+};
+static struct ctlJob ctlBatch[CTRLMMSG_SIZE]; // Setup requests received on control port (without control thread)
+static int ctlBatchCount = 0;                 // Setup requests in batch
+//
+// Setup response (and null request) awaiting batched send (see _flush_setuprsp())
+//
+struct ctlResp {
+        unsigned char pdu[CHSR_SIZE_CVER];     // Setup response PDU
+        int pduSize;                           // Setup response PDU size
+        unsigned char nullPdu[CHNR_SIZE_CVER]; // Null request PDU (sent from test connection)
+        BOOL nullReq;                          // Null request to be sent
+        int testConn;                          // Test connection (-1 if setup request was rejected)
+        struct sockaddr_storage remSas;        // Destination address
+        socklen_t remSasLen;                   // Destination address length
+        char addrstr[INET6_ADDR_STRLEN];       // Destination address (text)
+        char portstr[8];                       // Destination port (text)
+};
+static struct ctlResp ctlResp[CTRLMMSG_SIZE]; // Setup responses awaiting send
+static int ctlRespCount = 0;                  // Setup responses awaiting send
+//
+// Pool of pre-created (bound and configured) test sockets, owned by the control thread if used
+//
+static struct {
+        int fd[SOCKPOOL_SIZE];        // Pooled sockets
+        int count;                    // Pooled socket count
+        struct sockaddr_storage sas;  // Cached bind address (ephemeral port)
+        socklen_t sasLen;             // Cached bind address length (0 if unavailable)
+        atomic_uint emptyCount;       // Test sockets created while pool was empty
+} sockPool;
+#ifdef CONTROL_THREAD
+//
+// Single-producer/single-consumer lock-free queue from control thread (advances head) to data-plane loop
+// (advances tail)
+//
+static struct {
+        atomic_uint head;                // Next entry written by control thread
+        atomic_uint tail;                // Next entry read by data-plane loop
+        atomic_uint dropCount;           // Requests dropped because queue was full
+        atomic_uint sockDrops;           // Requests dropped by control socket (receive overflow)
+        atomic_uint rxCount;             // Receive calls
+        atomic_uint rxTotal;             // Received datagrams
+        atomic_int exit;                 // Request for control thread to exit
+        struct ctlJob job[CTLQ_SIZE];    // Queue entries
+} ctlQueue;
+static pthread_t ctlThread;              // Control thread
+static int ctlConn = -1;                 // Control port connection (serviced by control thread)
+#endif
+//
+// Bandwidth ledger of server, shared by all preforked server processes (see prefork_start())
+//
+struct ledgerCount {
+        atomic_int usBandwidth; // Upstream bandwidth allocated
+        atomic_int dsBandwidth; // Downstream bandwidth allocated
+        atomic_int connCount;   // Test connections
+};
+static struct {
+        struct ledgerCount host;              // Host-wide totals (enforced against configured capacity)
+        struct ledgerCount proc[MAX_WORKERS]; // Contribution of each server process (reclaimed if it ends)
+} localLedger, *ledger = &localLedger;
+static pid_t preforkPid[MAX_WORKERS]; // Server process IDs (parent only)
+static time_t preforkCheck = 0;       // Time (sec) of last check for ended server processes
 
 //----------------------------------------------------------------------------
 // Function definitions
@@ -173,6 +269,7 @@ void init_conn(int connindex, BOOL cleanup) {
         // Cleanup prior to clear and init
         //
         if (cleanup) {
+                log_summary(connindex, TRUE);
                 if (connindex == repo.maxConnIndex) {
                         for (i = connindex - 1; i >= 0; i--) {
                                 if (conn[i].fd == -1)
@@ -181,7 +278,9 @@ void init_conn(int connindex, BOOL cleanup) {
                                 break;
                         }
                 }
-                if (c->fd >= 0) {
+                if (c->type == T_SHARED) {
+                        demux_remove(connindex); // Shared test socket remains open
+                } else if (c->fd >= 0) {
 #ifdef __linux__
                         // Event needed to be non-null before kernel version 2.6.9
                         epoll_ctl(repo.epollFD, EPOLL_CTL_DEL, c->fd, NULL);
@@ -190,12 +289,18 @@ void init_conn(int connindex, BOOL cleanup) {
                 }
                 if (c->outputFPtr != NULL)
                         fclose(c->outputFPtr);
+                if (c->txq != NULL)
+                        free(c->txq);
+                repo.sockBufTotal -= (long long) c->sockBufSize;
+                if (c->srcLimSlot > 0)
+                        repo.srcLimit[c->srcLimSlot - 1].connCount--;
         }
 
         //
         // Clear structure
         //
         memset(&conn[connindex], 0, sizeof(struct connection));
+        select_hotpath(connindex); // Common (featureless) hot path
 
         //
         // Initialize non-zero values
@@ -226,9 +331,8 @@ int null_action(int connindex) {
 //
 int send_setupreq(int connindex, int mcIndex, int serverIndex) {
         register struct connection *c = &conn[connindex], *a;
-        int i, fd, var;
-        struct timespec tspecvar;
-        char addrstr[INET6_ADDR_STRLEN], portstr[8], intfpath[IFNAMSIZ + 64];
+        int var;
+        char addrstr[INET6_ADDR_STRLEN], portstr[8];
         struct controlHdrSR *cHdrSR = (struct controlHdrSR *) repo.defBuffer;
 #ifdef AUTH_KEY_ENABLE
         char *key;
@@ -239,24 +343,12 @@ int send_setupreq(int connindex, int mcIndex, int serverIndex) {
         //
         if (c->mcIndex == 0) {
                 //
-                // Open local sysfs interface statistics
+                // Open local interface statistics
                 //
-                if (*conf.intfName) {
-                        for (i = 0; i < 2; i++) {
-                                var = sprintf(intfpath, "/sys/class/net/%s/statistics/", conf.intfName);
-                                if ((conf.usTesting && i == 0) || (conf.dsTesting && i == 1))
-                                        strcat(&intfpath[var], "tx_bytes");
-                                else
-                                        strcat(&intfpath[var], "rx_bytes");
-                                if ((fd = open(intfpath, O_RDONLY)) < 0) {
-                                        var = sprintf(scratch, "OPEN ERROR: %s (%s)\n", strerror(errno), intfpath);
-                                        send_proc(errConn, scratch, var);
-                                        return -1;
-                                }
-                                if (i == 0)
-                                        repo.intfFD = fd;
-                                else
-                                        repo.intfFDAlt = fd;
+                if (*conf.intfName && repo.workerIndex == 0) { // Interface rate is only output by parent of workers
+                        if ((var = open_intf_stats()) > 0) {
+                                send_proc(errConn, scratch, var);
+                                return -1;
                         }
                 }
                 //
@@ -268,9 +360,7 @@ int send_setupreq(int connindex, int mcIndex, int serverIndex) {
                 } else {
                         a->testType = TEST_TYPE_DS;
                 }
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = AGG_QUERY_TIME * NSECINMSEC;
-                tspecplus(&repo.systemClock, &tspecvar, &a->timer1Thresh);
+                a->timer1Thresh = repo.monoClock + AGG_QUERY_TIME * NSECINMSEC;
                 a->timer1Action = &agg_query_proc;
                 a->state        = S_DATA; // Allow for data timer processing
         }
@@ -323,7 +413,7 @@ int send_setupreq(int connindex, int mcIndex, int serverIndex) {
                 }
                 // Create KDF keys via shared key and timestamp (identical authUnixTime values
                 // must be used for KDF and initial PDU to server)
-                kdf_hmac_sha256(key, repo.systemClock.tv_sec, c->clientKey, c->serverKey);
+                kdf_hmac_sha256(key, nssec(repo.systemClock), c->clientKey, c->serverKey);
                 insert_auth(conf.keyId, c->clientKey, (unsigned char *) &cHdrSR->authMode, (unsigned char *) cHdrSR,
                             CHSR_SIZE_CVER);
         }
@@ -357,9 +447,7 @@ int send_setupreq(int connindex, int mcIndex, int serverIndex) {
         //
         // Set timeout timer awaiting test initiation
         //
-        tspecvar.tv_sec  = TIMEOUT_NOTRAFFIC;
-        tspecvar.tv_nsec = 0;
-        tspecplus(&repo.systemClock, &tspecvar, &c->timer3Thresh);
+        c->timer3Thresh = repo.monoClock + (nstime_t) TIMEOUT_NOTRAFFIC * NSECINSEC;
         c->timer3Action = &timeout_testinit;
 
         return 0;
@@ -375,7 +463,7 @@ int timeout_testinit(int connindex) {
         //
         // Clear timeout timer
         //
-        tspecclear(&c->timer3Thresh);
+        c->timer3Thresh = 0;
         c->timer3Action = &null_action;
 
         //
@@ -385,7 +473,7 @@ int timeout_testinit(int connindex) {
                       repo.server[c->serverIndex].port);
         send_proc(errConn, scratch, var);
         repo.endTimeStatus = STATUS_WARNBASE + WARN_SRV_TIMEOUT; // ErrorStatus
-        tspeccpy(&c->endTime, &repo.systemClock);
+        c->endTime = repo.monoClock;
 
         return 0;
 }
@@ -393,37 +481,85 @@ int timeout_testinit(int connindex) {
 //
 // Server function to service client setup request received on control port
 //
-// A new test connection is allocated and a setup response is sent back
+// A new test connection is allocated and a setup response is sent back. Setup requests are received in
+// batches (see recv_setupreq) and the setup responses are sent together once the batch has been processed.
 //
 int service_setupreq(int connindex) {
-        register struct connection *c = &conn[connindex];
-        int i = -1, var, pver, mbw = 0, currbw = repo.dsBandwidth, errmsg;
-        BOOL usbw = FALSE;
-        struct timespec tspecvar;
+        int i;
+
+        for (i = 0; i < ctlBatchCount; i++) {
+                getnameinfo((struct sockaddr *) &ctlBatch[i].remSas, ctlBatch[i].remSasLen, ctlBatch[i].addrstr,
+                            INET6_ADDR_STRLEN, ctlBatch[i].portstr, sizeof(ctlBatch[i].portstr), NI_NUMERICHOST | NI_NUMERICSERV);
+                _ctl_restore(&ctlBatch[i]);
+                _setupreq(connindex, &ctlBatch[i]);
+        }
+        ctlBatchCount = 0;
+        _flush_setuprsp(connindex);
+
+        return 0;
+}
+//
+// Process a received setup request, with authentication and test socket already prepared if handed over by
+// the control thread (else performed inline)
+//
+static int _setupreq(int connindex, struct ctlJob *job) {
+        int i = -1, var, pver, mbw = 0, errmsg, srcslot, usbwtot, dsbwtot, conns;
+        BOOL usbw = FALSE, bwheld = FALSE;
         char addrstr[INET6_ADDR_STRLEN], portstr[8];
         struct controlHdrSR *cHdrSR        = (struct controlHdrSR *) repo.defBuffer;
         struct controlHdrNR *cHdrNR        = (struct controlHdrNR *) repo.defBuffer;
         struct perfStatsCounters *psC      = &repo.psCounters;
+        struct authOverlay *ao;
+        struct ctlResp *resp;
         unsigned char ckey[SHA256_KEY_LEN] = {0}, skey[SHA256_KEY_LEN] = {0}; // Must be initialized to zero
 
         //
         // Verify PDU
         //
-        getnameinfo((struct sockaddr *) &repo.remSas, repo.remSasLen, addrstr, INET6_ADDR_STRLEN, portstr, sizeof(portstr),
-                    NI_NUMERICHOST | NI_NUMERICSERV);
+        strcpy(addrstr, job->addrstr);
+        strcpy(portstr, job->portstr);
         if (!verify_ctrlpdu(connindex, cHdrSR, NULL, addrstr, portstr)) {
+                _close_testfd(job);
                 return 0; // Ignore bad PDU
         }
         psC->setupRequestCnt++;
 
+        //
+        // Enforce per-source setup request rate if configured (silently drop, as when flooded)
+        //
+        srcslot = 0;
+        if (repo.srcLimit != NULL) {
+                if ((srcslot = _srclimit_admit()) < 0) {
+                        _close_testfd(job);
+                        if (log_event(connindex, LOG_EVT_SRCLIM, "SOURCE LIMIT", 0)) {
+                                var = sprintf(scratch, "ERROR: Source rate limit exceeded by setup request from %s:%s\n", addrstr,
+                                              portstr);
+                                send_proc(errConn, scratch, var);
+                        }
+                        return 0;
+                }
+        }
+
         //
         // Validate authentication if included and configured
         //
         errmsg = 0;
         pver   = (int) ntohs(cHdrSR->protocolVer);
         if (cHdrSR->authMode == AUTHMODE_1 && (*conf.authKey != '\0' || conf.keyFile != NULL)) {
-                i = validate_auth(pver, ckey, skey, (unsigned char *) &cHdrSR->authMode, (unsigned char *) cHdrSR,
-                                  (size_t) repo.rcvDataSize);
+                if (job->authDone) {
+                        //
+                        // Use result from control thread (validated using a copy, so clear digest and checksum here)
+                        //
+                        i = job->authStatus;
+                        memcpy(ckey, job->ckey, SHA256_KEY_LEN);
+                        memcpy(skey, job->skey, SHA256_KEY_LEN);
+                        ao = (struct authOverlay *) (&cHdrSR->authMode - AO_MODE_OFFSET);
+                        memset(ao->authDigest, 0, AUTH_DIGEST_LENGTH);
+                        ao->checkSum = 0;
+                } else {
+                        i = validate_auth(pver, ckey, skey, (unsigned char *) &cHdrSR->authMode, (unsigned char *) cHdrSR,
+                                          (size_t) repo.rcvDataSize);
+                }
                 if (i > 0) {
                         errmsg              = sprintf(scratch, "ERROR: Authentication failure of setup request from");
                         cHdrSR->cmdResponse = CHSR_CRSP_AUTHFAIL;
@@ -441,8 +577,7 @@ int service_setupreq(int connindex) {
         mbw = (int) (ntohs(cHdrSR->maxBandwidth) & ~CHSR_USDIR_BIT); // Obtain max bandwidth while ignoring upstream bit
         if (errmsg == 0) {
                 if (ntohs(cHdrSR->maxBandwidth) & CHSR_USDIR_BIT) {
-                        usbw   = TRUE; // Max bandwidth is for upstream
-                        currbw = repo.usBandwidth;
+                        usbw = TRUE; // Max bandwidth is for upstream
                 }
                 if (pver < PROTOCOL_MIN || pver > PROTOCOL_VER) {
                         errmsg              = sprintf(scratch, "ERROR: Invalid version (%d) in setup request from", pver);
@@ -473,13 +608,30 @@ int service_setupreq(int connindex) {
                         cHdrSR->cmdResponse = CHSR_CRSP_NOMAXBW;
                         psC->invalidSetupOption++;
 
-                } else if (conf.maxBandwidth > 0 && currbw + mbw > conf.maxBandwidth) {
+                } else if (conf.maxBandwidth > 0 && !(bwheld = ledger_reserve(usbw, mbw))) { // Host-wide capacity
                         errmsg =
                             sprintf(scratch, "ERROR: Capacity exceeded (%d.%d) by required bandwidth (%d) in setup request from",
                                     cHdrSR->mcIndex, (int) ntohs(cHdrSR->mcIdent), mbw);
                         cHdrSR->cmdResponse = CHSR_CRSP_CAPEXC;
                         psC->bandwidthExceeded++;
 
+                } else if (conf.utilTarget > 0 && !admit_utilization(usbw, mbw)) {
+                        errmsg = sprintf(scratch,
+                                         "ERROR: Utilization target exceeded (Tx/Rx Mbps: %.0f/%.0f, CPU: %.0f%%) by setup "
+                                         "request from",
+                                         repo.utilMbps[0], repo.utilMbps[1], repo.utilCpu);
+                        cHdrSR->cmdResponse = CHSR_CRSP_CAPEXC;
+                        psC->utilizationExceeded++;
+
+                } else if (srcslot > 0 && conf.srcMaxConn > 0 && repo.srcLimit[srcslot - 1].connCount >= conf.srcMaxConn) {
+                        errmsg = sprintf(scratch, "ERROR: Source connection limit (%d) exceeded by setup request from",
+                                         conf.srcMaxConn);
+                        if (!log_event(connindex, LOG_EVT_SRCLIM, "SOURCE LIMIT", 0))
+                                errmsg = 0; // Aggregated with other source limit events
+                        cHdrSR->cmdResponse = CHSR_CRSP_CONNFAIL;
+                        repo.srcLimit[srcslot - 1].connLimited++;
+                        psC->srcConnLimited++;
+
                 } else if (cHdrSR->authMode != AUTHMODE_0 && *conf.authKey == '\0' && conf.keyFile == NULL) {
                         errmsg              = sprintf(scratch, "ERROR: Unexpected authentication in setup request from");
                         cHdrSR->cmdResponse = CHSR_CRSP_AUTHNC;
@@ -505,9 +657,25 @@ int service_setupreq(int connindex) {
                         send_proc(monConn, scratch, var);
                 }
                 //
-                // Obtain new test connection for this client
+                // Obtain new test connection for this client (using test socket prepared by control thread if available),
+                // else assign shared test socket (round robin) where its traffic is identified by client address
                 //
-                if ((i = new_conn(-1, repo.server[0].ip, 0, T_UDP, &recv_proc, &service_actreq)) < 0) {
+                var         = job->testFd;
+                job->testFd = -1; // Ownership passed to connection
+                if (repo.sharedCount > 0) {
+                        var = conn[repo.sharedConn[repo.sharedNext]].fd;
+                        if (++repo.sharedNext >= repo.sharedCount)
+                                repo.sharedNext = 0;
+                        if ((i = new_conn(var, repo.server[0].ip, 0, T_SHARED, &recv_proc, &service_actreq)) >= 0)
+                                demux_add(i, &repo.remSas, repo.remSasLen);
+                } else {
+#ifndef CONTROL_THREAD
+                        if (var < 0)
+                                var = _sockpool_get(); // Socket pool owned by data-plane loop
+#endif
+                        i = new_conn(var, repo.server[0].ip, 0, T_UDP, &recv_proc, &service_actreq);
+                }
+                if (i < 0) {
                         errmsg              = 0; // Error message already output as part of allocation failure
                         cHdrSR->cmdResponse = CHSR_CRSP_CONNFAIL;
                         psC->connCreateFail++;
@@ -518,6 +686,9 @@ int service_setupreq(int connindex) {
                 //
                 // Output error message if needed (append source info), send back setup response, and exit
                 //
+                _close_testfd(job);
+                if (bwheld)
+                        ledger_update(usbw, -mbw, 0); // Release bandwidth reserved above
                 if (errmsg > 0) {
                         errmsg += sprintf(&scratch[errmsg], " %s:%s\n", addrstr, portstr);
                         send_proc(errConn, scratch, errmsg);
@@ -531,7 +702,7 @@ int service_setupreq(int connindex) {
                 cHdrSR->checkSum = checksum(cHdrSR, repo.rcvDataSize);
 #endif
                 psC->setupRejectCnt++;
-                send_proc(connindex, (char *) cHdrSR, repo.rcvDataSize);
+                _queue_setuprsp(connindex, cHdrSR, -1, addrstr, portstr);
                 return 0;
         }
 
@@ -544,6 +715,7 @@ int service_setupreq(int connindex) {
         conn[i].mcIndex     = (int) cHdrSR->mcIndex;
         conn[i].mcCount     = (int) cHdrSR->mcCount;
         conn[i].mcIdent     = (int) ntohs(cHdrSR->mcIdent);
+        ledger_update(usbw, 0, 1); // Count test connection (until server_finish)
         if (conf.maxBandwidth > 0) {
                 conn[i].maxBandwidth = mbw; // Save bandwidth for adjustment at end of test
                 if (usbw) {
@@ -554,11 +726,16 @@ int service_setupreq(int connindex) {
                         repo.dsBandwidth += mbw;         // Update current downstream bandwidth
                 }
                 if (conf.verbose && mbw > 0) {
-                        var = sprintf(scratch, "[%d]Bandwidth of %d allocated (New USBW: %d, DSBW: %d)\n", i, mbw, repo.usBandwidth,
-                                      repo.dsBandwidth);
+                        ledger_totals(&usbwtot, &dsbwtot, &conns);
+                        var = sprintf(scratch, "[%d]Bandwidth of %d allocated (New USBW: %d, DSBW: %d, Conns: %d)\n", i, mbw,
+                                      usbwtot, dsbwtot, conns);
                         send_proc(monConn, scratch, var);
                 }
         }
+        if (srcslot > 0) {
+                conn[i].srcLimSlot = srcslot; // Released when connection is closed
+                repo.srcLimit[srcslot - 1].connCount++;
+        }
         conn[i].authMode = (int) cHdrSR->authMode;
         memcpy(conn[i].clientKey, ckey, SHA256_KEY_LEN);
         memcpy(conn[i].serverKey, skey, SHA256_KEY_LEN);
@@ -566,9 +743,7 @@ int service_setupreq(int connindex) {
         //
         // Set end time (used as watchdog) in case client goes quiet
         //
-        tspecvar.tv_sec  = TIMEOUT_NOTRAFFIC;
-        tspecvar.tv_nsec = 0;
-        tspecplus(&repo.systemClock, &tspecvar, &conn[i].endTime);
+        conn[i].endTime = repo.monoClock + (nstime_t) TIMEOUT_NOTRAFFIC * NSECINSEC;
 
         //
         // Send setup response to client with port number of new test connection
@@ -584,16 +759,10 @@ int service_setupreq(int connindex) {
         cHdrSR->checkSum = checksum(cHdrSR, repo.rcvDataSize);
 #endif
         psC->setupAcceptCnt++;
-        if (send_proc(connindex, (char *) cHdrSR, repo.rcvDataSize) != repo.rcvDataSize)
-                return 0;
-        if (conf.verbose) {
-                var = sprintf(scratch, "[%d]Setup response (%d.%d) sent from %s:%d to %s:%s\n", connindex, conn[i].mcIndex,
-                              conn[i].mcIdent, c->locAddr, c->locPort, addrstr, portstr);
-                send_proc(monConn, scratch, var);
-        }
+        resp = _queue_setuprsp(connindex, cHdrSR, i, addrstr, portstr);
 
         //
-        // Send null request to client from new test connection (to potentially open firewall for server)
+        // Queue null request to client from new test connection (to potentially open firewall for server)
         // NOTE: The protocol version check can be commented out so that a null request will also be sent to
         //       legacy clients. Although this may result in a "ALERT: Received invalid test activation response..."
         //       error message on them, it would allow a newer server to no longer require that all its ephemeral ports
@@ -613,18 +782,794 @@ int service_setupreq(int connindex) {
 #ifdef ADD_HEADER_CSUM
                 cHdrNR->checkSum = checksum(cHdrNR, CHNR_SIZE_CVER);
 #endif
-                if (send_proc(i, (char *) cHdrNR, CHNR_SIZE_CVER) != CHNR_SIZE_CVER)
-                        return 0;
+                memcpy(resp->nullPdu, cHdrNR, CHNR_SIZE_CVER);
+                resp->nullReq = TRUE;
+        }
+        return 0;
+}
+//
+// Look up (or add) source prefix of setup request in per-source limit table and consume a token if rate limited
+//
+// Return table entry (index + 1), 0 if source is untracked (all probed entries are active), or -1 if the setup
+// request exceeds the source rate
+//
+static int _srclimit_admit(void) {
+        int i, plen;
+        unsigned int hash, burst;
+        long long msec, delta;
+        struct in6_addr prefix;
+        struct srcLimit *s, *e = NULL, *cand = NULL;
+        struct perfStatsCounters *psC = &repo.psCounters;
+
+        //
+        // Obtain source prefix (IPv4 as IPv4-mapped address)
+        //
+        memset(&prefix, 0, sizeof(prefix));
+        if (repo.remSas.ss_family == AF_INET) {
+                prefix.s6_addr[10] = prefix.s6_addr[11] = 0xff;
+                memcpy(&prefix.s6_addr[12], &((struct sockaddr_in *) &repo.remSas)->sin_addr, 4);
+        } else {
+                memcpy(&prefix, &((struct sockaddr_in6 *) &repo.remSas)->sin6_addr, sizeof(prefix));
+        }
+        if (IN6_IS_ADDR_V4MAPPED(&prefix))
+                plen = 96 + SRCLIM_PREFIX4;
+        else
+                plen = SRCLIM_PREFIX6;
+        for (i = 0; i < 16; i++, plen -= 8) {
+                if (plen <= 0)
+                        prefix.s6_addr[i] = 0;
+                else if (plen < 8)
+                        prefix.s6_addr[i] &= (unsigned char) (0xff << (8 - plen));
+        }
+
+        //
+        // Probe entries (FNV-1a hash), noting a candidate to replace if not found (unused entry, else the least
+        // recently used entry without active connections)
+        //
+        hash = 2166136261u;
+        for (i = 0; i < 16; i++)
+                hash = (hash ^ prefix.s6_addr[i]) * 16777619u;
+        for (i = 0; i < SRCLIM_PROBE_MAX; i++) {
+                s = &repo.srcLimit[(hash + (unsigned int) i) & (SRCLIM_TABLE_SIZE - 1)];
+                if (s->inUse && memcmp(&s->prefix, &prefix, sizeof(prefix)) == 0) {
+                        e = s;
+                        break;
+                }
+                if (s->connCount > 0)
+                        continue;
+                if (cand == NULL || (!s->inUse && cand->inUse) || (s->inUse && cand->inUse && s->lastMsec < cand->lastMsec))
+                        cand = s;
+        }
+        burst = (unsigned int) (conf.srcRate * SRCLIM_BURST_SEC);
+        if (burst < MAX_MC_COUNT)
+                burst = MAX_MC_COUNT;
+        msec = (long long) (repo.monoClock / NSECINMSEC);
+        if (e == NULL) {
+                if ((e = cand) == NULL)
+                        return 0; // Untracked
+                memset(e, 0, sizeof(struct srcLimit));
+                e->inUse    = TRUE;
+                e->prefix   = prefix;
+                e->tokens   = burst * MSECINSEC;
+                e->lastMsec = msec;
+        }
+
+        //
+        // Refill token bucket based on elapsed time and consume token
+        //
+        if (conf.srcRate > 0) {
+                delta = msec - e->lastMsec;
+                if (delta > (long long) burst * MSECINSEC)
+                        delta = (long long) burst * MSECINSEC; // Limit to avoid overflow
+                if (delta > 0)
+                        e->tokens += (unsigned int) (delta * conf.srcRate);
+                if (e->tokens > burst * MSECINSEC)
+                        e->tokens = burst * MSECINSEC;
+                e->lastMsec = msec;
+                if (e->tokens < MSECINSEC) {
+                        e->rateLimited++;
+                        psC->srcRateLimited++;
+                        return -1;
+                }
+                e->tokens -= MSECINSEC;
+        } else {
+                e->lastMsec = msec;
+        }
+        return (int) (e - repo.srcLimit) + 1;
+}
+//
+// Restore setup request (received in batch or by control thread) as if just read from control port
+//
+static void _ctl_restore(struct ctlJob *job) {
+        repo.rcvDataSize = job->pduSize; // Actual size (oversized PDU was truncated and is rejected by verify_ctrlpdu)
+        memcpy(repo.defBuffer, job->pdu, (job->pduSize < (int) sizeof(job->pdu)) ? job->pduSize : (int) sizeof(job->pdu));
+        memcpy(&repo.remSas, &job->remSas, job->remSasLen);
+        repo.remSasLen = job->remSasLen;
+}
+//----------------------------------------------------------------------------
+//
+// Server function to receive a batch of setup requests on control port
+//
+int recv_setupreq(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var;
+        unsigned int dropcnt          = c->rxDropLast;
+        struct perfStatsAverages *psA = &repo.psAverages;
+        struct perfStatsCounters *psC = &repo.psCounters;
+
+        if ((ctlBatchCount = _ctl_recvmmsg(c->fd, ctlBatch, CTRLMMSG_SIZE, &dropcnt)) < 0) {
+                ctlBatchCount = 0;
+                if ((var = socket_error(connindex, errno, "RECVMMSG/RECVFROM")) > 0) {
+                        if (!conf.errSuppress)
+                                send_proc(errConn, scratch, var);
+                }
+                return 0;
+        }
+        if (conf.psFile != NULL) { // Update performance statistics
+                psA->ctrlRxCount++;
+                psA->ctrlRxTotal += (unsigned int) ctlBatchCount;
+        }
+        if (dropcnt != c->rxDropLast) {
+                psC->ctrlSocketDrops += dropcnt - c->rxDropLast; // Allow for counter wrap
+                c->rxDropLast = dropcnt;
+        }
+        return ctlBatchCount;
+}
+//
+// Receive up to 'count' datagrams from control port into setup request entries
+//
+// Return number of datagrams received, or -1 with errno set. The cumulative socket receive overflow counter
+// is returned via 'dropcnt' if available (left unchanged otherwise). May be called by control thread.
+//
+static int _ctl_recvmmsg(int fd, struct ctlJob *job, int count, unsigned int *dropcnt) {
+        int i, n;
+#ifdef HAVE_RECVMMSG
+        struct mmsghdr mmsg[CTRLMMSG_SIZE];
+        struct iovec iov[CTRLMMSG_SIZE];
+#ifdef HAVE_SO_RXQ_OVFL
+        char cmsgbuf[CTRLMMSG_SIZE][CMSG_SPACE(sizeof(uint32_t))];
+        struct cmsghdr *cmsg;
+#endif
+#endif
+
+        if (count > CTRLMMSG_SIZE)
+                count = CTRLMMSG_SIZE;
+#if !defined(HAVE_RECVMMSG) || !defined(HAVE_SO_RXQ_OVFL)
+        (void) dropcnt; // Only available via recvmmsg() control messages
+#endif
+#ifdef HAVE_RECVMMSG
+        memset(mmsg, 0, count * sizeof(struct mmsghdr));
+        for (i = 0; i < count; i++) {
+                iov[i].iov_base             = job[i].pdu;
+                iov[i].iov_len              = sizeof(job[i].pdu);
+                mmsg[i].msg_hdr.msg_iov     = &iov[i];
+                mmsg[i].msg_hdr.msg_iovlen  = 1;
+                mmsg[i].msg_hdr.msg_name    = &job[i].remSas;
+                mmsg[i].msg_hdr.msg_namelen = sizeof(job[i].remSas);
+#ifdef HAVE_SO_RXQ_OVFL
+                mmsg[i].msg_hdr.msg_control    = cmsgbuf[i];
+                mmsg[i].msg_hdr.msg_controllen = sizeof(cmsgbuf[i]);
+#endif
+        }
+        if ((n = recvmmsg(fd, mmsg, count, MSG_TRUNC, NULL)) < 0)
+                return -1;
+        for (i = 0; i < n; i++) {
+                job[i].pduSize   = (int) mmsg[i].msg_len; // Actual size (although truncated)
+                job[i].remSasLen = mmsg[i].msg_hdr.msg_namelen;
+#ifdef HAVE_SO_RXQ_OVFL
+                for (cmsg = CMSG_FIRSTHDR(&mmsg[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&mmsg[i].msg_hdr, cmsg)) {
+                        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL)
+                                *dropcnt = *(uint32_t *) CMSG_DATA(cmsg); // Cumulative socket drops
+                }
+#endif
+        }
+#else
+        job[0].remSasLen = sizeof(job[0].remSas);
+        if ((n = (int) recvfrom(fd, job[0].pdu, sizeof(job[0].pdu), MSG_TRUNC, (struct sockaddr *) &job[0].remSas,
+                                &job[0].remSasLen)) < 0)
+                return -1;
+        job[0].pduSize = n;
+        n              = 1;
+#endif
+        for (i = 0; i < n; i++) {
+                job[i].authDone = FALSE;
+                job[i].testFd   = -1;
+                memset(job[i].ckey, 0, SHA256_KEY_LEN);
+                memset(job[i].skey, 0, SHA256_KEY_LEN);
+        }
+        return n;
+}
+//
+// Queue setup response (from current remote address) for batched send, flushing queue first if full
+//
+static struct ctlResp *_queue_setuprsp(int connindex, struct controlHdrSR *cHdrSR, int testconn, char *addrstr,
+                                       char *portstr) {
+        struct ctlResp *resp;
+
+        if (ctlRespCount >= CTRLMMSG_SIZE)
+                _flush_setuprsp(connindex);
+        resp          = &ctlResp[ctlRespCount++];
+        resp->pduSize = repo.rcvDataSize;
+        memcpy(resp->pdu, cHdrSR, resp->pduSize);
+        resp->nullReq  = FALSE;
+        resp->testConn = testconn;
+        memcpy(&resp->remSas, &repo.remSas, repo.remSasLen);
+        resp->remSasLen = repo.remSasLen;
+        strcpy(resp->addrstr, addrstr);
+        strcpy(resp->portstr, portstr);
+        return resp;
+}
+//
+// Send queued setup responses via sendmmsg(), followed by the null request of each accepted setup request
+// (sent individually as each originates from its own test connection)
+//
+static void _flush_setuprsp(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int i, var, sent = 0;
+        struct ctlResp *resp;
+        struct connection *tc;
+        struct perfStatsAverages *psA = &repo.psAverages;
+#ifdef HAVE_SENDMMSG
+        struct mmsghdr mmsg[CTRLMMSG_SIZE];
+        struct iovec iov[CTRLMMSG_SIZE];
+#endif
+
+        if (ctlRespCount == 0)
+                return;
+#ifdef HAVE_SENDMMSG
+        memset(mmsg, 0, ctlRespCount * sizeof(struct mmsghdr));
+        for (i = 0; i < ctlRespCount; i++) {
+                iov[i].iov_base             = ctlResp[i].pdu;
+                iov[i].iov_len              = (size_t) ctlResp[i].pduSize;
+                mmsg[i].msg_hdr.msg_iov     = &iov[i];
+                mmsg[i].msg_hdr.msg_iovlen  = 1;
+                mmsg[i].msg_hdr.msg_name    = &ctlResp[i].remSas;
+                mmsg[i].msg_hdr.msg_namelen = ctlResp[i].remSasLen;
+        }
+        while (sent < ctlRespCount) {
+                if ((var = sendmmsg(c->fd, &mmsg[sent], ctlRespCount - sent, 0)) <= 0)
+                        break;
+                if (conf.psFile != NULL) { // Update performance statistics
+                        psA->ctrlTxCount++;
+                        psA->ctrlTxTotal += (unsigned int) var;
+                }
+                sent += var;
+        }
+#else
+        for (var = 0; sent < ctlRespCount; sent++) {
+                resp = &ctlResp[sent];
+                if ((var = (int) sendto(c->fd, resp->pdu, resp->pduSize, 0, (struct sockaddr *) &resp->remSas,
+                                        resp->remSasLen)) < 0)
+                        break;
+                if (conf.psFile != NULL) { // Update performance statistics
+                        psA->ctrlTxCount++;
+                        psA->ctrlTxTotal++;
+                }
+        }
+#endif
+        if (sent < ctlRespCount && var < 0) {
+                if ((var = socket_error(connindex, errno, "SENDMMSG/SENDTO")) > 0) {
+                        if (!conf.errSuppress)
+                                send_proc(errConn, scratch, var);
+                }
+        }
+
+        //
+        // Complete accepted setup requests whose response was sent
+        //
+        for (i = 0; i < sent; i++) {
+                resp = &ctlResp[i];
+                if (resp->testConn < 0)
+                        continue;
+                if (conf.verbose) {
+                        var = sprintf(scratch, "[%d]Setup response (%d.%d) sent from %s:%d to %s:%s\n", connindex,
+                                      conn[resp->testConn].mcIndex, conn[resp->testConn].mcIdent, c->locAddr, c->locPort,
+                                      resp->addrstr, resp->portstr);
+                        send_proc(monConn, scratch, var);
+                }
+                if (!resp->nullReq)
+                        continue;
+                memcpy(&repo.remSas, &resp->remSas, resp->remSasLen);
+                repo.remSasLen = resp->remSasLen;
+                if (send_proc(resp->testConn, (char *) resp->nullPdu, CHNR_SIZE_CVER) != CHNR_SIZE_CVER)
+                        continue;
                 if (conf.verbose) {
-                        var = sprintf(scratch, "[%d]Null request (%d.%d) sent from %s:%d to %s:%s\n", i, conn[i].mcIndex,
-                                      conn[i].mcIdent, conn[i].locAddr, conn[i].locPort, addrstr, portstr);
+                        var = sprintf(scratch, "[%d]Null request (%d.%d) sent from %s:%d to %s:%s\n", resp->testConn,
+                                      conn[resp->testConn].mcIndex, conn[resp->testConn].mcIdent, conn[resp->testConn].locAddr,
+                                      conn[resp->testConn].locPort, resp->addrstr, resp->portstr);
                         send_proc(monConn, scratch, var);
                 }
         }
+
+        //
+        // Release accepted setup requests whose response could not be sent (instead of holding them until watchdog)
+        //
+        for (i = sent; i < ctlRespCount; i++) {
+                resp = &ctlResp[i];
+                if (resp->testConn < 0)
+                        continue;
+                tc = &conn[resp->testConn];
+                ledger_update(FALSE, 0, -1); // Remove test connection from ledger
+                if (conf.maxBandwidth > 0) {
+                        if (tc->testType == TEST_TYPE_US) {
+                                if ((repo.usBandwidth -= tc->maxBandwidth) < 0)
+                                        repo.usBandwidth = 0;
+                        } else {
+                                if ((repo.dsBandwidth -= tc->maxBandwidth) < 0)
+                                        repo.dsBandwidth = 0;
+                        }
+                        ledger_update(tc->testType == TEST_TYPE_US, -tc->maxBandwidth, 0);
+                }
+                if (conf.verbose) {
+                        var = sprintf(scratch, "[%d]Setup response (%d.%d) not sent to %s:%s, test connection released\n",
+                                      connindex, tc->mcIndex, tc->mcIdent, resp->addrstr, resp->portstr);
+                        send_proc(monConn, scratch, var);
+                }
+                init_conn(resp->testConn, TRUE); // Also releases source limit slot
+        }
+        ctlRespCount = 0;
+}
+//
+// Close test socket prepared by control thread if not used
+//
+static void _close_testfd(struct ctlJob *job) {
+        if (job->testFd >= 0) {
+                close(job->testFd);
+                job->testFd = -1;
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Create and bind a test socket using the cached local address of the socket pool, with an ephemeral port
+// unless shared (as part of a SO_REUSEPORT group, where all but the first socket use the port of the first)
+//
+// Mirrors new_conn()/sock_mgmt(), without any output or shared state (may be called by control thread)
+//
+static int _test_socket(BOOL shared, int port) {
+        int fd, var;
+        struct sockaddr_storage sas;
+
+        if (sockPool.sasLen == 0 || (fd = socket(sockPool.sas.ss_family, SOCK_DGRAM, 0)) < 0)
+                return -1;
+        memcpy(&sas, &sockPool.sas, sockPool.sasLen);
+        if (sas.ss_family == AF_INET6)
+                ((struct sockaddr_in6 *) &sas)->sin6_port = htons((uint16_t) port);
+        else
+                ((struct sockaddr_in *) &sas)->sin_port = htons((uint16_t) port);
+#ifdef SO_REUSEPORT
+        var = 1;
+        if (shared && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (const void *) &var, sizeof(var)) < 0) {
+                close(fd);
+                return -1;
+        }
+#else
+        (void) (shared);
+#endif
+        if (sockPool.sas.ss_family == AF_INET6) {
+                var = 0;
+                if (conf.ipv6Only)
+                        var = 1;
+                if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (const void *) &var, sizeof(var)) < 0) {
+                        close(fd);
+                        return -1;
+                }
+        }
+        if (bind(fd, (struct sockaddr *) &sas, sockPool.sasLen) < 0) {
+                close(fd);
+                return -1;
+        }
+        var = fcntl(fd, F_GETFL, 0);
+        if (fcntl(fd, F_SETFL, var | O_NONBLOCK) != 0) {
+                close(fd);
+                return -1;
+        }
+        var = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const void *) &var, sizeof(var)) < 0) {
+                close(fd);
+                return -1;
+        }
+        if (conf.sockSndBuf != 0 && conf.sockRcvBuf != 0) {
+                if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const void *) &conf.sockSndBuf, sizeof(conf.sockSndBuf)) < 0 ||
+                    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const void *) &conf.sockRcvBuf, sizeof(conf.sockRcvBuf)) < 0) {
+                        close(fd);
+                        return -1;
+                }
+        }
+        return fd;
+}
+//----------------------------------------------------------------------------
+//
+// Initialize pool of pre-created test sockets, caching the local address of the control port connection
+// (with an ephemeral port) as the bind address, as it resulted from the same address lookup
+//
+void sockpool_init(int connindex) {
+        sockPool.sasLen = sizeof(sockPool.sas);
+        if (getsockname(conn[connindex].fd, (struct sockaddr *) &sockPool.sas, &sockPool.sasLen) < 0) {
+                sockPool.sasLen = 0; // Test sockets created via new_conn()
+                return;
+        } else if (sockPool.sas.ss_family == AF_INET6) {
+                ((struct sockaddr_in6 *) &sockPool.sas)->sin6_port = 0;
+        } else {
+                ((struct sockaddr_in *) &sockPool.sas)->sin_port = 0;
+        }
+        while (conf.sharedSock == 0 && sockPool.count < SOCKPOOL_SIZE) { // Not needed with shared test sockets
+                if ((sockPool.fd[sockPool.count] = _test_socket(FALSE, 0)) < 0)
+                        break;
+                sockPool.count++;
+        }
+}
+//
+// Replenish socket pool (up to SOCKPOOL_REFILL sockets per call to bound the time taken)
+//
+// Only called by the owner of the pool (control thread if used, else data-plane loop)
+//
+void sockpool_refill(void) {
+        int i;
+
+        if (conf.sharedSock > 0)
+                return;
+        for (i = 0; i < SOCKPOOL_REFILL && sockPool.count < SOCKPOOL_SIZE; i++) {
+                if ((sockPool.fd[sockPool.count] = _test_socket(FALSE, 0)) < 0)
+                        break;
+                sockPool.count++;
+        }
+}
+//
+// Obtain test socket from pool, else create it directly if pool is empty
+//
+static int _sockpool_get(void) {
+        if (sockPool.count > 0)
+                return sockPool.fd[--sockPool.count];
+        if (sockPool.sasLen > 0)
+                atomic_fetch_add(&sockPool.emptyCount, 1);
+        return _test_socket(FALSE, 0);
+}
+//
+// Close all pooled sockets
+//
+void sockpool_close(void) {
+        while (sockPool.count > 0)
+                close(sockPool.fd[--sockPool.count]);
+}
+//
+// Obtain (and reset) number of test sockets created while pool was empty
+//
+unsigned int sockpool_empty(void) {
+        return atomic_exchange(&sockPool.emptyCount, 0);
+}
+//----------------------------------------------------------------------------
+//
+// Create shared test sockets, bound to a common (ephemeral) port, that receive the test traffic of all test
+// connections for demultiplexing by remote address (see recv_shared)
+//
+// Populate scratch buffer and return length on error
+//
+int shared_init(void) {
+        int i, fd, var, port = 0;
+
+        for (i = 0; i < conf.sharedSock; i++) {
+                if ((fd = _test_socket(TRUE, port)) < 0) {
+                        return sprintf(scratch, "ERROR: Unable to create shared test socket (port %d): %s\n", port,
+                                       strerror(errno));
+                }
+                //
+                // Enable reception of IP packet marking (for ECN), socket receive overflow (drop) counter, and kernel
+                // receive timestamps
+                //
+                var = 1;
+                setsockopt(fd, IPPROTO_IP, IP_RECVTOS, (const void *) &var, sizeof(var));
+                if (sockPool.sas.ss_family == AF_INET6)
+                        setsockopt(fd, IPPROTO_IPV6, IPV6_RECVTCLASS, (const void *) &var, sizeof(var));
+#ifdef HAVE_SO_RXQ_OVFL
+                setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, (const void *) &var, sizeof(var));
+#endif
+#ifdef HAVE_SO_TIMESTAMPNS
+                setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, (const void *) &var, sizeof(var));
+#endif
+#ifdef SO_INCOMING_CPU
+                if (repo.rtCpu >= 0) // Prefer socket of process pinned to receiving CPU (realtime profile)
+                        setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, (const void *) &repo.rtCpu, sizeof(repo.rtCpu));
+#endif
+                if ((var = new_conn(fd, repo.server[0].ip, 0, T_UDP, &recv_shared, &null_action)) < 0) {
+                        return sprintf(scratch, "ERROR: Unable to create connection for shared test socket\n");
+                }
+                repo.sharedConn[repo.sharedCount++] = var;
+                port                                = conn[var].locPort;
+        }
         return 0;
 }
 //----------------------------------------------------------------------------
 //
+// Start preforked server processes, each with its own control port socket (bound to the common port as part of
+// a SO_REUSEPORT group, see sock_mgmt) and test connections. Bandwidth allocations and test connection counts
+// are kept in a ledger shared by all server processes, so the configured capacity is enforced host-wide.
+//
+// Populate scratch buffer and return length on error
+//
+int prefork_start(void) {
+        int i;
+        pid_t pid;
+
+        if (conf.workerCount <= 1)
+                return 0;
+        ledger = mmap(NULL, sizeof(*ledger), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (ledger == MAP_FAILED) {
+                ledger = &localLedger;
+                return sprintf(scratch, "ERROR: Unable to allocate shared memory of server processes: %s\n", strerror(errno));
+        }
+        for (i = 1; i < conf.workerCount; i++) {
+                if ((pid = fork()) < 0) {
+                        return sprintf(scratch, "ERROR: Unable to start server process: %s\n", strerror(errno));
+                } else if (pid == 0) {
+                        //
+                        // Server process uses its own epoll instance (the inherited one is shared with parent)
+                        //
+                        repo.workerIndex = i;
+#ifdef __linux__
+                        prctl(PR_SET_PDEATHSIG, SIGTERM); // Exit along with parent
+#endif
+                        srandom((unsigned int) (nsnsec(repo.systemClock) ^ getpid()));
+                        close(repo.epollFD);
+                        if ((repo.epollFD = epoll_create1(0)) < 0) {
+                                return sprintf(scratch, "EPOLL ERROR: %s\n", strerror(errno));
+                        }
+                        return 0;
+                }
+                preforkPid[i] = pid;
+        }
+        return 0;
+}
+//
+// Reserve bandwidth in ledger if it does not exceed the configured capacity
+//
+BOOL ledger_reserve(BOOL usbw, int mbw) {
+        struct ledgerCount *p = &ledger->proc[repo.workerIndex];
+        atomic_int *host      = usbw ? &ledger->host.usBandwidth : &ledger->host.dsBandwidth;
+        int curr              = atomic_load(host);
+
+        do {
+                if (curr + mbw > conf.maxBandwidth)
+                        return FALSE;
+        } while (!atomic_compare_exchange_weak(host, &curr, curr + mbw));
+        atomic_fetch_add(usbw ? &p->usBandwidth : &p->dsBandwidth, mbw);
+        return TRUE;
+}
+//
+// Adjust bandwidth (unconditionally) and test connection count in ledger
+//
+void ledger_update(BOOL usbw, int mbw, int conns) {
+        struct ledgerCount *p = &ledger->proc[repo.workerIndex];
+
+        if (mbw != 0) {
+                atomic_fetch_add(usbw ? &ledger->host.usBandwidth : &ledger->host.dsBandwidth, mbw);
+                atomic_fetch_add(usbw ? &p->usBandwidth : &p->dsBandwidth, mbw);
+        }
+        if (conns != 0) {
+                atomic_fetch_add(&ledger->host.connCount, conns);
+                atomic_fetch_add(&p->connCount, conns);
+        }
+}
+//
+// Obtain host-wide bandwidth allocations and test connection count from ledger
+//
+void ledger_totals(int *usbw, int *dsbw, int *conns) {
+        *usbw  = atomic_load(&ledger->host.usBandwidth);
+        *dsbw  = atomic_load(&ledger->host.dsBandwidth);
+        *conns = atomic_load(&ledger->host.connCount);
+}
+//
+// Check for preforked server processes that have ended, reclaiming their ledger contributions (parent only)
+//
+// Populate scratch buffer and return length if a server process ended
+//
+int prefork_check(void) {
+        struct ledgerCount *p;
+        int i, var, status;
+
+        if (nssec(repo.monoClock) == preforkCheck) // Checked at most once per second
+                return 0;
+        preforkCheck = nssec(repo.monoClock);
+        for (i = 1; i < conf.workerCount && repo.workerIndex == 0; i++) {
+                if (preforkPid[i] <= 0 || waitpid(preforkPid[i], &status, WNOHANG) != preforkPid[i])
+                        continue;
+                p = &ledger->proc[i];
+                atomic_fetch_sub(&ledger->host.usBandwidth, atomic_exchange(&p->usBandwidth, 0));
+                atomic_fetch_sub(&ledger->host.dsBandwidth, atomic_exchange(&p->dsBandwidth, 0));
+                atomic_fetch_sub(&ledger->host.connCount, atomic_exchange(&p->connCount, 0));
+                var = sprintf(scratch, "ERROR: Server process %d (PID %d) ended unexpectedly (%s: %d)\n", i, (int) preforkPid[i],
+                              WIFSIGNALED(status) ? "Signal" : "Status",
+                              WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+                preforkPid[i] = 0;
+                return var;
+        }
+        return 0;
+}
+//
+// Stop any preforked server processes still running (parent) and release shared memory
+//
+void prefork_finish(void) {
+        int i;
+
+        if (ledger == &localLedger)
+                return;
+        for (i = 1; i < conf.workerCount && repo.workerIndex == 0; i++) {
+                if (preforkPid[i] <= 0)
+                        continue;
+                kill(preforkPid[i], SIGTERM);
+                waitpid(preforkPid[i], NULL, 0);
+                preforkPid[i] = 0;
+        }
+        munmap(ledger, sizeof(*ledger));
+        ledger = &localLedger;
+}
+#ifdef CONTROL_THREAD
+//----------------------------------------------------------------------------
+//
+// Control thread to receive setup requests on the control port
+//
+// Performs the expensive per-request work (source address conversion, authentication, and test socket
+// creation via the socket pool, which is owned by this thread) and queues the prepared request for the data-plane
+// loop, which completes it via _setupreq().
+// Only configuration and key data (read-only once started) is accessed.
+//
+static void *_ctl_thread(void *arg) {
+        int fd = (int) (intptr_t) arg, i, var, count;
+        unsigned int head, tail, dropcnt = 0, droplast = 0;
+        struct pollfd pfd;
+        struct ctlJob *job;
+        static struct ctlJob discard[CTRLMMSG_SIZE]; // Static array
+        struct controlHdrSR *cHdrSR;
+        unsigned char authpdu[CHSR_SIZE_CVER];
+
+        rt_unpin(); // Not part of the data-plane (when realtime profile is used)
+        pfd.fd     = fd;
+        pfd.events = POLLIN;
+        while (!atomic_load(&ctlQueue.exit)) {
+                if (poll(&pfd, 1, CTL_POLL_TIME) <= 0) {
+                        sockpool_refill(); // Replenish socket pool while idle
+                        continue;
+                }
+                //
+                // Receive batch into next (contiguous) queue entries, or discard if full
+                //
+                head  = atomic_load_explicit(&ctlQueue.head, memory_order_relaxed);
+                tail  = atomic_load_explicit(&ctlQueue.tail, memory_order_acquire);
+                job   = &ctlQueue.job[head & (CTLQ_SIZE - 1)];
+                count = CTLQ_SIZE - (int) (head - tail);
+                if (count > CTLQ_SIZE - (int) (head & (CTLQ_SIZE - 1)))
+                        count = CTLQ_SIZE - (int) (head & (CTLQ_SIZE - 1));
+                if (count == 0) {
+                        job   = discard;
+                        count = CTRLMMSG_SIZE;
+                }
+                if ((count = _ctl_recvmmsg(fd, job, count, &dropcnt)) < 0)
+                        continue;
+                atomic_fetch_add(&ctlQueue.rxCount, 1);
+                atomic_fetch_add(&ctlQueue.rxTotal, (unsigned int) count);
+                if (dropcnt != droplast) {
+                        atomic_fetch_add(&ctlQueue.sockDrops, dropcnt - droplast); // Allow for counter wrap
+                        droplast = dropcnt;
+                }
+                if (job == discard) {
+                        atomic_fetch_add(&ctlQueue.dropCount, (unsigned int) count);
+                        continue;
+                }
+                for (i = 0; i < count; i++, job++) {
+                        getnameinfo((struct sockaddr *) &job->remSas, job->remSasLen, job->addrstr, INET6_ADDR_STRLEN,
+                                    job->portstr, sizeof(job->portstr), NI_NUMERICHOST | NI_NUMERICSERV);
+
+                        //
+                        // If it appears to be a valid setup request, validate authentication (using a copy so that the
+                        // PDU can still be verified as received) and create test socket
+                        //
+                        var    = job->pduSize; // Actual size (verified by data-plane loop)
+                        cHdrSR = (struct controlHdrSR *) job->pdu;
+                        if (var < (int) CHSR_SIZE_MVER || var > (int) CHSR_SIZE_CVER || ntohs(cHdrSR->pduId) != CHSR_ID ||
+                            cHdrSR->cmdRequest != CHSR_CREQ_SETUPREQ)
+                                continue;
+                        if (cHdrSR->authMode == AUTHMODE_1 && (*conf.authKey != '\0' || conf.keyFile != NULL)) {
+                                memcpy(authpdu, job->pdu, var);
+                                job->authStatus =
+                                    validate_auth((int) ntohs(cHdrSR->protocolVer), job->ckey, job->skey,
+                                                  &((struct controlHdrSR *) authpdu)->authMode, authpdu, (size_t) var);
+                                job->authDone = TRUE;
+                        }
+                        if ((!job->authDone || job->authStatus == 0) && conf.sharedSock == 0)
+                                job->testFd = _sockpool_get();
+                }
+                atomic_store_explicit(&ctlQueue.head, head + (unsigned int) count, memory_order_release);
+                sockpool_refill();
+        }
+        return NULL;
+}
+//----------------------------------------------------------------------------
+//
+// Start control thread to service setup requests received on the control port connection
+//
+// Populate scratch buffer and return length on error
+//
+int start_ctlthread(int connindex) {
+        int var;
+        sigset_t sigset, oldset;
+
+        //
+        // Create thread with all signals blocked (so that the interval timer always interrupts the data-plane loop)
+        //
+        atomic_store(&ctlQueue.exit, 0);
+        sigfillset(&sigset);
+        pthread_sigmask(SIG_BLOCK, &sigset, &oldset);
+        var = pthread_create(&ctlThread, NULL, &_ctl_thread, (void *) (intptr_t) conn[connindex].fd);
+        pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+        if (var != 0) {
+                return sprintf(scratch, "[%d]PTHREAD_CREATE ERROR: %s\n", connindex, strerror(var));
+        }
+
+        //
+        // Control port is no longer read by data-plane loop (but setup responses are still sent from it)
+        //
+        epoll_ctl(repo.epollFD, EPOLL_CTL_DEL, conn[connindex].fd, NULL);
+        ctlConn = connindex;
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Stop control thread and close any unused test sockets still in queue
+//
+void stop_ctlthread(void) {
+        unsigned int tail, head;
+
+        if (ctlConn < 0)
+                return;
+        atomic_store(&ctlQueue.exit, 1);
+        pthread_join(ctlThread, NULL);
+        head = atomic_load(&ctlQueue.head);
+        for (tail = atomic_load(&ctlQueue.tail); tail != head; tail++) {
+                _close_testfd(&ctlQueue.job[tail & (CTLQ_SIZE - 1)]);
+        }
+        ctlConn = -1;
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Complete setup requests queued by control thread (data-plane loop)
+//
+void service_ctlqueue(void) {
+        unsigned int head, tail;
+        struct ctlJob *job;
+        struct perfStatsAverages *psA = &repo.psAverages;
+        struct perfStatsCounters *psC = &repo.psCounters;
+
+        if (ctlConn < 0)
+                return;
+        tail = atomic_load_explicit(&ctlQueue.tail, memory_order_relaxed);
+        head = atomic_load_explicit(&ctlQueue.head, memory_order_acquire);
+        if (tail != head)
+                clock_update();
+        for (; tail != head; tail++) {
+                //
+                // Restore received PDU and source address as if read from control port, then process
+                //
+                job = &ctlQueue.job[tail & (CTLQ_SIZE - 1)];
+                _ctl_restore(job);
+                _setupreq(ctlConn, job);
+                atomic_store_explicit(&ctlQueue.tail, tail + 1, memory_order_release);
+        }
+        _flush_setuprsp(ctlConn);
+
+        //
+        // Collect control port statistics from control thread
+        //
+        psC->setupQueueFull += atomic_exchange(&ctlQueue.dropCount, 0);
+        psC->ctrlSocketDrops += atomic_exchange(&ctlQueue.sockDrops, 0);
+        if (conf.psFile != NULL) { // Update performance statistics
+                psA->ctrlRxCount += atomic_exchange(&ctlQueue.rxCount, 0);
+                psA->ctrlRxTotal += atomic_exchange(&ctlQueue.rxTotal, 0);
+        }
+        return;
+}
+#endif
+//----------------------------------------------------------------------------
+//
 // Client function to service setup response received from server
 //
 // Send test activation request to server for the new test connection
@@ -660,7 +1605,7 @@ int service_setupresp(int connindex) {
                 if (var > 0) {
                         var += sprintf(&scratch[var], " %s:%d\n", repo.server[c->serverIndex].ip, repo.server[c->serverIndex].port);
                         send_proc(errConn, scratch, var);
-                        tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                        c->endTime = repo.monoClock; // Set for immediate close/exit
                         return 0;
                 }
         }
@@ -717,7 +1662,7 @@ int service_setupresp(int connindex) {
                         var += sprintf(&scratch[var], " %s:%d\n", repo.server[c->serverIndex].ip, repo.server[c->serverIndex].port);
                         send_proc(errConn, scratch, var);
                 }
-                tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                c->endTime = repo.monoClock; // Set for immediate close/exit
                 return 0;
         }
 
@@ -791,14 +1736,16 @@ int service_setupresp(int connindex) {
                 c->randPayload = TRUE;
                 cHdrTA->modifierBitmap |= CHTA_RAND_PAYLOAD;
         }
-        c->rateAdjAlgo       = conf.rateAdjAlgo;
-        cHdrTA->rateAdjAlgo  = (uint8_t) c->rateAdjAlgo;
-        c->subIntPeriod      = conf.subIntPeriod;
-        cHdrTA->subIntPeriod = htons((uint16_t) c->subIntPeriod);
-        c->srAdjSuppCount    = conf.srAdjSuppCount;
-        cHdrTA->reserved4    = htons((uint16_t) c->srAdjSuppCount); // Utilizes reserved alignment field
-        c->ecnCEThresh       = conf.ecnCEThresh;
-        cHdrTA->reserved2    = (uint8_t) c->ecnCEThresh; // Utilizes reserved alignment field
+        c->rateAdjAlgo        = conf.rateAdjAlgo;
+        cHdrTA->rateAdjAlgo   = (uint8_t) c->rateAdjAlgo;
+        c->subIntPeriod       = conf.subIntPeriod;
+        cHdrTA->subIntPeriod  = htons((uint16_t) c->subIntPeriod);
+        c->srAdjSuppCount     = conf.srAdjSuppCount;
+        cHdrTA->reserved4     = htons((uint16_t) c->srAdjSuppCount); // Utilizes reserved alignment field
+        c->ecnCEThresh        = conf.ecnCEThresh;
+        cHdrTA->reserved2     = (uint8_t) c->ecnCEThresh; // Utilizes reserved alignment field
+        c->pdvPercentile      = conf.pdvPercentile;
+        cHdrTA->pdvPercentile = (uint8_t) c->pdvPercentile;
 
         //
         // Send test activation request to server
@@ -835,7 +1782,6 @@ int service_actreq(int connindex) {
         int i, var;
         char addrstr[INET6_ADDR_STRLEN], portstr[8];
         struct sendingRate *sr = repo.sendingRates; // Set to first row of table
-        struct timespec tspecvar;
         struct controlHdrTA *cHdrTA   = (struct controlHdrTA *) repo.defBuffer;
         struct perfStatsCounters *psC = &repo.psCounters;
 
@@ -965,7 +1911,7 @@ int service_actreq(int connindex) {
                 c->dscpEcn      = conf.dscpEcn;
                 cHdrTA->dscpEcn = (uint8_t) c->dscpEcn;
         }
-        if (c->dscpEcn != DEF_DSCPECN_BYTE) {
+        if (c->dscpEcn != DEF_DSCPECN_BYTE && c->type != T_SHARED) { // Shared test socket marks each message
                 if (c->ipProtocol == IPPROTO_IPV6) // Set IP packet marking
                         var = IPV6_TCLASS;
                 else
@@ -1080,7 +2026,7 @@ int service_actreq(int connindex) {
                         c->ecnCEThresh    = DEF_ECN_CE_TH;
                         cHdrTA->reserved2 = (uint8_t) c->ecnCEThresh; // Utilizes reserved alignment field
                 }
-                if (c->ecnCEThresh != DEF_ECN_CE_TH) {
+                if (c->ecnCEThresh != DEF_ECN_CE_TH && c->type != T_SHARED) { // Already enabled on shared test socket
                         if (c->ipProtocol == IPPROTO_IPV6) // Enable reception of IP packet marking
                                 var = IPV6_RECVTCLASS;
                         else
@@ -1093,6 +2039,16 @@ int service_actreq(int connindex) {
                 }
         }
         //
+        // One-way delay variation percentile for rate adjustment (requires one-way delay variation)
+        //
+        if (c->protocolVer >= AUTH_ECN_PVER) {
+                c->pdvPercentile = (int) cHdrTA->pdvPercentile;
+                if (c->pdvPercentile < MIN_PDV_PCT || c->pdvPercentile > MAX_PDV_PCT || !c->useOwDelVar) {
+                        c->pdvPercentile      = DEF_PDV_PCT;
+                        cHdrTA->pdvPercentile = (uint8_t) c->pdvPercentile;
+                }
+        }
+        //
         // If upstream test, send back initial sending rate transmission parameters
         //
         if (cHdrTA->cmdRequest == CHTA_CREQ_TESTACTUS) {
@@ -1115,7 +2071,7 @@ int service_actreq(int connindex) {
                 // Set connection test action as testing and initialize PDU received time
                 //
                 c->testAction = TEST_ACT_TEST;
-                tspeccpy(&c->pduRxTime, &repo.systemClock);
+                c->pduRxTime = repo.monoClock;
 
                 //
                 // Finalize connection for testing based on test type
@@ -1133,11 +2089,22 @@ int service_actreq(int connindex) {
 #else
                         c->secAction = &service_loadpdu;
 #endif
-                        c->delayVarMin = STATUS_NODEL;
-                        tspeccpy(&c->trialIntClock, &repo.systemClock);
-                        tspecvar.tv_sec  = 0;
-                        tspecvar.tv_nsec = (long) (c->trialInt * NSECINMSEC);
-                        tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+                        c->delayVarMin   = STATUS_NODEL;
+                        c->tiDelayVarPct = STATUS_NODEL;
+#ifdef HAVE_SO_RXQ_OVFL
+                        var = 1; // Enable socket receive overflow (drop) counter to attribute local loss (unless shared)
+                        if (c->type != T_SHARED &&
+                            setsockopt(c->fd, SOL_SOCKET, SO_RXQ_OVFL, (const void *) &var, sizeof(var)) == 0)
+                                c->rxDropTrack = TRUE;
+#endif
+#ifdef HAVE_SO_TIMESTAMPNS
+                        var = 1; // Enable kernel receive timestamps for one-way delay (shared test socket already enabled)
+                        if (c->type != T_SHARED &&
+                            setsockopt(c->fd, SOL_SOCKET, SO_TIMESTAMPNS, (const void *) &var, sizeof(var)) == 0)
+                                c->rxTimestamp = TRUE;
+#endif
+                        c->trialIntClock = repo.monoClock;
+                        c->timer1Thresh = repo.monoClock + (c->trialInt * NSECINMSEC);
                         c->timer1Action = &send_statuspdu;
                 } else {
                         //
@@ -1148,20 +2115,21 @@ int service_actreq(int connindex) {
                         c->secAction = &service_statuspdu;
                         //
                         if (sr->txInterval1 > 0) {
-                                var              = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
-                                tspecvar.tv_sec  = 0;
-                                tspecvar.tv_nsec = (long) (var * NSECINUSEC);
-                                tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+                                var             = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
+                                c->timer1Thresh = repo.monoClock + (nstime_t) var * NSECINUSEC;
                         }
                         c->timer1Action = &send1_loadpdu;
                         if (sr->txInterval2 > 0) {
-                                var              = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
-                                tspecvar.tv_sec  = 0;
-                                tspecvar.tv_nsec = (long) (var * NSECINUSEC);
-                                tspecplus(&repo.systemClock, &tspecvar, &c->timer2Thresh);
+                                var             = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
+                                c->timer2Thresh = repo.monoClock + (nstime_t) var * NSECINUSEC;
                         }
                         c->timer2Action = &send2_loadpdu;
+#ifdef HAVE_TX_TIMESTAMPS
+                        init_txtstamp(connindex); // Transmit timestamps of load PDU bursts to measure host queueing
+#endif
                 }
+                tune_sockbuf(connindex, &repo.sendingRates[c->srIndex], 0.0); // Size buffer for starting sending rate
+                set_tx_method(connindex, &repo.sendingRates[c->srIndex]);
                 psC->actAcceptCnt++;
         } else {
                 psC->actRejectCnt++;
@@ -1195,7 +2163,7 @@ int service_actreq(int connindex) {
         // Do not continue if test activation request is being rejected
         //
         if (cHdrTA->cmdResponse != CHTA_CRSP_ACKOK) {
-                tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                c->endTime = repo.monoClock; // Set for immediate close/exit
                 return 0;
         }
 
@@ -1207,21 +2175,18 @@ int service_actreq(int connindex) {
                         send_proc(errConn, scratch, var); // Output error message
                 }
         }
+        select_hotpath(connindex); // Specialize load PDU processing for negotiated features
 
         //
         // Update end time (used as watchdog) in case client goes quiet
         //
-        tspecvar.tv_sec  = TIMEOUT_NOTRAFFIC;
-        tspecvar.tv_nsec = 0;
-        tspecplus(&repo.systemClock, &tspecvar, &c->endTime);
+        c->endTime = repo.monoClock + (nstime_t) TIMEOUT_NOTRAFFIC * NSECINSEC;
 
         //
         // Set timer to stop test after desired test interval time
         // NOTE: This timer triggers the normal/graceful test stop initiated by the server
         //
-        tspecvar.tv_sec  = (time_t) c->testIntTime;
-        tspecvar.tv_nsec = NSECINSEC / 2;
-        tspecplus(&repo.systemClock, &tspecvar, &c->timer3Thresh);
+        c->timer3Thresh = repo.monoClock + (nstime_t) c->testIntTime * NSECINSEC + NSECINSEC / 2;
         c->timer3Action = &stop_test;
 
         return 0;
@@ -1235,10 +2200,9 @@ int service_actreq(int connindex) {
 int service_actresp(int connindex) {
         register struct connection *c = &conn[connindex];
         int i, var, ipv6add;
-        char *testtype, connid[8], delusage[8], sritext[8], payload[8];
+        char *testtype, connid[8], delusage[16], sritext[8], payload[8];
         char intflabel[IFNAMSIZ + 8];
         struct sendingRate *sr = &c->srStruct; // Set to connection structure
-        struct timespec tspecvar;
         struct controlHdrTA *cHdrTA = (struct controlHdrTA *) repo.defBuffer;
 
         //
@@ -1265,7 +2229,7 @@ int service_actresp(int connindex) {
                 if (var > 0) {
                         var += sprintf(&scratch[var], " %s:%d\n", repo.server[c->serverIndex].ip, repo.server[c->serverIndex].port);
                         send_proc(errConn, scratch, var);
-                        tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                        c->endTime = repo.monoClock; // Set for immediate close/exit
                         return 0;
                 }
         }
@@ -1284,7 +2248,7 @@ int service_actresp(int connindex) {
                                       cHdrTA->cmdResponse, repo.server[c->serverIndex].ip, repo.server[c->serverIndex].port);
                 }
                 send_proc(errConn, scratch, var);
-                tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                c->endTime = repo.monoClock; // Set for immediate close/exit
                 return 0;
         }
         if (conf.verbose) {
@@ -1310,7 +2274,7 @@ int service_actresp(int connindex) {
                 if (setsockopt(c->fd, c->ipProtocol, var, (const void *) &c->dscpEcn, sizeof(c->dscpEcn)) < 0) {
                         var = sprintf(scratch, "ERROR: Failure setting IP_TOS/IPV6_TCLASS (%d) %s\n", c->dscpEcn, strerror(errno));
                         send_proc(errConn, scratch, var);
-                        tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                        c->endTime = repo.monoClock; // Set for immediate close/exit
                         return 0;
                 }
         }
@@ -1330,6 +2294,9 @@ int service_actresp(int connindex) {
         c->rateAdjAlgo    = (int) cHdrTA->rateAdjAlgo;
         c->srAdjSuppCount = (int) ntohs(cHdrTA->reserved4); // Utilizes reserved alignment field
         c->ecnCEThresh    = (int) cHdrTA->reserved2;        // Utilizes reserved alignment field
+        c->pdvPercentile  = (int) cHdrTA->pdvPercentile;
+        if (c->pdvPercentile < MIN_PDV_PCT || c->pdvPercentile > MAX_PDV_PCT)
+                c->pdvPercentile = DEF_PDV_PCT; // Ignore invalid delay variation percentile from server
         if (c->ecnCEThresh != DEF_ECN_CE_TH) {
                 if (c->ipProtocol == IPPROTO_IPV6) // Enable reception of IP packet marking
                         var = IPV6_RECVTCLASS;
@@ -1339,7 +2306,7 @@ int service_actresp(int connindex) {
                 if (setsockopt(c->fd, c->ipProtocol, var, (const void *) &i, sizeof(i)) < 0) {
                         var = sprintf(scratch, "ERROR: Failure setting IP_RECVTOS/IPV6_RECVTCLASS %s\n", strerror(errno));
                         send_proc(errConn, scratch, var);
-                        tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                        c->endTime = repo.monoClock; // Set for immediate close/exit
                         return 0;
                 }
         }
@@ -1348,7 +2315,7 @@ int service_actresp(int connindex) {
         // Set connection test action as testing and initialize PDU received time
         //
         c->testAction = TEST_ACT_TEST;
-        tspeccpy(&c->pduRxTime, &repo.systemClock);
+        c->pduRxTime = repo.monoClock;
 
         //
         // Finalize connection for testing based on test type
@@ -1362,19 +2329,18 @@ int service_actresp(int connindex) {
                 c->secAction = &service_statuspdu;
                 //
                 if (sr->txInterval1 > 0) {
-                        var              = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
-                        tspecvar.tv_sec  = 0;
-                        tspecvar.tv_nsec = (long) (var * NSECINUSEC);
-                        tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+                        var             = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
+                        c->timer1Thresh = repo.monoClock + (nstime_t) var * NSECINUSEC;
                 }
                 c->timer1Action = &send1_loadpdu;
                 if (sr->txInterval2 > 0) {
-                        var              = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
-                        tspecvar.tv_sec  = 0;
-                        tspecvar.tv_nsec = (long) (var * NSECINUSEC);
-                        tspecplus(&repo.systemClock, &tspecvar, &c->timer2Thresh);
+                        var             = getuniform(MIN_RANDOM_START * USECINMSEC, MAX_RANDOM_START * USECINMSEC);
+                        c->timer2Thresh = repo.monoClock + (nstime_t) var * NSECINUSEC;
                 }
                 c->timer2Action = &send2_loadpdu;
+#ifdef HAVE_TX_TIMESTAMPS
+                init_txtstamp(connindex); // Transmit timestamps of load PDU bursts to measure host queueing
+#endif
         } else {
                 //
                 // Downstream
@@ -1388,13 +2354,24 @@ int service_actresp(int connindex) {
 #else
                 c->secAction = &service_loadpdu;
 #endif
-                c->delayVarMin = STATUS_NODEL;
-                tspeccpy(&c->trialIntClock, &repo.systemClock);
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = (long) (c->trialInt * NSECINMSEC);
-                tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+                c->delayVarMin   = STATUS_NODEL;
+                c->tiDelayVarPct = STATUS_NODEL;
+#ifdef HAVE_SO_RXQ_OVFL
+                var = 1; // Enable socket receive overflow (drop) counter to attribute local loss
+                if (setsockopt(c->fd, SOL_SOCKET, SO_RXQ_OVFL, (const void *) &var, sizeof(var)) == 0)
+                        c->rxDropTrack = TRUE;
+#endif
+#ifdef HAVE_SO_TIMESTAMPNS
+                var = 1; // Enable kernel receive timestamps for one-way delay
+                if (setsockopt(c->fd, SOL_SOCKET, SO_TIMESTAMPNS, (const void *) &var, sizeof(var)) == 0)
+                        c->rxTimestamp = TRUE;
+#endif
+                c->trialIntClock = repo.monoClock;
+                c->timer1Thresh = repo.monoClock + (c->trialInt * NSECINMSEC);
                 c->timer1Action = &send_statuspdu;
         }
+        tune_sockbuf(connindex, (cHdrTA->cmdRequest == CHTA_CREQ_TESTACTUS) ? sr : NULL, 0.0); // Size for starting rate
+        set_tx_method(connindex, (cHdrTA->cmdRequest == CHTA_CREQ_TESTACTUS) ? sr : NULL);
 
         //
         // Display test settings and general info of first completed connection
@@ -1406,7 +2383,9 @@ int service_actresp(int connindex) {
                 if (conf.verbose)
                         sprintf(connid, "[%d]", connindex);
 
-                if (c->useOwDelVar)
+                if (c->useOwDelVar && c->pdvPercentile > 0)
+                        sprintf(delusage, "%s/P%d", OWD_TEXT, c->pdvPercentile);
+                else if (c->useOwDelVar)
                         strcpy(delusage, OWD_TEXT);
                 else
                         strcpy(delusage, RTT_TEXT);
@@ -1549,7 +2528,7 @@ int service_actresp(int connindex) {
                         if (json_output == NULL) {
                                 json_output = cJSON_CreateObject();
                         }
-                        create_timestamp(&repo.systemClock, TRUE);
+                        create_timestamp(repo.systemClock, TRUE);
                         cJSON_AddStringToObject(json_output, "BOMTime", scratch);
                         //
                         cJSON_AddNumberToObject(json_output, "TmaxUsed", WARNING_NOTRAFFIC * MSECINSEC);
@@ -1567,22 +2546,19 @@ int service_actresp(int connindex) {
                         send_proc(errConn, scratch, var); // Output error message
                 }
         }
+        select_hotpath(connindex); // Specialize load PDU processing for negotiated features
 
         //
         // Set end time (used as watchdog) in case server goes quiet
         //
-        tspecvar.tv_sec  = TIMEOUT_NOTRAFFIC;
-        tspecvar.tv_nsec = 0;
-        tspecplus(&repo.systemClock, &tspecvar, &c->endTime);
+        c->endTime = repo.monoClock + (nstime_t) TIMEOUT_NOTRAFFIC * NSECINSEC;
 
         //
         // Set timer to force an eventual shutdown if server never initiates a normal/graceful test stop,
         // but continues sending load PDUs. This timer sets the local test action to STOP to block the
         // end time (watchdog) from updating. This prevents the client from processing load PDUs forever.
         //
-        tspecvar.tv_sec  = (time_t) (c->testIntTime + TIMEOUT_NOTRAFFIC);
-        tspecvar.tv_nsec = NSECINSEC / 2;
-        tspecplus(&repo.systemClock, &tspecvar, &c->timer3Thresh);
+        c->timer3Thresh = repo.monoClock + (nstime_t) (c->testIntTime + TIMEOUT_NOTRAFFIC) * NSECINSEC + NSECINSEC / 2;
         c->timer3Action = &stop_test;
 
         return 0;
@@ -1694,6 +2670,21 @@ int sock_mgmt(int connindex, char *host, int port, char *ip, int action) {
                                 var = sprintf(scratch, "SOCKET ERROR: %s (%s:%d)\n", strerror(errno), host, port);
                                 continue;
                         }
+#ifdef SO_REUSEPORT
+                        if (repo.isServer && conf.workerCount > 1 && port > 0) { // Control port shared by server processes
+                                i = 1;
+                                if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (const void *) &i, sizeof(i)) == -1) {
+                                        var = sprintf(scratch, "SO_REUSEPORT ERROR: %s (%s:%d)\n", strerror(errno), host, port);
+                                        close(fd);
+                                        continue;
+                                }
+#ifdef SO_INCOMING_CPU
+                                if (repo.rtCpu >= 0) // Prefer socket of process pinned to receiving CPU (realtime profile)
+                                        setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, (const void *) &repo.rtCpu,
+                                                   sizeof(repo.rtCpu));
+#endif
+                        }
+#endif
                         if (ai->ai_family == AF_INET6) {
                                 i = 0;
                                 if (conf.ipv6Only) // Explicitly enable OR disable (some non-Linux systems default to enabled)
@@ -1770,20 +2761,23 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
         //
         // Perform socket creation and bind
         //
-        if (type == T_UDP) {
+        if (type == T_UDP && activefd == -1) {
                 if ((var = sock_mgmt(i, host, port, NULL, SMA_BIND)) != 0) {
                         send_proc(errConn, scratch, var);
                         init_conn(i, TRUE);
                         return -1;
                 }
                 fd = conn[i].fd; // Update local descriptor
+        } else if (type == T_UDP || type == T_SHARED) {
+                conn[i].subType = SOCK_DGRAM; // Socket already created and bound (by control thread or as shared)
+                conn[i].state   = S_BOUND;
         }
 
         //
-        // Set FD as non-blocking
+        // Set FD as non-blocking (unless prepared or shared UDP socket)
         // Console FD (i.e., stdin) gets setup in main()
         //
-        if (type != T_CONSOLE) {
+        if (type != T_CONSOLE && type != T_SHARED && (type != T_UDP || activefd == -1)) {
                 var = fcntl(fd, F_GETFL, 0);
                 if (fcntl(fd, F_SETFL, var | O_NONBLOCK) != 0) {
                         var = sprintf(scratch, "[%d]F_SETFL ERROR: %s\n", i, strerror(errno));
@@ -1794,9 +2788,10 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
         }
 #ifdef __linux__
         //
-        // Add fd for epoll read operations (exclude console when command line not supported)
+        // Add fd for epoll read operations (exclude console when command line not supported, and shared test
+        // sockets as they are serviced via their own connection)
         //
-        if ((type != T_LOG) && (type != T_NULL) && (type != T_CONSOLE)) {
+        if ((type != T_LOG) && (type != T_NULL) && (type != T_CONSOLE) && (type != T_SHARED)) {
                 epevent.events   = EPOLLIN;
                 epevent.data.u32 = (uint32_t) i;
                 if (epoll_ctl(repo.epollFD, EPOLL_CTL_ADD, fd, &epevent) != 0) {
@@ -1808,15 +2803,15 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
         }
 #endif
         //
-        // Return if FD already existed
+        // Return if FD already existed (prepared or shared UDP sockets only need local address info)
         //
-        if (activefd != -1)
+        if (activefd != -1 && type != T_UDP && type != T_SHARED)
                 return i;
 
         //
         // Set address reuse
         //
-        if (type == T_UDP) {
+        if (type == T_UDP && activefd == -1) {
                 var = 1;
                 if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const void *) &var, sizeof(var)) < 0) {
                         var = sprintf(scratch, "[%d]SET SO_REUSEADDR ERROR: %s\n", i, strerror(errno));
@@ -1825,16 +2820,15 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
                         return -1;
                 }
         }
-
         //
         // Change buffering if specified
         //
         sndbuf = rcvbuf = 0;
-        if (type == T_UDP) {
+        if (type == T_UDP || type == T_SHARED) {
                 //
                 // Set socket buffers
                 //
-                if (conf.sockSndBuf != 0 && conf.sockRcvBuf != 0) {
+                if (activefd == -1 && conf.sockSndBuf != 0 && conf.sockRcvBuf != 0) {
                         if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const void *) &conf.sockSndBuf, sizeof(conf.sockSndBuf)) < 0) {
                                 var = sprintf(scratch, "[%d]SET SO_SNDBUF ERROR: %s\n", i, strerror(errno));
                                 send_proc(errConn, scratch, var);
@@ -1897,6 +2891,118 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
 }
 //----------------------------------------------------------------------------
 //
+// Auto-tune socket buffer of test connection from its sending rate, or from the supplied byte rate when no sending rate
+// structure is available (i.e., measured receive rate). The send buffer is sized when transmitting load PDUs, else the
+// receive buffer. Privileged processes use SO_*BUFFORCE to exceed the system maximums.
+//
+void tune_sockbuf(int connindex, struct sendingRate *sr, double rate) {
+        register struct connection *c = &conn[connindex];
+        int var, size, optname, optforce;
+        long long avail;
+        double dvar, tick = 0.0, window;
+
+        if (!conf.sockBufAuto || c->fd < 0 || c->type == T_SHARED)
+                return;
+
+        //
+        // Obtain byte rate and largest per-tick burst from sending rate (randomized sizes use their maximum)
+        //
+        if (sr != NULL) {
+                rate = 0.0;
+                if (sr->txInterval1 > 0) {
+                        tick = (double) (sr->burstSize1 & ~SRATE_RAND_BIT) *
+                               (double) ((sr->udpPayload1 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD);
+                        rate += (tick * USECINSEC) / (double) sr->txInterval1;
+                }
+                if (sr->txInterval2 > 0) {
+                        dvar = (double) (sr->burstSize2 & ~SRATE_RAND_BIT) *
+                               (double) ((sr->udpPayload2 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD);
+                        if (sr->udpAddon2 > 0)
+                                dvar += (double) ((sr->udpAddon2 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD);
+                        rate += (dvar * USECINSEC) / (double) sr->txInterval2;
+                        if (dvar > tick)
+                                tick = dvar;
+                }
+        }
+
+        //
+        // Size buffer to cover the greater of the minimum RTT or buffering window, plus two ticks
+        //
+        window = (double) SOCKBUF_AUTO_WINDOW;
+        if (c->rttMinimum != STATUS_NODEL && (double) c->rttMinimum > window)
+                window = (double) c->rttMinimum;
+        dvar = ((rate * window) / MSECINSEC) + (tick * 2.0);
+        if (dvar > (double) SOCKBUF_AUTO_MAX)
+                dvar = (double) SOCKBUF_AUTO_MAX;
+        size = (int) dvar;
+        if (size < SOCKBUF_AUTO_MIN)
+                size = SOCKBUF_AUTO_MIN;
+
+        //
+        // Limit growth to the available global budget and skip insignificant changes
+        //
+        if (size > c->sockBufSize) {
+                avail = SOCKBUF_AUTO_BUDGET - repo.sockBufTotal + c->sockBufSize;
+                if ((long long) size > avail)
+                        size = (avail > (long long) c->sockBufSize) ? (int) avail : c->sockBufSize;
+        }
+        var = size - c->sockBufSize;
+        if (var < 0)
+                var = -var;
+        if (c->sockBufSize > 0 && var <= c->sockBufSize / SOCKBUF_AUTO_HYST)
+                return;
+
+        //
+        // Apply new size to socket
+        //
+        if (c->secAction == &service_statuspdu) {
+                optname  = SO_SNDBUF;
+#ifdef SO_SNDBUFFORCE
+                optforce = SO_SNDBUFFORCE;
+#else
+                optforce = -1;
+#endif
+        } else {
+                optname  = SO_RCVBUF;
+#ifdef SO_RCVBUFFORCE
+                optforce = SO_RCVBUFFORCE;
+#else
+                optforce = -1;
+#endif
+        }
+        if (c->sockBufSize == 0) {
+                var = SOCKBUF_AUTO_MIN; // Minimize buffer of opposite direction on initial tuning
+                setsockopt(c->fd, SOL_SOCKET, (optname == SO_SNDBUF) ? SO_RCVBUF : SO_SNDBUF, (const void *) &var, sizeof(var));
+        }
+        var = -1;
+        if (!repo.sockBufNoForce && optforce >= 0) {
+                if ((var = setsockopt(c->fd, SOL_SOCKET, optforce, (const void *) &size, sizeof(size))) < 0)
+                        repo.sockBufNoForce = TRUE; // Not privileged, use standard option from now on
+        }
+        if (var < 0) {
+                if (setsockopt(c->fd, SOL_SOCKET, optname, (const void *) &size, sizeof(size)) < 0) {
+                        if (!conf.errSuppress) {
+                                var = sprintf(scratch, "[%d]SET %s ERROR: %s\n", connindex,
+                                              (optname == SO_SNDBUF) ? "SO_SNDBUF" : "SO_RCVBUF", strerror(errno));
+                                send_proc(errConn, scratch, var);
+                        }
+                        return;
+                }
+        }
+        repo.sockBufTotal += (long long) (size - c->sockBufSize);
+        c->sockBufSize = size;
+        if ((unsigned int) (repo.sockBufTotal / 1024) > repo.psMaximums.sockBufTotal)
+                repo.psMaximums.sockBufTotal = (unsigned int) (repo.sockBufTotal / 1024);
+
+        if (conf.verbose && conf.debug) {
+                var = sprintf(scratch, "[%d]DEBUG Socket buffer auto-tuned (%s: %d) for %.2f Mbps\n", connindex,
+                              (optname == SO_SNDBUF) ? "SNDBUF" : "RCVBUF", size, (rate * 8.0) / 1000000.0);
+                send_proc(monConn, scratch, var);
+        }
+        return;
+}
+//----------------------------------------------------------------------------
+//
 // Initiate a socket connect
 //
 int sock_connect(int connindex) {
@@ -1904,9 +3010,9 @@ int sock_connect(int connindex) {
         int var;
 
         //
-        // Issue connect
+        // Issue connect (not for shared test socket, where remote address is used when sending)
         //
-        if (connect(c->fd, (struct sockaddr *) &repo.remSas, repo.remSasLen) == -1) {
+        if (c->type != T_SHARED && connect(c->fd, (struct sockaddr *) &repo.remSas, repo.remSasLen) == -1) {
                 //
                 // Connect error (immediate completion expected with SOCK_DGRAM)
                 //
@@ -1956,7 +3062,10 @@ int connected(int connindex) {
         // Obtain remote IP address and port number
         //
         var = sizeof(sas);
-        if (getpeername(c->fd, (struct sockaddr *) &sas, (socklen_t *) &var) < 0) {
+        if (c->type == T_SHARED) {
+                memcpy(&sas, &c->peerSas, c->peerSasLen);
+                var = (int) c->peerSasLen;
+        } else if (getpeername(c->fd, (struct sockaddr *) &sas, (socklen_t *) &var) < 0) {
                 var = sprintf(scratch, "[%d]GETPEERNAME ERROR: %s\n", connindex, strerror(errno));
                 send_proc(errConn, scratch, var);
                 return -1;
@@ -1978,6 +3087,11 @@ int connected(int connindex) {
         } else {
                 c->ipProtocol = IPPROTO_IP;
         }
+
+        //
+        // Initialize transmit method limits (e.g., GSO segment size based on path MTU)
+        //
+        init_tx_method(connindex);
         return 0;
 }
 //----------------------------------------------------------------------------
@@ -1987,6 +3101,7 @@ int connected(int connindex) {
 int open_outputfile(int connindex) {
         register struct connection *c = &conn[connindex];
         int var;
+        time_t ttime;
         char *lbuffer, *chr, fname[STRING_SIZE];
 
         if (*conf.outputFile == '\0') {
@@ -2066,7 +3181,8 @@ int open_outputfile(int connindex) {
         //
         // Replace date/time conversion specifications with current values
         //
-        if (strftime(fname, sizeof(fname), scratch, localtime(&repo.systemClock.tv_sec)) == 0) {
+        ttime = nssec(repo.systemClock);
+        if (strftime(fname, sizeof(fname), scratch, localtime(&ttime)) == 0) {
                 return sprintf(scratch, "ERROR: Output file name length exceeds maximum\n");
         }
 
@@ -2107,7 +3223,7 @@ void insert_auth(int keyid, unsigned char *key, unsigned char *modeptr, unsigned
         ao->reservedAuth1 = 0;
 #ifdef AUTH_KEY_ENABLE
         if (ao->authMode == AUTHMODE_1) {
-                ao->authUnixTime = htonl((uint32_t) repo.systemClock.tv_sec);
+                ao->authUnixTime = htonl((uint32_t) nssec(repo.systemClock));
                 ao->keyId        = (uint8_t) keyid;
                 ao->checkSum     = 0; // Must be cleared before HMAC calculation
                 HMAC(EVP_sha256(), key, SHA256_KEY_LEN, data, data_len, ao->authDigest, &uvar);
@@ -2218,9 +3334,9 @@ int validate_auth(int pver, unsigned char *ckey, unsigned char *skey, unsigned c
         // Check authentication time window if validation was successful
         //
         if (authfail == 0 && AUTH_ENFORCE_TIME) {
-                tspecvar.tv_sec = (time_t) ntohl(ao->authUnixTime);
-                if (tspecvar.tv_sec < repo.systemClock.tv_sec - AUTH_TIME_WINDOW ||
-                    tspecvar.tv_sec > repo.systemClock.tv_sec + AUTH_TIME_WINDOW) {
+                clock_gettime(CLOCK_REALTIME, &tspecvar); // Not system clock reference (may be called by control thread)
+                tspecvar.tv_sec -= (time_t) ntohl(ao->authUnixTime);
+                if (tspecvar.tv_sec < -AUTH_TIME_WINDOW || tspecvar.tv_sec > AUTH_TIME_WINDOW) {
                         authfail = -1;
                 }
         }
@@ -41,9 +41,28 @@
 extern void init_conn(int, BOOL);
 extern int null_action(int);
 extern int send_setupreq(int, int, int);
+extern int recv_setupreq(int);
 extern int service_setupreq(int);
 extern int service_setupresp(int);
 extern int sock_mgmt(int, char *, int, char *, int);
 extern int new_conn(int, char *, int, int, int (*)(int), int (*)(int));
+extern int sock_connect(int);
+extern void tune_sockbuf(int, struct sendingRate *, double);
+extern void sockpool_init(int);
+extern void sockpool_refill(void);
+extern void sockpool_close(void);
+extern unsigned int sockpool_empty(void);
+extern int shared_init(void);
+extern int prefork_start(void);
+extern BOOL ledger_reserve(BOOL, int);
+extern void ledger_update(BOOL, int, int);
+extern void ledger_totals(int *, int *, int *);
+extern int prefork_check(void);
+extern void prefork_finish(void);
+#ifdef CONTROL_THREAD
+extern int start_ctlthread(int);
+extern void stop_ctlthread(void);
+extern void service_ctlqueue(void);
+#endif
 
 #endif /* UDPST_CONTROL_H */
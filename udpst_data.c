@@ -99,10 +99,28 @@
 #include <time.h>
 #include <math.h>
 #include <unistd.h>
+#include <netdb.h>
 #include <net/if.h>
 #include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <netinet/ip.h>  // For GSO support
 #include <netinet/udp.h> // For GSO support
+#include <linux/netlink.h>   // For netlink interface statistics
+#include <linux/rtnetlink.h> // For netlink interface statistics
+#include <linux/perf_event.h> // For calibration dTLB miss counter
+#include <linux/net_tstamp.h> // For transmit timestamps
+#include <linux/errqueue.h>   // For transmit timestamps
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>     // For invariant TSC detection
+#include <x86intrin.h> // For TSC clock reads
+#endif
 #ifdef AUTH_KEY_ENABLE
 #include <openssl/hmac.h>
 #include <openssl/x509.h>
@@ -116,10 +134,18 @@
 #include "udpst_protocol.h"
 #include "udpst.h"
 #include "udpst_data.h"
+#include "udpst_control.h"
 #ifndef __linux__
 #include "../udpst_data_alt2.h"
 #endif
 
+//----------------------------------------------------------------------------
+//
+// Hot path functions are always inlined so that each specialized variant (see select_hotpath) is compiled with its
+// feature set as a constant
+//
+#define HOT_PATH static inline __attribute__((always_inline))
+
 //----------------------------------------------------------------------------
 //
 // Internal function prototypes
@@ -140,6 +166,31 @@ void output_minimum(int);
 void output_debug(int);
 BOOL verify_datapdu(int, struct loadHdr *, struct statusHdr *);
 unsigned char *align_statuspdu(unsigned char *, BOOL);
+static void _log_write(void);
+static void _log_exit(void);
+static void _intf_debug(char *);
+static void _shared_msghdr(struct connection *, struct msghdr *, char *);
+static int _demux_lookup(struct sockaddr_storage *);
+struct aggSnap;
+static void _snap_subint(struct aggSnap *, struct connection *);
+static void _merge_snap(struct aggSnap *, struct aggSnap *);
+static struct aggSnap *_agg_slot(int);
+static double _agg_load(struct connection *);
+static void _agg_check(void);
+static BOOL _agg_pending(void);
+static void _rt_prefault(char *, size_t);
+static int _dtlb_open(void);
+static void _pdv_add(struct pdvSketch *, unsigned int);
+static void _pdv_merge(struct pdvSketch *, struct pdvSketch *);
+static unsigned int _pdv_quantile(struct pdvSketch *, int);
+static void _send_burst_std(int, int, int, int, unsigned int, unsigned int);
+static void _send_burst_any(int, int, int, int, unsigned int, unsigned int);
+#ifdef HAVE_TX_TIMESTAMPS
+static BOOL _txts_probe(void);
+static void _txts_request(struct cmsghdr *);
+static void _txts_record(struct connection *);
+static void _txts_disable(int);
+#endif
 
 //----------------------------------------------------------------------------
 //
@@ -150,6 +201,11 @@ extern char scratch[STRING_SIZE];
 extern struct configuration conf;
 extern struct repository repo;
 extern struct connection *conn;
+extern int txProbeBurst[];
+extern char *txMethodText[];
+extern char *boolText[];
+extern char *ioBufText[];
+extern char *clockSrcText[];
 //
 extern cJSON *json_top, *json_output, *json_siArray;
 extern char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
@@ -159,19 +215,85 @@ extern char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
 // Global data
 //
 #define CE_LABEL_TEXT  "/CE"
+#define LOCDROP_TEXT   "/LocDrop"
 #define LOSSRATIO_TEXT "LossRatio: %.2E, "
 #define DELIVERED_TEXT "Delivered(%%): %6.2f, "
 #define SUMMARY_TEXT   "Loss/OoO/Dup%s: %u/%u/%u%s, OWDVar(ms): %u/%u/%u, RTTVar(ms): %u/%u/%u, Mbps(L3/IP): %.2f%s\n"
 #define MINIMUM_TEXT   "Minimum One-Way Delay(ms): %d [w/clock diff], Round-Trip Time(ms): %u"
 #define MINIMUM_FINAL  MINIMUM_TEXT ", Active Connections: %d\n"
 #define DEBUG_STATS    "[Loss/OoO/Dup%s: %u/%u/%u%s, OWDVar(ms): %u/%u/%u, RTTVar(ms): %d]"
-#define CLIENT_DEBUG   "[%d]DEBUG Status Feedback " DEBUG_STATS " Mbps(L3/IP): %.2f\n"
-#define SERVER_DEBUG   "[%d]DEBUG Rate Adjustment " DEBUG_STATS " SRIndex: %d\n"
+#define CLIENT_DEBUG   "[%d]DEBUG Status Feedback " DEBUG_STATS " Mbps(L3/IP): %.2f%s\n"
+#define SERVER_DEBUG   "[%d]DEBUG Rate Adjustment " DEBUG_STATS " SRIndex: %d%s\n"
+#define INTF_DEBUG     " IntfDrops(Rx/Tx): %llu/%llu"
 static char scratch2[STRING_SIZE + 32]; // Allow for log file timestamp prefix
 static int mmsgDataSize[RECVMMSG_SIZE]; // Received data size of each message
-#define RECV_CMSG_SIZE (CMSG_SPACE(sizeof(int)))
+static int txMethodCost[TXPROBE_BURSTS][TXM_COUNT]; // Probed cost per datagram of each transmit method (ns, 0 = unavailable)
+#ifdef HAVE_SO_RXQ_OVFL
+#define RXQ_CMSG_SIZE (CMSG_SPACE(sizeof(uint32_t))) // Drop counter
+#else
+#define RXQ_CMSG_SIZE 0
+#endif
+#ifdef HAVE_SO_TIMESTAMPNS
+#define RXTS_CMSG_SIZE (CMSG_SPACE(sizeof(struct timespec))) // Kernel receive timestamp
+#else
+#define RXTS_CMSG_SIZE 0
+#endif
+#define RECV_CMSG_SIZE (CMSG_SPACE(sizeof(int)) + RXQ_CMSG_SIZE + RXTS_CMSG_SIZE) // ECN bits, drop counter and timestamp
+#define TOS_CMSG_SIZE (CMSG_SPACE(sizeof(int))) // Packet marking of message sent on shared test socket
+#ifdef HAVE_TX_TIMESTAMPS
+#define TXTS_CMSG_SIZE (CMSG_SPACE(sizeof(int))) // Transmit timestamp request of final message in burst
+#define TXTS_RECV_CMSG (CMSG_SPACE(sizeof(struct scm_timestamping)) + \
+                        CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))) // Timestamp and key
+#else
+#define TXTS_CMSG_SIZE 0
+#endif
 static char rxCmsgBuf[RECVMMSG_SIZE * RECV_CMSG_SIZE]; // Ancillary data buffer
 static int mmsgEcnBits[RECVMMSG_SIZE];                 // Received ECN bits of each message
+static nstime_t mmsgRxTime[RECVMMSG_SIZE];             // Receive time of each message (kernel timestamp if available)
+static char logBuffer[LOG_BUFFER_SIZE];                // Buffered log file output
+static int logBufSize = 0, logConn = -1;               // Size and connection of buffered log file output
+static char logTimeText[STRING_SIZE / 8];              // Cached log file timestamp
+static int logTimeSize = 0;                            // Size of cached log file timestamp
+static time_t logTimeSec;                              // Time (sec) of cached log file timestamp
+static int demuxTable[DEMUX_TABLE_SIZE];               // Test connection (index + 1) at head of each demux chain
+static char demuxBuf[RECVMMSG_SIZE * DEMUX_RCV_SIZE];  // Receive buffer of shared test sockets
+//
+// Sub-interval stats of a test connection or worker process, as merged into an aggregation slot
+//
+struct aggSnap {
+        struct subIntStats sisSav;  // Sub-interval saved stats
+        unsigned int sisSavCECount; // Sub-interval saved CE count
+        unsigned int sisSavDropCnt; // Sub-interval saved local drop count
+        struct pdvSketch sisSavPdv; // Sub-interval saved delay variation sketch
+        unsigned int rttVarSum;     // RTT variation sum
+        unsigned int rttVarCnt;     // RTT variation count
+        int clockDeltaMin;          // Clock delta minimum
+        unsigned int rttMinimum;    // Minimum round-trip time
+        int ecnCEThresh;            // ECN CE threshold
+        int ecnBleachCount;         // ECN bleach count
+        double rateL3;              // Rates (L3/IP, L2/Eth, L1/Eth, L1/Eth+VLAN)
+        double rateL2;              //
+        double rateL1;              //
+        double rateL0;              //
+        double intfMbps;            // Interface rate (aggregation slot only)
+        int connCount;              // Connections merged (aggregation slot only)
+};
+static struct aggSnap aggSlot[AGG_SLOTS]; // Aggregation slots of upcoming sub-intervals (indexed by sub-interval count)
+//
+// Shared memory of each client worker process, written only by the worker (except as noted) and read by parent
+//
+struct workerShm {
+        struct aggSnap snap[WORKER_SNAP_RING];    // Sub-interval snapshots (indexed by sub-interval count)
+        int snapSeq[WORKER_SNAP_RING];            // Sub-interval count of each snapshot (zero if none)
+        atomic_int published;                     // Sub-interval snapshots published
+        atomic_int actConnCount;                  // Active test connections
+        atomic_int endTimeStatus;                 // Final status of worker
+        atomic_int done;                          // Worker finished, all snapshots published
+        atomic_int merged;                        // Sub-interval snapshots merged (written by parent)
+        pid_t pid;                                // Worker process ID (parent only)
+};
+static struct workerShm *workerShm = NULL; // Shared memory of worker processes (array)
+static cpu_set_t rtMask;                   // Original CPU affinity (realtime profile)
 
 //----------------------------------------------------------------------------
 // Function definitions
@@ -180,16 +302,21 @@ static int mmsgEcnBits[RECVMMSG_SIZE];                 // Received ECN bits of e
 // Populate the static part of the our message header
 //
 static void _populate_header(struct loadHdr *lHdr, struct connection *c, unsigned int rttRespDelay) {
+        nstime_t sendtime = repo.systemClock;
+
+#ifdef TX_TSTAMP_CORRECT
+        sendtime += c->txHostQueue; // Account for standing host queueing (as measured for earlier bursts)
+#endif
         lHdr->pduId      = htons(LOAD_ID);
         lHdr->testAction = (uint8_t) c->testAction;
         lHdr->rxStopped  = (uint8_t) c->rxStoppedLoc;
         // lpduSeqNo populated by the send function
         // udpPayload populated by the send function
         lHdr->spduSeqErr    = htons((uint16_t) c->spduSeqErr);
-        lHdr->spduTime_sec  = htonl((uint32_t) c->spduTime.tv_sec);
-        lHdr->spduTime_nsec = htonl((uint32_t) c->spduTime.tv_nsec);
-        lHdr->lpduTime_sec  = htonl((uint32_t) repo.systemClock.tv_sec);
-        lHdr->lpduTime_nsec = htonl((uint32_t) repo.systemClock.tv_nsec);
+        lHdr->spduTime_sec  = htonl((uint32_t) nssec(c->spduTime));
+        lHdr->spduTime_nsec = htonl((uint32_t) nsnsec(c->spduTime));
+        lHdr->lpduTime_sec  = htonl((uint32_t) nssec(sendtime));
+        lHdr->lpduTime_nsec = htonl((uint32_t) nsnsec(sendtime));
         lHdr->rttRespDelay  = htons((uint16_t) rttRespDelay);
         lHdr->checkSum      = 0; // Updated in send function if needed
 }
@@ -237,7 +364,8 @@ static void _randomize_payload(char *buffer, unsigned int length) {
 //
 // Update performance statistics based on message(s) accepted by send request
 //
-static void _update_send_ps(int connindex, int requested, int accepted, unsigned int payload, unsigned int addon) {
+static void _update_send_ps(int connindex, int requested, int accepted, int deferred, unsigned int payload,
+                            unsigned int addon) {
         register struct connection *c = &conn[connindex];
         unsigned int uvar;
         struct perfStatsAverages *psA = &repo.psAverages;
@@ -273,286 +401,920 @@ static void _update_send_ps(int connindex, int requested, int accepted, unsigned
         }
 
         //
-        // Requested messages that are not accepted are considered overruns
+        // Count messages deferred until socket is writable and track deferred transmit queue size
+        //
+        if (deferred > 0) {
+                psA->txDeferred += (unsigned int) deferred;
+                if (c->txq != NULL && (unsigned int) c->txq->dgCount > psM->txQueueSize)
+                        psM->txQueueSize = (unsigned int) c->txq->dgCount;
+        }
+
+        //
+        // Requested messages that are neither accepted nor deferred are considered overruns
         //
-        if (accepted < requested) {
+        if (accepted + deferred < requested) {
                 psA->txOverrunCount++;
-                uvar = (unsigned int) (requested - accepted);
+                uvar = (unsigned int) (requested - accepted - deferred);
                 psA->txOverrunTotal += uvar;
                 if (uvar > psM->txOverrunSize)
                         psM->txOverrunSize = uvar;
         }
         return;
 }
-#if defined(HAVE_SENDMMSG)
-#if defined(HAVE_GSO)
 //----------------------------------------------------------------------------
 //
-// Send a burst of messages using GSO (Generic Segmentation Offload)
+// Register (or deregister) for notification of socket becoming writable
 //
-static void _sendmmsg_gso(int connindex, int totalburst, int burstsize, unsigned int payload, unsigned int addon) {
+static void _txq_epollout(int connindex, BOOL enable) {
         register struct connection *c = &conn[connindex];
-        char *sndbuf, *nextsndbuf, cmsgbuf[GSO_CMSG_SIZE * MMSG_SEGMENTS] = {0};
-        unsigned int uvar, rttrd = 0, totalsize;
-        int i, j, var, senderrno, reqburst;
-        struct cmsghdr *cmsg;
-        struct mmsghdr mmsg[MMSG_SEGMENTS];
-        struct iovec iov[MMSG_SEGMENTS];
-        struct timespec tspecvar;
-
-        //
-        // Calculate RTT response delay
-        //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                rttrd = (unsigned int) tspecmsec(&tspecvar);
-        }
-
-        //
-        // Prepare send structures
-        //
-        memset(mmsg, 0, sizeof(mmsg));
-        if (c->randPayload) {
-                sndbuf = repo.sndBufRand;
-        } else {
-                sndbuf = repo.sndBuffer;
-        }
-        j        = 0;          // Overall message count for sendmmsg()
-        reqburst = totalburst; // Requested total burst size
-        cmsg     = (struct cmsghdr *) cmsgbuf;
-        while (reqburst > 0) {
-                //
-                // Fill send buffer until GSO limit or burst completion
-                //
-                totalsize  = 0;
-                nextsndbuf = sndbuf;
-                for (i = 0; i < reqburst; i++) {
-                        if (i < burstsize)
-                                uvar = payload;
-                        else
-                                uvar = addon;
-                        //
-                        // Check for GSO limits
-                        //
-                        if (i >= UDP_MAX_SEGMENTS) // Segment limit
-                                break;
-                        if (totalsize + uvar > IP_MAXPACKET) // Size limit
-                                break;
-                        //
-                        // Build load PDU (including corresponding control message on first one)
-                        //
-                        struct loadHdr *lHdr = (struct loadHdr *) nextsndbuf;
-                        _populate_header(lHdr, c, rttrd);
-                        lHdr->lpduSeqNo  = htonl((uint32_t) ++c->lpduSeqNo);
-                        lHdr->udpPayload = htons((uint16_t) uvar);
-#ifdef ADD_HEADER_CSUM
-                        lHdr->checkSum = checksum(lHdr, sizeof(struct loadHdr));
-#endif
-                        if (c->randPayload) {
-                                _randomize_payload((char *) lHdr + sizeof(struct loadHdr), uvar - sizeof(struct loadHdr));
-                        }
-                        if (i == 0) {
-                                cmsg->cmsg_len                  = GSO_CMSG_LEN;
-                                cmsg->cmsg_level                = SOL_UDP;
-                                cmsg->cmsg_type                 = UDP_SEGMENT;
-                                *((uint16_t *) CMSG_DATA(cmsg)) = (uint16_t) uvar;
-                        }
-                        totalsize += uvar;
-                        nextsndbuf += payload;
-                }
-                reqburst -= i;
-                if (burstsize > 0)
-                        burstsize -= i;
-
-                //
-                // Setup message structure for buffer
-                //
-                iov[j].iov_base                = (void *) sndbuf;
-                iov[j].iov_len                 = (size_t) totalsize;
-                mmsg[j].msg_hdr.msg_iov        = &iov[j];
-                mmsg[j].msg_hdr.msg_iovlen     = 1;
-                mmsg[j].msg_hdr.msg_control    = cmsg;
-                mmsg[j].msg_hdr.msg_controllen = GSO_CMSG_SIZE;
-                j++;
-
-                //
-                // Advance to next send buffer
-                //
-                sndbuf += DEF_BUFFER_SIZE;
-                cmsg = (struct cmsghdr *) ((char *) cmsg + GSO_CMSG_SIZE);
-        }
+        struct epoll_event epevent;
 
-        //
-        // Send complete burst with single system call
-        //
-        // NOTE: Certain error conditions are expected when overloading an interface
-        //
-        var       = sendmmsg(c->fd, mmsg, j, 0);
-        senderrno = errno;
-        if (var == -1 && (senderrno == EINVAL || senderrno == EMSGSIZE)) { // Flag GSO incompatibility (for older OR newer kernels)
-                var = sprintf(scratch, "ERROR: GSO incompatible with IP fragmentation (disable jumbo sizes or increase MTU)\n");
-                send_proc(errConn, scratch, var);
-                tspeccpy(&c->endTime, &repo.systemClock); // End testing
+        if (c->txq->epollOut == enable || c->type == T_SHARED) // Shared test socket is flushed prior to next burst
                 return;
+        epevent.events = EPOLLIN;
+        if (enable)
+                epevent.events |= EPOLLOUT;
+        epevent.data.u32 = (uint32_t) connindex;
+        if (epoll_ctl(repo.epollFD, EPOLL_CTL_MOD, c->fd, &epevent) == 0)
+                c->txq->epollOut = enable;
+}
+//----------------------------------------------------------------------------
+//
+// Reset deferred transmit queue to empty
+//
+static void _txq_reset(int connindex) {
+        register struct txQueue *q = conn[connindex].txq;
+
+        q->head    = 0;
+        q->tail    = 0;
+        q->used    = 0;
+        q->dgCount = 0;
+        _txq_epollout(connindex, FALSE);
+}
+//----------------------------------------------------------------------------
+//
+// Move unsent messages (and their data) of deferred transmit queue to the front, reclaiming space of sent ones
+//
+static void _txq_compact(struct txQueue *q) {
+        int i, shift = q->entry[q->head].offset;
+
+        q->tail -= q->head;
+        memmove(&q->entry[0], &q->entry[q->head], q->tail * sizeof(struct txQueueEntry));
+        q->head = 0;
+        q->used -= shift;
+        memmove(&q->buffer[0], &q->buffer[shift], q->used);
+        for (i = 0; i < q->tail; i++) {
+                q->entry[i].offset -= shift;
         }
-        //
-        // Calculate accepted message burst size from accepted buffer length(s)
-        //
-        j = 0; // Datagrams accepted
-        for (i = 0; i < var; i++) {
-                uvar = mmsg[i].msg_len; // Number of bytes transmitted
-                if (payload > 0) {
-                        totalsize = uvar / payload;  // Count of payloads within buffer
-                        j += (int) totalsize;        // Add to overall burst size
-                        uvar -= totalsize * payload; // Reduce buffer size accordingly
-                }
-                if (uvar > 0)
-                        j++; // Leftover data is addon
+}
+//----------------------------------------------------------------------------
+//
+// Add message to deferred transmit queue (allocated on first use)
+//
+// Return count of datagrams added (zero if queue is full)
+//
+static int _txq_add(int connindex, char *message, unsigned int length, unsigned int segsize) {
+        register struct connection *c = &conn[connindex];
+        register struct txQueue *q;
+        struct txQueueEntry *e;
+
+        if ((q = c->txq) == NULL) {
+                if ((q = (struct txQueue *) malloc(sizeof(struct txQueue))) == NULL)
+                        return 0;
+                q->epollOut = FALSE;
+                c->txq      = q;
+                _txq_reset(connindex);
         }
-        if (conf.seqNumAdjust && j < totalburst) { // Adjust sequence numbers to correct for datagrams not accepted
-                c->lpduSeqNo -= (unsigned int) (totalburst - j);
+        if (q->tail >= TXQ_MAX_ENTRIES || q->used + (int) length > TXQ_BUFFER_SIZE) {
+                if (q->head == 0)
+                        return 0;
+                _txq_compact(q); // Reclaim space of messages already sent
+                if (q->used + (int) length > TXQ_BUFFER_SIZE)
+                        return 0;
         }
-        if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) { // Update performance statistics
-                _update_send_ps(connindex, totalburst, j, payload, addon);
+        if (q->dgCount == 0) {
+                _txq_epollout(connindex, TRUE);
         }
-        if (!conf.errSuppress) {
-                if (var < 0 && senderrno != EAGAIN) {
-                        //
-                        // An error of EAGAIN (Resource temporarily unavailable) indicates the send buffer is full
-                        //
-                        if ((var = socket_error(connindex, senderrno, "SENDMMSG+GSO")) > 0)
-                                send_proc(errConn, scratch, var);
+        e          = &q->entry[q->tail++];
+        e->offset  = q->used;
+        e->length  = length;
+        e->segSize = segsize;
+        e->dgCount = 1;
+        if (segsize > 0)
+                e->dgCount = (int) ((length + segsize - 1) / segsize);
+        e->enqTime = repo.monoClock;
+        memcpy(&q->buffer[q->used], message, length);
+        q->used += (int) length;
+        q->dgCount += e->dgCount;
+        return e->dgCount;
+}
+//----------------------------------------------------------------------------
+//
+// Defer messages not accepted by socket (single datagram each)
+//
+// Return count of datagrams deferred
+//
+static int _txq_defer(int connindex, struct iovec *iov, int count) {
+        int i, var, deferred = 0;
 
-                } else if (j < totalburst) {
-                        //
-                        // Not all messages sent indicates the send buffer is full
-                        //
-                        var = sprintf(scratch, "[%d]SENDMMSG+GSO OVERRUN: Only %d out of %d sent\n", connindex, j, totalburst);
-                        send_proc(errConn, scratch, var);
-                }
+        for (i = 0; i < count; i++) {
+                if ((var = _txq_add(connindex, (char *) iov[i].iov_base, (unsigned int) iov[i].iov_len, 0)) == 0)
+                        break; // Queue full, remaining are overruns
+                deferred += var;
         }
+        return deferred;
 }
-#else
+//----------------------------------------------------------------------------
 //
-// Send a burst of messages using the Linux 3.0+ only sendmmsg syscall
+// Renumber datagrams of a deferred message after earlier datagrams were discarded (so that none appear lost)
 //
-static void _sendmmsg_burst(int connindex, int totalburst, int burstsize, unsigned int payload, unsigned int addon) {
-        register struct connection *c = &conn[connindex];
-        static struct mmsghdr mmsg[MAX_BURST_SIZE]; // Static array
-        static struct iovec iov[MAX_BURST_SIZE];    // Static array
-        unsigned int uvar, rttrd = 0;
-        char *nextsndbuf;
-        int i, j, var, senderrno;
-        struct timespec tspecvar;
+static void _txq_renumber(struct txQueue *q, struct txQueueEntry *e, unsigned int count) {
         struct loadHdr *lHdr;
+        unsigned int offset, step;
 
-        //
-        // Calculate RTT response delay
-        //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                rttrd = (unsigned int) tspecmsec(&tspecvar);
-        }
-
-        //
-        // Prepare send structures
-        //
-        memset(mmsg, 0, totalburst * sizeof(struct mmsghdr));
-        if (c->randPayload) {
-                nextsndbuf = repo.sndBufRand;
-        } else {
-                nextsndbuf = repo.sndBuffer;
-        }
-        for (i = 0; i < totalburst; i++) {
-                lHdr = (struct loadHdr *) nextsndbuf;
-                _populate_header(lHdr, c, rttrd);
-                lHdr->lpduSeqNo = htonl((uint32_t) ++c->lpduSeqNo);
-                if (i < burstsize)
-                        uvar = payload;
-                else
-                        uvar = addon;
-                lHdr->udpPayload = htons((uint16_t) uvar);
+        if ((step = e->segSize) == 0)
+                step = e->length;
+        for (offset = 0; offset < e->length; offset += step) {
+                lHdr            = (struct loadHdr *) &q->buffer[e->offset + (int) offset];
+                lHdr->lpduSeqNo = htonl(ntohl(lHdr->lpduSeqNo) - (uint32_t) count);
 #ifdef ADD_HEADER_CSUM
+                lHdr->checkSum = 0;
                 lHdr->checkSum = checksum(lHdr, sizeof(struct loadHdr));
 #endif
-                if (c->randPayload) {
-                        _randomize_payload((char *) lHdr + sizeof(struct loadHdr), uvar - sizeof(struct loadHdr));
-                }
-
-                //
-                // Setup corresponding message structure
-                //
-                iov[i].iov_base            = (void *) lHdr;
-                iov[i].iov_len             = (size_t) uvar;
-                mmsg[i].msg_hdr.msg_iov    = &iov[i];
-                mmsg[i].msg_hdr.msg_iovlen = 1;
-                nextsndbuf += payload;
         }
+}
+//----------------------------------------------------------------------------
+//
+// Discard oldest deferred messages, either expired or (with a send error) all of them
+//
+// Their sequence numbers are reused by renumbering the remaining (more recently generated) datagrams, so the
+// rollback is limited to the datagrams actually discarded
+//
+static void _txq_discard(int connindex, int count, int senderrno) {
+        register struct connection *c = &conn[connindex];
+        register struct txQueue *q    = c->txq;
+        int i, var, expired = 0;
 
-        //
-        // Send complete burst with single system call
-        //
-        // NOTE: Certain error conditions are expected when overloading an interface
-        //
-        var       = sendmmsg(c->fd, mmsg, totalburst, 0);
-        senderrno = errno;
-        if ((j = var) < 0) // Datagrams accepted
-                j = 0;
-        if (conf.seqNumAdjust && j < totalburst) { // Adjust sequence numbers to correct for datagrams not accepted
-                c->lpduSeqNo -= (unsigned int) (totalburst - j);
+        for (i = 0; i < count && q->head < q->tail; i++) {
+                expired += q->entry[q->head++].dgCount;
+        }
+        q->dgCount -= expired;
+        if (conf.seqNumAdjust) {
+                c->lpduSeqNo -= (unsigned int) expired;
+                for (i = q->head; i < q->tail; i++) {
+                        _txq_renumber(q, &q->entry[i], (unsigned int) expired);
+                }
         }
-        if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) { // Update performance statistics
-                _update_send_ps(connindex, totalburst, j, payload, addon);
+        if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) {
+                repo.psAverages.txExpired += (unsigned int) expired;
         }
+        if (q->head >= q->tail)
+                _txq_reset(connindex);
         if (!conf.errSuppress) {
-                if (var < 0 && senderrno != EAGAIN) {
-                        //
-                        // An error of EAGAIN (Resource temporarily unavailable) indicates the send buffer is full
-                        //
-                        if ((var = socket_error(connindex, senderrno, "SENDMMSG")) > 0)
-                                send_proc(errConn, scratch, var);
-
-                } else if (j < totalburst) {
-                        //
-                        // Not all messages sent indicates the send buffer is full
-                        //
-                        var = sprintf(scratch, "[%d]SENDMMSG OVERRUN: Only %d out of %d sent\n", connindex, j, totalburst);
+                if (senderrno != 0) {
+                        if (log_event(connindex, LOG_EVT_SENDERR, "TXQUEUE ERROR", 0)) {
+                                if ((var = socket_error(connindex, senderrno, "TXQUEUE")) > 0)
+                                        send_proc(errConn, scratch, var);
+                        }
+                } else if (log_event(connindex, LOG_EVT_TXQEXP, "TXQUEUE EXPIRED", (unsigned int) expired)) {
+                        var = sprintf(scratch, "[%d]TXQUEUE EXPIRED: %d deferred datagrams not sent within %d ms\n", connindex,
+                                      expired, TXQ_MAX_DELAY);
                         send_proc(errConn, scratch, var);
                 }
         }
 }
-#endif // HAVE_GSO
-#else
+//----------------------------------------------------------------------------
 //
-// Send a burst of messages using the slower but more widely available sendmsg syscall
+// Send datagrams from deferred transmit queue (when socket becomes writable or prior to the next burst)
+//
+// Return count of datagrams remaining in queue
 //
-static void _sendmsg_burst(int connindex, int totalburst, int burstsize, unsigned int payload, unsigned int addon) {
+int flush_txqueue(int connindex) {
         register struct connection *c = &conn[connindex];
+        register struct txQueue *q    = c->txq;
+        struct txQueueEntry *e;
+        int i, var, senderrno = 0;
+        char tosbuf[TOS_CMSG_SIZE];
+        struct perfStatsAverages *psA = &repo.psAverages;
+#if defined(HAVE_SENDMMSG)
+        int j;
+        static struct mmsghdr mmsg[TXQ_MAX_ENTRIES]; // Static array
+        static struct iovec iov[TXQ_MAX_ENTRIES];    // Static array
+#if defined(HAVE_GSO)
+        static char cmsgbuf[GSO_CMSG_SIZE * TXQ_MAX_ENTRIES];
+        struct cmsghdr *cmsg;
+#endif
+#else
         struct msghdr msg;
         struct iovec iov;
-        unsigned int uvar, rttrd = 0;
-        int i, j, var, senderrno;
-        struct loadHdr *lHdr;
-        struct timespec tspecvar;
+#endif
+
+        if (q == NULL)
+                return 0;
+        if (q->dgCount == 0) {
+                _txq_reset(connindex);
+                return 0;
+        }
 
         //
-        // Calculate RTT response delay
+        // Expire queued messages (oldest first) not sent within maximum delay
         //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                rttrd = (unsigned int) tspecmsec(&tspecvar);
+        for (i = q->head; i < q->tail; i++) {
+                if (repo.monoClock - q->entry[i].enqTime <= (nstime_t) TXQ_MAX_DELAY * NSECINMSEC)
+                        break;
+        }
+        if (i > q->head) {
+                _txq_discard(connindex, i - q->head, 0);
+                if (q->dgCount == 0)
+                        return 0;
         }
 
         //
-        // Prepare send structures
+        // Send queued messages in order
         //
-        memset((void *) &msg, 0, sizeof(struct msghdr));
-        if (c->randPayload) {
-                lHdr = (struct loadHdr *) repo.sndBufRand;
-        } else {
-                lHdr = (struct loadHdr *) repo.sndBuffer;
+#if defined(HAVE_SENDMMSG)
+        memset(mmsg, 0, (q->tail - q->head) * sizeof(struct mmsghdr));
+        for (i = q->head, j = 0; i < q->tail; i++, j++) {
+                e                          = &q->entry[i];
+                iov[j].iov_base            = (void *) &q->buffer[e->offset];
+                iov[j].iov_len             = (size_t) e->length;
+                mmsg[j].msg_hdr.msg_iov    = &iov[j];
+                mmsg[j].msg_hdr.msg_iovlen = 1;
+                if (c->type == T_SHARED)
+                        _shared_msghdr(c, &mmsg[j].msg_hdr, tosbuf);
+#if defined(HAVE_GSO)
+                if (e->segSize > 0) {
+                        cmsg                            = (struct cmsghdr *) &cmsgbuf[j * GSO_CMSG_SIZE];
+                        cmsg->cmsg_len                  = GSO_CMSG_LEN;
+                        cmsg->cmsg_level                = SOL_UDP;
+                        cmsg->cmsg_type                 = UDP_SEGMENT;
+                        *((uint16_t *) CMSG_DATA(cmsg)) = (uint16_t) e->segSize;
+                        mmsg[j].msg_hdr.msg_control     = cmsg;
+                        mmsg[j].msg_hdr.msg_controllen  = GSO_CMSG_SIZE;
+                }
+#endif
         }
-        _populate_header(lHdr, c, rttrd);
+        var = sendmmsg(c->fd, mmsg, j, 0);
+        if (var < 0)
+                senderrno = errno;
+#else
+        memset((void *) &msg, 0, sizeof(struct msghdr));
+        if (c->type == T_SHARED)
+                _shared_msghdr(c, &msg, tosbuf);
+        for (i = q->head, var = 0; i < q->tail; i++, var++) {
+                e              = &q->entry[i];
+                iov.iov_base   = (void *) &q->buffer[e->offset];
+                iov.iov_len    = (size_t) e->length;
+                msg.msg_iov    = &iov;
+                msg.msg_iovlen = 1;
+                if (sendmsg(c->fd, &msg, 0) < 0) {
+                        senderrno = errno;
+                        if (var == 0)
+                                var = -1;
+                        break;
+                }
+        }
+#endif
+        if (var < 0) {
+                if (senderrno != EAGAIN)
+                        _txq_discard(connindex, q->tail - q->head, senderrno); // Unexpected error, nothing more can be sent
+                return c->txq->dgCount;
+        }
+
+        //
+        // Remove sent messages from queue and update performance statistics
+        //
+        for (i = 0; i < var; i++) {
+                e = &q->entry[q->head++];
+                q->dgCount -= e->dgCount;
+                if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) {
+                        psA->qdDatagrams += (unsigned int) e->dgCount;
+                        psA->qdBytes += (unsigned long long) e->length;
+                        psA->qdBytes += (unsigned long long) (e->dgCount * L3DG_OVERHEAD);
+                        if (c->ipProtocol == IPPROTO_IPV6) {
+                                psA->qdBytes += (unsigned long long) (e->dgCount * IPV6_ADDSIZE);
+                        }
+                }
+        }
+        if (q->head >= q->tail)
+                _txq_reset(connindex);
+        return q->dgCount;
+}
+#ifdef HAVE_TX_TIMESTAMPS
+//----------------------------------------------------------------------------
+//
+// Enable transmit timestamps of load PDU bursts on a dedicated (not shared) test socket
+//
+// Software timestamps are generated when the final message of each burst enters the packet scheduler (qdisc) and
+// when it is handed to the driver. Only bursts that request them via ancillary data are timestamped, so the key
+// of each (SOF_TIMESTAMPING_OPT_ID) simply counts timestamped bursts accepted by the socket.
+//
+void init_txtstamp(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var;
+        static int cmsgcheck = 0; // Requests via ancillary data accepted (1) or rejected (-1) by kernel, zero if unchecked
+
+#ifndef TX_TSTAMP_CORRECT
+        if (conf.psFile == NULL)
+                return; // Only needed for performance statistics
+#endif
+        if (c->type == T_SHARED)
+                return;
+        if (cmsgcheck == 0) {
+                cmsgcheck = _txts_probe() ? 1 : -1;
+                if (cmsgcheck < 0 && conf.verbose) {
+                        var = sprintf(scratch, "INFO: Transmit timestamp requests rejected by kernel, timestamps disabled\n");
+                        send_proc(monConn, scratch, var);
+                }
+        }
+        if (cmsgcheck < 0)
+                return;
+        var = SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+        if (setsockopt(c->fd, SOL_SOCKET, SO_TIMESTAMPING, (const void *) &var, sizeof(var)) == 0)
+                c->txTimestamp = TRUE;
+}
+//----------------------------------------------------------------------------
+//
+// Verify that transmit timestamp requests via ancillary data are accepted (also following a GSO control message,
+// as built by _sendmmsg_gso) by sending to a loopback socket connected to itself
+//
+static BOOL _txts_probe(void) {
+        int fd, var;
+        BOOL result = FALSE;
+        struct sockaddr_in sin;
+        socklen_t slen = sizeof(sin);
+        struct msghdr msg;
+        struct iovec iov;
+        char cmsgbuf[GSO_CMSG_SIZE + TXTS_CMSG_SIZE] = {0};
+#ifdef HAVE_GSO
+        struct cmsghdr *cmsg = (struct cmsghdr *) cmsgbuf;
+#endif
+
+        memset(&sin, 0, sizeof(sin));
+        sin.sin_family      = AF_INET;
+        sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+                return FALSE;
+        var = SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+        if (bind(fd, (struct sockaddr *) &sin, slen) == 0 && getsockname(fd, (struct sockaddr *) &sin, &slen) == 0 &&
+            connect(fd, (struct sockaddr *) &sin, slen) == 0 &&
+            setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, (const void *) &var, sizeof(var)) == 0) {
+                memset(&msg, 0, sizeof(msg));
+                iov.iov_base       = (void *) repo.sndBuffer;
+                iov.iov_len        = (size_t) MIN_PAYLOAD_SIZE;
+                msg.msg_iov        = &iov;
+                msg.msg_iovlen     = 1;
+                msg.msg_control    = cmsgbuf;
+                msg.msg_controllen = TXTS_CMSG_SIZE;
+                _txts_request((struct cmsghdr *) cmsgbuf);
+                result = (sendmsg(fd, &msg, MSG_DONTWAIT) >= 0);
+#ifdef HAVE_GSO
+                if (result && repo.gsoAvail) {
+                        cmsg->cmsg_len                  = GSO_CMSG_LEN;
+                        cmsg->cmsg_level                = SOL_UDP;
+                        cmsg->cmsg_type                 = UDP_SEGMENT;
+                        *((uint16_t *) CMSG_DATA(cmsg)) = (uint16_t) MIN_PAYLOAD_SIZE;
+                        _txts_request((struct cmsghdr *) &cmsgbuf[GSO_CMSG_SIZE]);
+                        iov.iov_len        = (size_t) MIN_PAYLOAD_SIZE * 2;
+                        msg.msg_controllen = GSO_CMSG_SIZE + TXTS_CMSG_SIZE;
+                        result             = (sendmsg(fd, &msg, MSG_DONTWAIT) >= 0);
+                }
+#endif
+        }
+        close(fd);
+        return result;
+}
+//----------------------------------------------------------------------------
+//
+// Disable transmit timestamps of connection after a request was rejected on the data path
+//
+static void _txts_disable(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var;
+
+        c->txTimestamp = FALSE;
+        if (c->infoCount < INFO_MSG_LIMIT && conf.verbose) {
+                c->infoCount++;
+                var = sprintf(scratch, "[%d]INFO: Transmit timestamp request rejected, timestamps disabled\n", connindex);
+                send_proc(monConn, scratch, var);
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Build control message requesting transmit timestamps of a single message
+//
+static void _txts_request(struct cmsghdr *cmsg) {
+        cmsg->cmsg_len             = CMSG_LEN(sizeof(int));
+        cmsg->cmsg_level           = SOL_SOCKET;
+        cmsg->cmsg_type            = SO_TIMESTAMPING;
+        *((int *) CMSG_DATA(cmsg)) = SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE;
+}
+//----------------------------------------------------------------------------
+//
+// Record timestamped burst accepted by socket (oldest outstanding one is dropped if ring is full)
+//
+static void _txts_record(struct connection *c) {
+        struct txTsBurst *b;
+
+        if (c->txTsTail - c->txTsHead >= TXTS_RING_SIZE) {
+                c->txTsHead++;
+                if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL)
+                        repo.psAverages.txTsMissed++;
+        }
+        b            = &c->txTsRing[c->txTsTail++ % TXTS_RING_SIZE];
+        b->key       = c->txTsKey++;
+        b->sendTime  = repo.systemClock; // Uncorrected time used in load PDUs
+        b->schedTime = 0;
+}
+//----------------------------------------------------------------------------
+//
+// Service transmit timestamps of load PDU bursts from socket error queue
+//
+// Host queueing of each burst is the time from its send time (as carried in the load PDUs) until the final
+// message is handed to the driver, with the portion spent in the packet scheduler (qdisc) tracked separately.
+// Its minimum over a window of bursts represents the standing queue, which (unlike transient spikes) also
+// applies to subsequent bursts and is therefore used for correction. Returns the number of timestamps read
+// (zero indicates error queue was empty).
+//
+int service_txtstamp(int connindex) {
+        register struct connection *c = &conn[connindex];
+        static struct mmsghdr mmsg[TXTS_RECV_SIZE];            // Static array
+        static char cmsgbuf[TXTS_RECV_SIZE * TXTS_RECV_CMSG]; // Static array
+        struct perfStatsAverages *psA = &repo.psAverages;
+        struct perfStatsMaximums *psM = &repo.psMaximums;
+        struct scm_timestamping *tss;
+        struct sock_extended_err *serr;
+        struct cmsghdr *cmsg;
+        struct txTsBurst *b;
+        nstime_t tstime, delay;
+        unsigned int uvar;
+        int i, var, total = 0;
+        BOOL pstats = (c->testAction == TEST_ACT_TEST && conf.psFile != NULL);
+
+        do {
+                //
+                // Read available timestamps (with OPT_TSONLY there is no payload, only control messages)
+                //
+                memset(mmsg, 0, sizeof(mmsg));
+                for (i = 0; i < TXTS_RECV_SIZE; i++) {
+                        mmsg[i].msg_hdr.msg_control    = &cmsgbuf[i * TXTS_RECV_CMSG];
+                        mmsg[i].msg_hdr.msg_controllen = TXTS_RECV_CMSG;
+                }
+                if ((var = recvmmsg(c->fd, mmsg, TXTS_RECV_SIZE, MSG_ERRQUEUE | MSG_DONTWAIT, NULL)) <= 0)
+                        break;
+                total += var;
+
+                for (i = 0; i < var; i++) {
+                        tss  = NULL;
+                        serr = NULL;
+                        for (cmsg = CMSG_FIRSTHDR(&mmsg[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&mmsg[i].msg_hdr, cmsg)) {
+                                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+                                        tss = (struct scm_timestamping *) CMSG_DATA(cmsg);
+                                } else if ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                                           (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+                                        serr = (struct sock_extended_err *) CMSG_DATA(cmsg);
+                                }
+                        }
+                        if (tss == NULL || serr == NULL || serr->ee_errno != ENOMSG ||
+                            serr->ee_origin != SO_EE_ORIGIN_TIMESTAMPING)
+                                continue;
+
+                        //
+                        // Skip outstanding bursts whose timestamps were missed (e.g., error queue overflow), then
+                        // match key of oldest remaining one (else timestamp is stale)
+                        //
+                        while (c->txTsHead != c->txTsTail) {
+                                if ((int) (serr->ee_data - c->txTsRing[c->txTsHead % TXTS_RING_SIZE].key) <= 0)
+                                        break;
+                                c->txTsHead++;
+                                if (pstats)
+                                        psA->txTsMissed++;
+                        }
+                        if (c->txTsHead == c->txTsTail)
+                                continue;
+                        b = &c->txTsRing[c->txTsHead % TXTS_RING_SIZE];
+                        if (b->key != serr->ee_data)
+                                continue;
+                        tstime = tspec2ns(&tss->ts[0]);
+                        if (serr->ee_info == SCM_TSTAMP_SCHED) {
+                                b->schedTime = tstime;
+                                continue;
+                        } else if (serr->ee_info != SCM_TSTAMP_SND) {
+                                continue;
+                        }
+
+                        //
+                        // Burst complete, update minimum host queueing for correction and performance statistics
+                        //
+                        c->txTsHead++;
+                        if ((delay = tstime - b->sendTime) < 0 || delay > TXTS_MAX_DELAY)
+                                continue; // Implausible (e.g., wall clock step)
+                        if (c->txHostQSamples == 0 || delay < c->txHostQMin)
+                                c->txHostQMin = delay;
+                        if (++c->txHostQSamples >= TXTS_WINDOW) {
+                                c->txHostQueue    = c->txHostQMin;
+                                c->txHostQSamples = 0;
+                        }
+                        if (!pstats)
+                                continue;
+                        uvar = (unsigned int) nsusec(delay);
+                        psA->txHostQSum += (unsigned long long) uvar;
+                        psA->txHostQCount++;
+                        if (uvar > psM->txHostQMax)
+                                psM->txHostQMax = uvar;
+                        if (b->schedTime != 0 && tstime >= b->schedTime) {
+                                uvar = (unsigned int) nsusec(tstime - b->schedTime);
+                                psA->txQdiscSum += (unsigned long long) uvar;
+                                psA->txQdiscCount++;
+                                if (uvar > psM->txQdiscMax)
+                                        psM->txQdiscMax = uvar;
+                        }
+                }
+        } while (var == TXTS_RECV_SIZE);
+
+        return total;
+}
+#endif // HAVE_TX_TIMESTAMPS
+#if defined(HAVE_SENDMMSG)
+//----------------------------------------------------------------------------
+//
+// Send a burst of messages using the Linux 3.0+ only sendmmsg syscall
+//
+HOT_PATH void _sendmmsg_burst(int connindex, int totalburst, int burstsize, unsigned int payload, unsigned int addon,
+                              const int hp) {
+        register struct connection *c = &conn[connindex];
+        static struct mmsghdr mmsg[MAX_BURST_SIZE]; // Static array
+        static struct iovec iov[MAX_BURST_SIZE];    // Static array
+        unsigned int uvar, rttrd = 0;
+        char *nextsndbuf, tosbuf[TOS_CMSG_SIZE];
+        int i, j, k, var, senderrno;
+        struct loadHdr *lHdr;
+#ifdef HAVE_TX_TIMESTAMPS
+        char txtsbuf[TXTS_CMSG_SIZE];
+#endif
+
+        //
+        // Calculate RTT response delay
+        //
+        if (c->pduRxTime != 0) {
+                rttrd = (unsigned int) nsmsec(repo.monoClock - c->pduRxTime);
+        }
+
+        //
+        // Prepare send structures
+        //
+        memset(mmsg, 0, totalburst * sizeof(struct mmsghdr));
+        if (hp & HP_RANDPAY) {
+                nextsndbuf = repo.sndBufRand;
+        } else {
+                nextsndbuf = repo.sndBuffer;
+        }
+        for (i = 0; i < totalburst; i++) {
+                lHdr = (struct loadHdr *) nextsndbuf;
+                _populate_header(lHdr, c, rttrd);
+                lHdr->lpduSeqNo = htonl((uint32_t) ++c->lpduSeqNo);
+                if (i < burstsize)
+                        uvar = payload;
+                else
+                        uvar = addon;
+                lHdr->udpPayload = htons((uint16_t) uvar);
+#ifdef ADD_HEADER_CSUM
+                lHdr->checkSum = checksum(lHdr, sizeof(struct loadHdr));
+#endif
+                if (hp & HP_RANDPAY) {
+                        _randomize_payload((char *) lHdr + sizeof(struct loadHdr), uvar - sizeof(struct loadHdr));
+                }
+
+                //
+                // Setup corresponding message structure
+                //
+                iov[i].iov_base            = (void *) lHdr;
+                iov[i].iov_len             = (size_t) uvar;
+                mmsg[i].msg_hdr.msg_iov    = &iov[i];
+                mmsg[i].msg_hdr.msg_iovlen = 1;
+                if (hp & HP_SHARED)
+                        _shared_msghdr(c, &mmsg[i].msg_hdr, tosbuf);
+                nextsndbuf += payload;
+        }
+#ifdef HAVE_TX_TIMESTAMPS
+        if (c->txTimestamp) { // Request transmit timestamps of final message (never on shared test socket)
+                _txts_request((struct cmsghdr *) txtsbuf);
+                mmsg[totalburst - 1].msg_hdr.msg_control    = txtsbuf;
+                mmsg[totalburst - 1].msg_hdr.msg_controllen = TXTS_CMSG_SIZE;
+        }
+#endif
+
+        //
+        // Send complete burst with single system call (unless datagrams are already deferred, to maintain order)
+        //
+        // NOTE: Certain error conditions are expected when overloading an interface
+        //
+        if (c->txq != NULL && c->txq->dgCount > 0) {
+                var       = -1;
+                senderrno = EAGAIN;
+        } else {
+                var       = sendmmsg(c->fd, mmsg, totalburst, 0);
+                senderrno = errno;
+        }
+#ifdef HAVE_TX_TIMESTAMPS
+        if (var == -1 && senderrno == EINVAL && c->txTimestamp && totalburst == 1) {
+                //
+                // Transmit timestamp request of (only) message rejected, disable it and resend without
+                //
+                _txts_disable(connindex);
+                mmsg[0].msg_hdr.msg_control    = NULL;
+                mmsg[0].msg_hdr.msg_controllen = 0;
+                var                            = sendmmsg(c->fd, mmsg, totalburst, 0);
+                senderrno                      = errno;
+        }
+#endif
+        if ((j = var) < 0) // Datagrams accepted
+                j = 0;
+#ifdef HAVE_TX_TIMESTAMPS
+        if (c->txTimestamp && j == totalburst)
+                _txts_record(c);
+#endif
+        k = 0; // Datagrams deferred
+        if (var >= 0 || senderrno == EAGAIN) {
+                k = _txq_defer(connindex, &iov[j], totalburst - j);
+        }
+        if ((hp & HP_SEQADJ) && j + k < totalburst) { // Adjust sequence numbers to correct for datagrams not accepted
+                c->lpduSeqNo -= (unsigned int) (totalburst - j - k);
+        }
+        if ((hp & HP_PSTATS) && c->testAction == TEST_ACT_TEST) { // Update performance statistics
+                _update_send_ps(connindex, totalburst, j, k, payload, addon);
+        }
+        if (!conf.errSuppress) {
+                if (var < 0 && senderrno != EAGAIN) {
+                        //
+                        // An error of EAGAIN (Resource temporarily unavailable) indicates the send buffer is full
+                        //
+                        if (log_event(connindex, LOG_EVT_SENDERR, "SENDMMSG ERROR", 0)) {
+                                if ((var = socket_error(connindex, senderrno, "SENDMMSG")) > 0)
+                                        send_proc(errConn, scratch, var);
+                        }
+
+                } else if (j + k < totalburst) {
+                        //
+                        // Not all messages sent or deferred indicates the send buffer (and deferred queue) is full
+                        //
+                        if (log_event(connindex, LOG_EVT_OVERRUN, "SENDMMSG OVERRUN", (unsigned int) (totalburst - j - k))) {
+                                var = sprintf(scratch, "[%d]SENDMMSG OVERRUN: Only %d out of %d sent (%d deferred)\n", connindex,
+                                              j, totalburst, k);
+                                send_proc(errConn, scratch, var);
+                        }
+                }
+        }
+}
+#if defined(HAVE_GSO)
+//----------------------------------------------------------------------------
+//
+// Send a burst of messages using GSO (Generic Segmentation Offload)
+//
+HOT_PATH void _sendmmsg_gso(int connindex, int totalburst, int burstsize, unsigned int payload, unsigned int addon,
+                            const int hp) {
+        register struct connection *c = &conn[connindex];
+        char *sndbuf, *nextsndbuf, cmsgbuf[GSO_CMSG_SIZE * MMSG_SEGMENTS + TXTS_CMSG_SIZE] = {0};
+        unsigned int uvar, rttrd = 0, totalsize;
+        int i, j, k, var, senderrno, reqburst, savburst, bufcount;
+        struct cmsghdr *cmsg;
+        struct mmsghdr mmsg[MMSG_SEGMENTS];
+        struct iovec iov[MMSG_SEGMENTS];
+
+        //
+        // Calculate RTT response delay
+        //
+        if (c->pduRxTime != 0) {
+                rttrd = (unsigned int) nsmsec(repo.monoClock - c->pduRxTime);
+        }
+
+        //
+        // Prepare send structures
+        //
+        memset(mmsg, 0, sizeof(mmsg));
+        if (hp & HP_RANDPAY) {
+                sndbuf = repo.sndBufRand;
+        } else {
+                sndbuf = repo.sndBuffer;
+        }
+        j        = 0;          // Overall message count for sendmmsg()
+        reqburst = totalburst; // Requested total burst size
+        savburst = burstsize;  // Saved burst size (for fallback)
+        cmsg     = (struct cmsghdr *) cmsgbuf;
+        while (reqburst > 0) {
+                //
+                // Fill send buffer until GSO limit or burst completion
+                //
+                totalsize  = 0;
+                nextsndbuf = sndbuf;
+                for (i = 0; i < reqburst; i++) {
+                        if (i < burstsize)
+                                uvar = payload;
+                        else
+                                uvar = addon;
+                        //
+                        // Check for GSO limits
+                        //
+                        if (i >= c->gsoMaxSegs) // Segment limit
+                                break;
+                        if (totalsize + uvar > IP_MAXPACKET) // Size limit
+                                break;
+                        //
+                        // Build load PDU (including corresponding control message on first one)
+                        //
+                        struct loadHdr *lHdr = (struct loadHdr *) nextsndbuf;
+                        _populate_header(lHdr, c, rttrd);
+                        lHdr->lpduSeqNo  = htonl((uint32_t) ++c->lpduSeqNo);
+                        lHdr->udpPayload = htons((uint16_t) uvar);
+#ifdef ADD_HEADER_CSUM
+                        lHdr->checkSum = checksum(lHdr, sizeof(struct loadHdr));
+#endif
+                        if (hp & HP_RANDPAY) {
+                                _randomize_payload((char *) lHdr + sizeof(struct loadHdr), uvar - sizeof(struct loadHdr));
+                        }
+                        if (i == 0) {
+                                cmsg->cmsg_len                  = GSO_CMSG_LEN;
+                                cmsg->cmsg_level                = SOL_UDP;
+                                cmsg->cmsg_type                 = UDP_SEGMENT;
+                                *((uint16_t *) CMSG_DATA(cmsg)) = (uint16_t) uvar;
+                        }
+                        totalsize += uvar;
+                        nextsndbuf += payload;
+                }
+                reqburst -= i;
+                if (burstsize > 0)
+                        burstsize -= i;
+
+                //
+                // Setup message structure for buffer
+                //
+                iov[j].iov_base                = (void *) sndbuf;
+                iov[j].iov_len                 = (size_t) totalsize;
+                mmsg[j].msg_hdr.msg_iov        = &iov[j];
+                mmsg[j].msg_hdr.msg_iovlen     = 1;
+                mmsg[j].msg_hdr.msg_control    = cmsg;
+                mmsg[j].msg_hdr.msg_controllen = GSO_CMSG_SIZE;
+                j++;
+
+                //
+                // Advance to next send buffer
+                //
+                sndbuf += DEF_BUFFER_SIZE;
+                cmsg = (struct cmsghdr *) ((char *) cmsg + GSO_CMSG_SIZE);
+        }
+
+#ifdef HAVE_TX_TIMESTAMPS
+        //
+        // Request transmit timestamps of final buffer (i.e., its last segment) by appending to its control message
+        //
+        if (c->txTimestamp) {
+                _txts_request((struct cmsghdr *) ((char *) mmsg[j - 1].msg_hdr.msg_control + GSO_CMSG_SIZE));
+                mmsg[j - 1].msg_hdr.msg_controllen = GSO_CMSG_SIZE + TXTS_CMSG_SIZE;
+        }
+#endif
+
+        //
+        // Send complete burst with single system call (unless datagrams are already deferred, to maintain order)
+        //
+        // NOTE: Certain error conditions are expected when overloading an interface
+        //
+        bufcount = j;
+        if (c->txq != NULL && c->txq->dgCount > 0) {
+                var       = -1;
+                senderrno = EAGAIN;
+        } else {
+                var       = sendmmsg(c->fd, mmsg, bufcount, 0);
+                senderrno = errno;
+        }
+#ifdef HAVE_TX_TIMESTAMPS
+        if (var == -1 && senderrno == EINVAL && c->txTimestamp && bufcount == 1) {
+                //
+                // Transmit timestamp request may have been rejected instead of GSO (on the only buffer), disable it
+                // and resend without before restricting GSO
+                //
+                _txts_disable(connindex);
+                mmsg[0].msg_hdr.msg_controllen = GSO_CMSG_SIZE;
+                var                            = sendmmsg(c->fd, mmsg, bufcount, 0);
+                senderrno                      = errno;
+        }
+#endif
+        if (var == -1 && (senderrno == EINVAL || senderrno == EMSGSIZE)) { // Flag GSO incompatibility (for older OR newer kernels)
+                //
+                // Restrict GSO on this connection based on the limit exceeded by the failing (initial) buffer, i.e.,
+                // segment count of older kernels or segment size requiring IP fragmentation, then resend the complete
+                // burst without GSO
+                //
+                uvar = (unsigned int) *((uint16_t *) CMSG_DATA((struct cmsghdr *) mmsg[0].msg_hdr.msg_control));
+                i    = (int) ((iov[0].iov_len + uvar - 1) / uvar); // Segment count of failing buffer
+                if (i > GSO_LEGACY_SEGMENTS && c->gsoMaxSegs > GSO_LEGACY_SEGMENTS) {
+                        c->gsoMaxSegs = GSO_LEGACY_SEGMENTS;
+                } else {
+                        c->gsoMaxPayload = (int) uvar - 1;
+                }
+                if (c->infoCount < INFO_MSG_LIMIT && conf.verbose) {
+                        c->infoCount++;
+                        var = sprintf(scratch, "[%d]INFO: GSO incompatible with segment size/count (%u/%d), using SENDMMSG\n",
+                                      connindex, uvar, i);
+                        send_proc(monConn, scratch, var);
+                }
+                if ((hp & HP_PSTATS) && c->testAction == TEST_ACT_TEST) {
+                        repo.psCounters.gsoFallback++;
+                }
+                c->lpduSeqNo -= (unsigned int) totalburst; // Nothing accepted, reuse sequence numbers
+                _sendmmsg_burst(connindex, totalburst, savburst, payload, addon, hp);
+                return;
+        }
+        //
+        // Calculate accepted message burst size from accepted buffer length(s)
+        //
+        j = 0; // Datagrams accepted
+        for (i = 0; i < var; i++) {
+                uvar = mmsg[i].msg_len; // Number of bytes transmitted
+                if (payload > 0) {
+                        totalsize = uvar / payload;  // Count of payloads within buffer
+                        j += (int) totalsize;        // Add to overall burst size
+                        uvar -= totalsize * payload; // Reduce buffer size accordingly
+                }
+                if (uvar > 0)
+                        j++; // Leftover data is addon
+        }
+#ifdef HAVE_TX_TIMESTAMPS
+        if (c->txTimestamp && var == bufcount)
+                _txts_record(c);
+#endif
+        k = 0; // Datagrams deferred (retaining segmentation of each unsent buffer)
+        if (var >= 0 || senderrno == EAGAIN) {
+                for (i = (var > 0) ? var : 0; i < bufcount; i++) {
+                        uvar = (unsigned int) *((uint16_t *) CMSG_DATA((struct cmsghdr *) mmsg[i].msg_hdr.msg_control));
+                        if ((totalsize = (unsigned int) _txq_add(connindex, (char *) iov[i].iov_base,
+                                                                 (unsigned int) iov[i].iov_len, uvar)) == 0)
+                                break; // Queue full, remaining are overruns
+                        k += (int) totalsize;
+                }
+        }
+        if ((hp & HP_SEQADJ) && j + k < totalburst) { // Adjust sequence numbers to correct for datagrams not accepted
+                c->lpduSeqNo -= (unsigned int) (totalburst - j - k);
+        }
+        if ((hp & HP_PSTATS) && c->testAction == TEST_ACT_TEST) { // Update performance statistics
+                _update_send_ps(connindex, totalburst, j, k, payload, addon);
+        }
+        if (!conf.errSuppress) {
+                if (var < 0 && senderrno != EAGAIN) {
+                        //
+                        // An error of EAGAIN (Resource temporarily unavailable) indicates the send buffer is full
+                        //
+                        if (log_event(connindex, LOG_EVT_SENDERR, "SENDMMSG+GSO ERROR", 0)) {
+                                if ((var = socket_error(connindex, senderrno, "SENDMMSG+GSO")) > 0)
+                                        send_proc(errConn, scratch, var);
+                        }
+
+                } else if (j + k < totalburst) {
+                        //
+                        // Not all messages sent or deferred indicates the send buffer (and deferred queue) is full
+                        //
+                        if (log_event(connindex, LOG_EVT_OVERRUN, "SENDMMSG+GSO OVERRUN", (unsigned int) (totalburst - j - k))) {
+                                var = sprintf(scratch, "[%d]SENDMMSG+GSO OVERRUN: Only %d out of %d sent (%d deferred)\n",
+                                              connindex, j, totalburst, k);
+                                send_proc(errConn, scratch, var);
+                        }
+                }
+        }
+}
+#endif // HAVE_GSO
+#endif // HAVE_SENDMMSG
+//----------------------------------------------------------------------------
+//
+// Send a burst of messages using the slower but more widely available sendmsg syscall
+//
+HOT_PATH void _sendmsg_burst(int connindex, int totalburst, int burstsize, unsigned int payload, unsigned int addon,
+                             const int hp) {
+        register struct connection *c = &conn[connindex];
+        struct msghdr msg;
+        struct iovec iov;
+        unsigned int uvar, rttrd = 0;
+        int i, j, k, var, senderrno;
+        char tosbuf[TOS_CMSG_SIZE];
+        struct loadHdr *lHdr;
+
+        //
+        // Calculate RTT response delay
+        //
+        if (c->pduRxTime != 0) {
+                rttrd = (unsigned int) nsmsec(repo.monoClock - c->pduRxTime);
+        }
+
+        //
+        // Prepare send structures
+        //
+        memset((void *) &msg, 0, sizeof(struct msghdr));
+        if (hp & HP_SHARED)
+                _shared_msghdr(c, &msg, tosbuf);
+        if (hp & HP_RANDPAY) {
+                lHdr = (struct loadHdr *) repo.sndBufRand;
+        } else {
+                lHdr = (struct loadHdr *) repo.sndBuffer;
+        }
+        _populate_header(lHdr, c, rttrd);
 
         for (i = 0; i < totalburst; i++) {
                 lHdr->lpduSeqNo = htonl((uint32_t) ++c->lpduSeqNo);
@@ -565,7 +1327,7 @@ static void _sendmsg_burst(int connindex, int totalburst, int burstsize, unsigne
                 lHdr->checkSum = 0; // Zero on each pass because _populate_header() is only called once
                 lHdr->checkSum = checksum(lHdr, sizeof(struct loadHdr));
 #endif
-                if (c->randPayload) {
+                if (hp & HP_RANDPAY) {
                         _randomize_payload((char *) lHdr + sizeof(struct loadHdr), uvar - sizeof(struct loadHdr));
                 }
 
@@ -578,39 +1340,736 @@ static void _sendmsg_burst(int connindex, int totalburst, int burstsize, unsigne
                 msg.msg_iovlen = 1;
 
                 //
-                // Send a single message of our burst with a system call
+                // Send a single message of our burst with a system call (unless datagrams are already deferred)
                 //
                 // NOTE: Certain error conditions are expected when overloading an interface
                 //
-                var       = sendmsg(c->fd, &msg, 0);
-                senderrno = errno;
-                if (conf.seqNumAdjust && var <= 0) { // Adjust sequence number to correct for datagram not accepted
+                if (c->txq != NULL && c->txq->dgCount > 0) {
+                        var       = -1;
+                        senderrno = EAGAIN;
+                } else {
+                        var       = sendmsg(c->fd, &msg, 0);
+                        senderrno = errno;
+                }
+                k = 0; // Datagram deferred
+                if (var < 0 && senderrno == EAGAIN) {
+                        k = _txq_defer(connindex, &iov, 1);
+                }
+                if ((hp & HP_SEQADJ) && var <= 0 && k == 0) { // Adjust sequence number to correct for datagram not accepted
                         c->lpduSeqNo--;
                 }
-                if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) { // Update performance statistics
+                if ((hp & HP_PSTATS) && c->testAction == TEST_ACT_TEST) { // Update performance statistics
                         if ((j = var) > 0)
                                 j = 1; // Convert byte count to message count of one (valid for UDP)
-                        _update_send_ps(connindex, 1, j, 0, uvar);
+                        _update_send_ps(connindex, 1, j, k, 0, uvar);
                 }
                 if (!conf.errSuppress) {
                         if (var < 0 && senderrno != EAGAIN) {
                                 //
                                 // An error of EAGAIN (Resource temporarily unavailable) indicates the send buffer is full
                                 //
-                                if ((var = socket_error(connindex, senderrno, "SENDMSG")) > 0)
+                                if (log_event(connindex, LOG_EVT_SENDERR, "SENDMSG ERROR", 0)) {
+                                        if ((var = socket_error(connindex, senderrno, "SENDMSG")) > 0)
+                                                send_proc(errConn, scratch, var);
+                                }
+
+                        } else if (var <= 0 && k == 0) {
+                                //
+                                // Message not sent or deferred indicates the send buffer (and deferred queue) is full
+                                //
+                                if (log_event(connindex, LOG_EVT_OVERRUN, "SENDMSG OVERRUN", 1)) {
+                                        var = sprintf(scratch, "[%d]SENDMSG OVERRUN: Datagram (%u bytes) not sent\n", connindex,
+                                                      uvar);
                                         send_proc(errConn, scratch, var);
+                                }
+                        }
+                }
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Select transmit method for a burst (method of current sending rate row, unless not permitted on this connection)
+//
+static int _select_tx_method(struct connection *c, int burstsize, unsigned int payload, unsigned int addon) {
+        int txm = c->txMethod;
+        unsigned int segsize;
+
+        //
+        // Use sendmmsg() instead of GSO when segment size or count is not permitted on this connection
+        //
+        if (txm == TXM_GSO) {
+                if (burstsize > 0)
+                        segsize = payload;
+                else
+                        segsize = addon;
+                if (c->gsoMaxSegs < 1 || segsize > (unsigned int) c->gsoMaxPayload)
+                        txm = TXM_SENDMMSG;
+        }
+        return txm;
+}
+//----------------------------------------------------------------------------
+//
+// Send a burst of zero-filled datagrams via the specified transmit method (used for probing only)
+//
+// Return 0 if all datagrams were accepted, else -1
+//
+static int _probe_send(int fd, int txm, int burst, unsigned int payload, int maxsegs) {
+        int i;
+        struct msghdr msg;
+        struct iovec iov[TXPROBE_MAXBURST];
+#if defined(HAVE_SENDMMSG)
+        int j, var;
+        struct mmsghdr mmsg[TXPROBE_MAXBURST];
+#if defined(HAVE_GSO)
+        char cmsgbuf[GSO_CMSG_SIZE * TXPROBE_MAXBURST] = {0};
+        struct cmsghdr *cmsg = (struct cmsghdr *) cmsgbuf;
+#endif
+#endif
+#if defined(HAVE_SENDMMSG) && !defined(HAVE_GSO)
+        (void) maxsegs; // Only used by GSO
+#endif
+        if (burst < 1 || payload == 0)
+                return -1;
+
+        if (txm == TXM_SENDMSG) {
+                memset(&msg, 0, sizeof(msg));
+                iov[0].iov_base = (void *) repo.sndBuffer;
+                iov[0].iov_len  = (size_t) payload;
+                msg.msg_iov     = &iov[0];
+                msg.msg_iovlen  = 1;
+                for (i = 0; i < burst; i++) {
+                        if (sendmsg(fd, &msg, 0) != (ssize_t) payload)
+                                return -1;
+                }
+                return 0;
+        }
+#if defined(HAVE_SENDMMSG)
+        if (burst > TXPROBE_MAXBURST && txm != TXM_GSO)
+                return -1;
+        memset(mmsg, 0, sizeof(mmsg));
+        for (i = j = 0; i < burst; i += var, j++) {
+                var = 1;
+#if defined(HAVE_GSO)
+                if (txm == TXM_GSO) {
+                        //
+                        // Fill buffer with as many segments as allowed (all buffers share a single send buffer)
+                        //
+                        if ((var = burst - i) > maxsegs)
+                                var = maxsegs;
+                        if ((unsigned int) var * payload > IP_MAXPACKET)
+                                var = (int) (IP_MAXPACKET / payload);
+                        cmsg->cmsg_len                  = GSO_CMSG_LEN;
+                        cmsg->cmsg_level                = SOL_UDP;
+                        cmsg->cmsg_type                 = UDP_SEGMENT;
+                        *((uint16_t *) CMSG_DATA(cmsg)) = (uint16_t) payload;
+                        mmsg[j].msg_hdr.msg_control     = cmsg;
+                        mmsg[j].msg_hdr.msg_controllen  = GSO_CMSG_SIZE;
+                        cmsg                            = (struct cmsghdr *) ((char *) cmsg + GSO_CMSG_SIZE);
+                }
+#endif
+                if (var < 1 || j >= TXPROBE_MAXBURST)
+                        return -1;
+                iov[j].iov_base            = (void *) repo.sndBuffer;
+                iov[j].iov_len             = (size_t) var * payload;
+                mmsg[j].msg_hdr.msg_iov    = &iov[j];
+                mmsg[j].msg_hdr.msg_iovlen = 1;
+        }
+        if (sendmmsg(fd, mmsg, j, 0) != j)
+                return -1;
+        return 0;
+#else
+        (void) (maxsegs);
+        return -1;
+#endif
+}
+//----------------------------------------------------------------------------
+//
+// Discard all datagrams queued on receiving socket of probe (so that every burst is delivered, not dropped)
+//
+static void _probe_drain(int fd) {
+        while (recv(fd, NULL, 0, MSG_DONTWAIT | MSG_TRUNC) >= 0)
+                ;
+}
+//----------------------------------------------------------------------------
+//
+// Probe transmit methods at startup via a loopback socket pair
+//
+// Verifies GSO support (and its segment limit) at runtime, then measures the
+// per-datagram cost of each available method for each probed burst size. The
+// best of several runs is kept, with the receiver drained between bursts. The
+// cheapest method for each sending rate row is then derived from these costs
+// (see set_tx_method). If probing cannot be performed, the compile-time
+// selection is used for all rows.
+//
+void probe_tx_methods(void) {
+        int i, j, k, var, txm, run, rxfd, txfd, cost;
+        unsigned int payload = MAX_PAYLOAD_SIZE;
+        nstime_t nsec;
+        struct sockaddr_in sin;
+        socklen_t slen;
+        struct timespec tspecstart, tspecend;
+
+        //
+        // Initialize to compile-time selection
+        //
+        repo.gsoAvail   = FALSE;
+        repo.gsoMaxSegs = GSO_LEGACY_SEGMENTS;
+        txm             = TXM_SENDMSG;
+#if defined(HAVE_SENDMMSG)
+        txm = TXM_SENDMMSG;
+#if defined(HAVE_GSO)
+        txm             = TXM_GSO;
+        repo.gsoAvail   = TRUE;
+        repo.gsoMaxSegs = UDP_MAX_SEGMENTS;
+#endif
+#endif
+        for (i = 0; i < TXPROBE_BURSTS; i++) {
+                repo.txProbeMethod[i] = txm;
+                repo.txProbeCost[i]   = 0;
+                for (j = 0; j < TXM_COUNT; j++)
+                        txMethodCost[i][j] = 0;
+        }
+
+        //
+        // Create loopback socket pair
+        //
+        memset(&sin, 0, sizeof(sin));
+        sin.sin_family      = AF_INET;
+        sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if ((rxfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+                return;
+        if ((txfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+                close(rxfd);
+                return;
+        }
+        slen = sizeof(sin);
+        if (bind(rxfd, (struct sockaddr *) &sin, slen) < 0 || getsockname(rxfd, (struct sockaddr *) &sin, &slen) < 0 ||
+            connect(txfd, (struct sockaddr *) &sin, slen) < 0) {
+                close(txfd);
+                close(rxfd);
+                return;
+        }
+        var = fcntl(txfd, F_GETFL, 0);
+        fcntl(txfd, F_SETFL, var | O_NONBLOCK);
+
+#if defined(HAVE_GSO)
+        //
+        // Verify GSO support and determine segment limit (newer kernels allow more segments than older ones)
+        //
+        repo.gsoAvail = FALSE;
+        for (var = UDP_MAX_SEGMENTS; var >= (int) GSO_LEGACY_SEGMENTS; var /= 2) {
+                if (_probe_send(txfd, TXM_GSO, var, (unsigned int) MIN_PAYLOAD_SIZE, var) == 0) {
+                        repo.gsoAvail   = TRUE;
+                        repo.gsoMaxSegs = var;
+                        break;
+                }
+        }
+        _probe_drain(rxfd);
+#endif
+
+        //
+        // Measure per-datagram cost of each available method for each burst size (best of several runs)
+        //
+        for (i = 0; i < TXPROBE_BURSTS; i++) {
+                for (txm = TXM_SENDMSG; txm < TXM_COUNT; txm++) {
+                        if (txm == TXM_GSO && !repo.gsoAvail)
+                                continue;
+                        k = _probe_send(txfd, txm, txProbeBurst[i], payload, repo.gsoMaxSegs); // Also serves as warm-up
+                        for (run = 0; run < TXPROBE_RUNS && k == 0; run++) {
+                                nsec = 0;
+                                for (j = 0; j < TXPROBE_ITERATIONS && k == 0; j++) {
+                                        _probe_drain(rxfd);
+                                        clock_gettime(CLOCK_MONOTONIC, &tspecstart);
+                                        k = _probe_send(txfd, txm, txProbeBurst[i], payload, repo.gsoMaxSegs);
+                                        clock_gettime(CLOCK_MONOTONIC, &tspecend);
+                                        nsec += tspec2ns(&tspecend) - tspec2ns(&tspecstart);
+                                }
+                                if ((cost = (int) (nsec / (TXPROBE_ITERATIONS * txProbeBurst[i]))) < 1)
+                                        cost = 1;
+                                if (txMethodCost[i][txm] == 0 || cost < txMethodCost[i][txm])
+                                        txMethodCost[i][txm] = cost;
+                        }
+                        _probe_drain(rxfd);
+                        if (k != 0) {
+                                txMethodCost[i][txm] = 0; // Unavailable
+                                continue;
+                        }
+                        if (repo.txProbeCost[i] == 0 || txMethodCost[i][txm] < repo.txProbeCost[i]) {
+                                repo.txProbeMethod[i] = txm;
+                                repo.txProbeCost[i]   = txMethodCost[i][txm];
+                        }
+                }
+        }
+        close(txfd);
+        close(rxfd);
+
+        if (conf.verbose) {
+                var = sprintf(scratch, "Transmit probe (Burst=Method[ns/dg]):");
+                for (i = 0; i < TXPROBE_BURSTS; i++) {
+                        var += sprintf(&scratch[var], " %d=%s[%d]", txProbeBurst[i], txMethodText[repo.txProbeMethod[i]],
+                                       repo.txProbeCost[i]);
+                }
+                if (repo.gsoAvail)
+                        var += sprintf(&scratch[var], ", GSO Max Segments: %d\n", repo.gsoMaxSegs);
+                else
+                        var += sprintf(&scratch[var], ", GSO: Unavailable\n");
+                send_proc(monConn, scratch, var);
+        }
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Estimated transmit cost (ns per second) of one timer of a sending rate row via the specified method, based on the
+// probed cost of the largest probed burst size not exceeding the burst of the timer
+//
+// Return -1 if method is unavailable
+//
+static double _row_tx_cost(int txm, int burst, unsigned int interval) {
+        int i;
+
+        if (burst < 1 || interval == 0)
+                return 0.0;
+        for (i = TXPROBE_BURSTS - 1; i > 0; i--) {
+                if (burst >= txProbeBurst[i])
+                        break;
+        }
+        if (txMethodCost[i][txm] == 0)
+                return -1.0;
+        return ((double) burst * (double) txMethodCost[i][txm] * USECINSEC) / (double) interval;
+}
+//----------------------------------------------------------------------------
+//
+// Set transmit method of connection for a sending rate row (cheapest method for the combined bursts of both timers)
+//
+void set_tx_method(int connindex, struct sendingRate *sr) {
+        register struct connection *c = &conn[connindex];
+        int txm, burst1 = 0, burst2 = 0;
+        double cost1, cost2, best = -1.0;
+
+        if (sr == NULL)
+                return;
+        if (sr->txInterval1 > 0)
+                burst1 = (int) (sr->burstSize1 & ~SRATE_RAND_BIT);
+        if (sr->txInterval2 > 0) {
+                burst2 = (int) (sr->burstSize2 & ~SRATE_RAND_BIT);
+                if ((sr->udpAddon2 & ~SRATE_RAND_BIT) > 0)
+                        burst2++;
+        }
+        c->txMethod = repo.txProbeMethod[TXPROBE_BURSTS - 1]; // If not probed
+        for (txm = TXM_SENDMSG; txm < TXM_COUNT; txm++) {
+                cost1 = _row_tx_cost(txm, burst1, sr->txInterval1);
+                cost2 = _row_tx_cost(txm, burst2, sr->txInterval2);
+                if (cost1 < 0.0 || cost2 < 0.0)
+                        continue;
+                if (best < 0.0 || cost1 + cost2 < best) {
+                        c->txMethod = txm;
+                        best        = cost1 + cost2;
+                }
+        }
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Clock layer
+//
+// Pacing (all timers, deadlines and measurement intervals) uses the monotonic
+// clock in repo.monoClock so that a wall clock step (e.g., by NTP) does not
+// disturb transmit schedules. The wall clock in repo.systemClock, used for PDU
+// timestamps and output, is derived from the same read using an offset that is
+// resynchronized every CLOCK_SYNC_INT. Both are cached copies, updated once per
+// batch of work (ready FD or timer action) via clock_update().
+//
+// If built with HAVE_TSC_CLOCK and the CPU has an invariant TSC, the pacing
+// clock is read from the TSC (calibrated against CLOCK_MONOTONIC and rebased at
+// each resync) instead of via clock_gettime().
+//
+#if defined(HAVE_TSC_CLOCK) && (defined(__x86_64__) || defined(__i386__))
+#define TSC_CLOCK
+static BOOL _tsc_invariant(void) {
+        unsigned int eax, ebx, ecx, edx;
+
+        if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007)
+                return FALSE;
+        if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+                return FALSE;
+        return (edx & (1U << 8)) ? TRUE : FALSE; // Invariant TSC
+}
+//
+// Read TSC and monotonic clock as a pair (TSC taken as midpoint of monotonic clock read)
+//
+static unsigned long long _tsc_pair(nstime_t *nsp) {
+        unsigned long long tsc;
+
+        tsc = __rdtsc();
+        nsgettime(CLOCK_MONOTONIC, nsp);
+        return tsc + ((__rdtsc() - tsc) / 2);
+}
+#endif
+//
+// Read pacing clock (TSC converted to nanoseconds, else monotonic clock)
+//
+static inline nstime_t _clock_read(void) {
+        nstime_t nsvar;
+
+#ifdef TSC_CLOCK
+        if (repo.clockSource == CLOCK_SRC_TSC)
+                return repo.tscBaseNs + (nstime_t) ((double) (__rdtsc() - repo.tscBase) * repo.tscNsPerTick);
+#endif
+        nsgettime(CLOCK_MONOTONIC, &nsvar);
+        return nsvar;
+}
+//
+// Resynchronize wall clock offset (and rebase TSC conversion) from the kernel clocks
+//
+// The offset is taken against the pacing clock itself (not a separate monotonic clock read), so that TSC error
+// or a forward clamp of the rebase does not appear in the wall clock used for PDU timestamps
+//
+static void _clock_sync(void) {
+        nstime_t nswall, nsmono;
+
+#ifdef TSC_CLOCK
+        if (repo.clockSource == CLOCK_SRC_TSC) {
+                repo.tscBase      = _tsc_pair(&nsmono);
+                repo.tscNsPerTick = (double) (nsmono - repo.tscCalNs) / (double) (repo.tscBase - repo.tscCal);
+                repo.tscBaseNs    = nsmono;
+                if (repo.tscBaseNs < repo.monoClock) // Never step pacing clock backwards
+                        repo.tscBaseNs = repo.monoClock;
+        }
+#endif
+        nsmono = _clock_read();
+        nsgettime(CLOCK_REALTIME, &nswall);
+        repo.monoClock     = _clock_read();
+        repo.wallOffset    = nswall - (nsmono + (repo.monoClock - nsmono) / 2); // Pacing clock at midpoint of wall read
+        repo.clockSyncTime = repo.monoClock + (nstime_t) CLOCK_SYNC_INT * NSECINMSEC;
+}
+//
+// Update pacing and wall clock references
+//
+void clock_update(void) {
+        repo.monoClock = _clock_read();
+        repo.psAverages.clockReads++;
+        if (repo.monoClock >= repo.clockSyncTime)
+                _clock_sync(); // Also updates pacing clock
+        repo.systemClock = repo.monoClock + repo.wallOffset;
+}
+//
+// Initialize clock layer (select pacing clock source, calibrate TSC if used, and set initial references)
+//
+void clock_init(void) {
+#ifdef TSC_CLOCK
+        nstime_t nsvar;
+        struct timespec tspecvar;
+#endif
+
+        repo.clockSource = CLOCK_SRC_MONO;
+#ifdef TSC_CLOCK
+        if (_tsc_invariant()) {
+                tspecvar.tv_sec  = 0;
+                tspecvar.tv_nsec = TSC_CALIB_TIME * NSECINMSEC;
+                repo.tscCal      = _tsc_pair(&repo.tscCalNs);
+                nanosleep(&tspecvar, NULL);
+                repo.tscBase = _tsc_pair(&nsvar);
+                if (repo.tscBase > repo.tscCal) {
+                        repo.tscNsPerTick = (double) (nsvar - repo.tscCalNs) / (double) (repo.tscBase - repo.tscCal);
+                        repo.tscBaseNs    = nsvar;
+                        if (repo.tscNsPerTick > 0.01 && repo.tscNsPerTick < 10.0) // Sanity check (100 MHz to 100 GHz)
+                                repo.clockSource = CLOCK_SRC_TSC;
+                }
+        }
+#endif
+        repo.monoClock     = 0;
+        repo.clockSyncTime = 0; // Force resync on first update
+        clock_update();
+}
+//
+// Measure read cost of each available clock source (including CLOCK_REALTIME for reference)
+//
+void probe_clock_reads(void) {
+        int i, j, var;
+        nstime_t nsstart, nsend, nsvar = 0;
+
+        for (i = 0; i < CLOCK_SRC_COUNT; i++) {
+                repo.clockReadCost[i] = 0;
+#ifdef TSC_CLOCK
+                if (i == CLOCK_SRC_TSC && repo.clockSource != CLOCK_SRC_TSC)
+                        continue;
+#else
+                if (i == CLOCK_SRC_TSC)
+                        continue;
+#endif
+                nsgettime(CLOCK_MONOTONIC, &nsstart);
+                for (j = 0; j < CLOCK_PROBE_READS; j++) {
+                        if (i == CLOCK_SRC_REAL)
+                                nsgettime(CLOCK_REALTIME, &nsvar);
+                        else if (i == CLOCK_SRC_MONO)
+                                nsgettime(CLOCK_MONOTONIC, &nsvar);
+#ifdef TSC_CLOCK
+                        else
+                                nsvar = (nstime_t) __rdtsc();
+#endif
+                }
+                nsgettime(CLOCK_MONOTONIC, &nsend);
+                var                   = (int) ((nsend - nsstart) / CLOCK_PROBE_READS);
+                repo.clockReadCost[i] = (var > 0) ? var : 1;
+        }
+        (void) (nsvar);
+
+        if (conf.verbose) {
+                var = sprintf(scratch, "Clock probe (Source[ns/read]):");
+                for (i = 0; i < CLOCK_SRC_COUNT; i++) {
+                        if (repo.clockReadCost[i] > 0)
+                                var += sprintf(&scratch[var], " %s[%d]", clockSrcText[i], repo.clockReadCost[i]);
+                }
+                var += sprintf(&scratch[var], ", Pacing Clock: %s\n", clockSrcText[repo.clockSource]);
+                send_proc(monConn, scratch, var);
+        }
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Initialize transmit method limits for a connected socket
+//
+void init_tx_method(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var, mtu = 0;
+        socklen_t slen = sizeof(mtu);
+
+        c->gsoMaxSegs    = repo.gsoMaxSegs;
+        c->gsoMaxPayload = 0;
+        c->txMethod      = repo.txProbeMethod[TXPROBE_BURSTS - 1]; // Until set for sending rate row
+        if (c->type == T_SHARED) {
+                c->gsoMaxSegs = 0; // Path MTU is unknown on shared test socket, use sendmmsg() instead of GSO
+                return;
+        }
+        if (!repo.gsoAvail)
+                return;
+
+        //
+        // Limit GSO segment size based on path MTU so that segments never require IP fragmentation
+        // (if unknown, any rejection by the kernel during testing will establish the limit)
+        //
+        var = L3DG_OVERHEAD;
+        if (c->ipProtocol == IPPROTO_IPV6)
+                var += IPV6_ADDSIZE;
+        if (getsockopt(c->fd, IPPROTO_IPV6, IPV6_MTU, (void *) &mtu, &slen) < 0) {
+                slen = sizeof(mtu);
+                if (getsockopt(c->fd, IPPROTO_IP, IP_MTU, (void *) &mtu, &slen) < 0)
+                        mtu = 0;
+        }
+        if (mtu > var)
+                c->gsoMaxPayload = mtu - var;
+        else
+                c->gsoMaxPayload = IP_MAXPACKET;
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Open counter of data TLB read misses for this thread (used by capacity calibration), else return -1
+//
+static int _dtlb_open(void) {
+        int fd;
+        struct perf_event_attr pea;
+
+        memset(&pea, 0, sizeof(pea));
+        pea.type       = PERF_TYPE_HW_CACHE;
+        pea.size       = sizeof(pea);
+        pea.config     = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        pea.disabled   = 1;
+        pea.exclude_hv = 1;
+        if ((fd = (int) syscall(SYS_perf_event_open, &pea, 0, -1, -1, 0)) < 0 && (errno == EACCES || errno == EPERM)) {
+                pea.exclude_kernel = 1; // Retry excluding kernel if not permitted
+                fd                 = (int) syscall(SYS_perf_event_open, &pea, 0, -1, -1, 0);
+        }
+        return fd;
+}
+//----------------------------------------------------------------------------
+//
+// Calibrate server capacity at startup via a loopback connection pair
+//
+// Load PDUs are sent at the maximum sending rate and received using the same
+// send_loadpdu() and recv_proc()/service_recvmmsg() paths used for testing. The
+// CPU time of each side yields the datagram and L3 rates achievable per core
+// (the server is single threaded), and the lower of the two (less headroom) is
+// used as the available bandwidth if not explicitly configured.
+//
+void calibrate_capacity(void) {
+        int var, txconn, rxconn, dtlbfd;
+        char *host;
+        uint64_t dtlbmiss;
+        long long txns, rxns, wallms;
+        double rxmbps, txmbps;
+        struct connection *tc, *rc;
+        struct timespec tspecstart, tspecvar, tspeccpu;
+
+        //
+        // Create receiving and transmitting connections and connect them to each other
+        //
+        host = "127.0.0.1";
+        if (conf.addrFamily == AF_INET6)
+                host = "::1";
+        if ((rxconn = new_conn(-1, host, 0, T_UDP, &recv_proc, &null_action)) < 0)
+                return;
+        if ((txconn = new_conn(-1, host, 0, T_UDP, &recv_proc, &null_action)) < 0) {
+                init_conn(rxconn, TRUE);
+                return;
+        }
+        tc  = &conn[txconn];
+        rc  = &conn[rxconn];
+        var = 0;
+        if (sock_mgmt(txconn, host, rc->locPort, NULL, SMA_UPDATE) != 0 || sock_connect(txconn) != 0)
+                var = -1;
+        else if (sock_mgmt(rxconn, host, tc->locPort, NULL, SMA_UPDATE) != 0 || sock_connect(rxconn) != 0)
+                var = -1;
+        if (var != 0) {
+                var = sprintf(scratch, "ERROR: Unable to connect calibration sockets\n");
+                send_proc(errConn, scratch, var);
+                init_conn(txconn, TRUE);
+                init_conn(rxconn, TRUE);
+                return;
+        }
+        tc->srIndex    = repo.maxSendingRates - 1; // Maximum sending rate
+        tc->testAction = TEST_ACT_TEST;
+        rc->testAction = TEST_ACT_TEST;
+        rc->secAction  = &service_recvmmsg;
+        select_hotpath(txconn);
+        select_hotpath(rxconn);
+
+        //
+        // Alternate between sending a burst and reading everything received, timing each side separately (and
+        // counting dTLB misses of the send side, for comparison of I/O buffer backing)
+        //
+        txns = rxns = 0;
+        dtlbfd      = _dtlb_open();
+        clock_gettime(CLOCK_MONOTONIC, &tspecstart);
+        do {
+                clock_update();
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tspeccpu);
+                if (dtlbfd >= 0)
+                        ioctl(dtlbfd, PERF_EVENT_IOC_ENABLE, 0);
+                send_loadpdu(txconn, 1);
+                send_loadpdu(txconn, 2);
+                if (dtlbfd >= 0)
+                        ioctl(dtlbfd, PERF_EVENT_IOC_DISABLE, 0);
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tspecvar);
+                tspecminus(&tspecvar, &tspeccpu, &tspecvar);
+                txns += (long long) tspecvar.tv_sec * NSECINSEC + tspecvar.tv_nsec;
+
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tspeccpu);
+                do {
+                        rc->dataReady = TRUE;
+                        if (recv_proc(rxconn) > 0)
+                                service_recvmmsg(rxconn);
+                } while (rc->dataReady && repo.rcvDataSize > 0);
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tspecvar);
+                tspecminus(&tspecvar, &tspeccpu, &tspecvar);
+                rxns += (long long) tspecvar.tv_sec * NSECINSEC + tspecvar.tv_nsec;
+
+                clock_gettime(CLOCK_MONOTONIC, &tspecvar);
+                tspecminus(&tspecvar, &tspecstart, &tspecvar);
+                wallms = (long long) tspecmsec(&tspecvar);
+        } while (wallms < CALIB_DURATION);
+        repo.calibDtlbMiss = -1.0;
+        if (dtlbfd >= 0) {
+                if (read(dtlbfd, &dtlbmiss, sizeof(dtlbmiss)) == sizeof(dtlbmiss) && tc->lpduSeqNo > 0)
+                        repo.calibDtlbMiss = (double) dtlbmiss / (double) tc->lpduSeqNo;
+                close(dtlbfd);
+        }
+
+        //
+        // Derive per-core rates (L3 bytes include UDP/IP overhead)
+        //
+        var = L3DG_OVERHEAD;
+        if (tc->ipProtocol == IPPROTO_IPV6)
+                var += IPV6_ADDSIZE;
+        if (txns > 0 && rxns > 0 && rc->sisAct.rxDatagrams > 0) {
+                repo.calibTxPps = (double) tc->lpduSeqNo * NSECINSEC / (double) txns;
+                repo.calibRxPps = (double) rc->sisAct.rxDatagrams * NSECINSEC / (double) rxns;
+                rxmbps = (double) (rc->sisAct.rxBytes + (uint64_t) rc->sisAct.rxDatagrams * var);
+                txmbps = (rxmbps / (double) rc->sisAct.rxDatagrams) * repo.calibTxPps * 8 / 1000000;
+                rxmbps = (rxmbps / (double) rc->sisAct.rxDatagrams) * repo.calibRxPps * 8 / 1000000;
+                if (txmbps < rxmbps)
+                        repo.calibMbps = txmbps;
+                else
+                        repo.calibMbps = rxmbps;
+                // One core per preforked server process
+                repo.calibCapacity = (int) (repo.calibMbps * conf.workerCount * CALIB_HEADROOM / 100);
+                if (repo.calibCapacity < 1)
+                        repo.calibCapacity = 1;
+                else if (repo.calibCapacity > MAX_SERVER_BW)
+                        repo.calibCapacity = MAX_SERVER_BW;
+        }
+        init_conn(txconn, TRUE);
+        init_conn(rxconn, TRUE);
+
+        //
+        // Discard statistics accumulated during calibration
+        //
+        memset(&repo.psCounters, 0, sizeof(struct perfStatsCounters));
+        memset(&repo.psMaximums, 0, sizeof(struct perfStatsMaximums));
+        memset(&repo.psAverages, 0, sizeof(struct perfStatsAverages));
 
-                        } else if (var <= 0) {
-                                //
-                                // Message not sent indicates the send buffer is full
-                                //
-                                var = sprintf(scratch, "[%d]SENDMSG OVERRUN: Datagram (%u bytes) not sent\n", connindex, uvar);
-                                send_proc(errConn, scratch, var);
-                        }
-                }
+        //
+        // Apply capacity as available bandwidth unless explicitly configured, else only recommend it
+        //
+        if (repo.calibCapacity == 0) {
+                var = sprintf(scratch, "WARNING: Capacity calibration unsuccessful, no datagrams received\n");
+                send_proc(errConn, scratch, var);
+                return;
+        }
+        if (conf.maxBandwidth == 0) {
+                conf.maxBandwidth = repo.calibCapacity;
+        } else if (conf.maxBandwidth > repo.calibCapacity) {
+                var = sprintf(scratch, "WARNING: Available bandwidth (%d) exceeds calibrated capacity, recommend '-B %d'\n",
+                              conf.maxBandwidth, repo.calibCapacity);
+                send_proc(errConn, scratch, var);
+        }
+        if (conf.verbose) {
+                var = sprintf(scratch,
+                              "Capacity calibration (per core): Tx %.0f pps, Rx %.0f pps, %.2f Mbps, Capacity (%d%%): %d Mbps\n",
+                              repo.calibTxPps, repo.calibRxPps, repo.calibMbps, CALIB_HEADROOM, repo.calibCapacity);
+                send_proc(monConn, scratch, var);
+                if (repo.calibDtlbMiss >= 0.0)
+                        var = sprintf(scratch, "Capacity calibration dTLB misses per Tx datagram: %.3f (I/O buffers: %s)\n",
+                                      repo.calibDtlbMiss, ioBufText[repo.ioBufPages]);
+                else
+                        var = sprintf(scratch, "Capacity calibration dTLB misses unavailable (I/O buffers: %s)\n",
+                                      ioBufText[repo.ioBufPages]);
+                send_proc(monConn, scratch, var);
         }
+        return;
 }
+//----------------------------------------------------------------------------
+//
+// Send a burst via the selected transmit method, specialized by the hot path feature set (hp) of the connection
+//
+// The common feature set (none) is instantiated with a constant so its per-datagram feature checks are removed
+// at compile time, all other combinations share the generic instance.
+//
+HOT_PATH void _send_burst(int connindex, int txm, int totalburst, int burstsize, unsigned int payload, unsigned int addon,
+                          const int hp) {
+        switch (txm) {
+#if defined(HAVE_SENDMMSG)
+#if defined(HAVE_GSO)
+        case TXM_GSO:
+                _sendmmsg_gso(connindex, totalburst, burstsize, payload, addon, hp);
+                break;
+#endif // HAVE_GSO
+        case TXM_SENDMMSG:
+                _sendmmsg_burst(connindex, totalburst, burstsize, payload, addon, hp);
+                break;
 #endif // HAVE_SENDMMSG
+        default:
+                _sendmsg_burst(connindex, totalburst, burstsize, payload, addon, hp);
+        }
+}
+static void _send_burst_std(int connindex, int txm, int totalburst, int burstsize, unsigned int payload,
+                            unsigned int addon) {
+        _send_burst(connindex, txm, totalburst, burstsize, payload, addon, 0);
+}
+static void _send_burst_any(int connindex, int txm, int totalburst, int burstsize, unsigned int payload,
+                            unsigned int addon) {
+        _send_burst(connindex, txm, totalburst, burstsize, payload, addon, conn[connindex].hotPath & HP_TXMASK);
+}
 //----------------------------------------------------------------------------
 //
 // Send load PDUs via periodic timers for transmitters 1 & 2
@@ -626,7 +2085,7 @@ int send_loadpdu(int connindex, int transmitter) {
         int var, burstsize, totalburst, txintpri, txintalt;
         unsigned int payload, addon;
         BOOL randpayload;
-        struct timespec tspecvar, *tspecpri, *tspecalt;
+        nstime_t *nspri, *nsalt;
         struct sendingRate *sr;
         struct perfStatsAverages *psA = &repo.psAverages;
 
@@ -698,7 +2157,7 @@ int send_loadpdu(int connindex, int transmitter) {
                         // The PDU sent in this pass will confirm the test stop back to the server,
                         // schedule an immediate/subsequent test end
                         //
-                        tspeccpy(&c->endTime, &repo.systemClock);
+                        c->endTime = repo.monoClock;
                 }
                 if (repo.endTimeStatus > STATUS_WARNMAX)     // Declare success, but retain warnings
                         repo.endTimeStatus = STATUS_SUCCESS; // ErrorStatus
@@ -710,39 +2169,35 @@ int send_loadpdu(int connindex, int transmitter) {
         if (transmitter == 1) {
                 txintpri = (int) sr->txInterval1;
                 txintalt = (int) sr->txInterval2;
-                tspecpri = &c->timer1Thresh;
-                tspecalt = &c->timer2Thresh;
+                nspri = &c->timer1Thresh;
+                nsalt = &c->timer2Thresh;
         } else {
                 txintpri = (int) sr->txInterval2;
                 txintalt = (int) sr->txInterval1;
-                tspecpri = &c->timer2Thresh;
-                tspecalt = &c->timer1Thresh;
+                nspri = &c->timer2Thresh;
+                nsalt = &c->timer1Thresh;
         }
         //
         // Reset or clear primary timer (this one)
         //
         if (txintpri > 0) {
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = (long) ((txintpri - SEND_TIMER_ADJ) * NSECINUSEC);
-                tspecplus(&repo.systemClock, &tspecvar, tspecpri);
+                *nspri = repo.monoClock + (nstime_t) (txintpri - SEND_TIMER_ADJ) * NSECINUSEC;
         } else {
-                tspecclear(tspecpri);
+                *nspri = 0;
         }
         //
         // Set or clear alternate timer (the other one)
         //
-        if (!tspecisset(tspecalt) && txintalt > 0) {
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = (long) ((txintalt - SEND_TIMER_ADJ) * NSECINUSEC);
-                tspecplus(&repo.systemClock, &tspecvar, tspecalt);
-        } else if (tspecisset(tspecalt) && txintalt == 0) {
-                tspecclear(tspecalt);
+        if (*nsalt == 0 && txintalt > 0) {
+                *nsalt = repo.monoClock + (nstime_t) (txintalt - SEND_TIMER_ADJ) * NSECINUSEC;
+        } else if (*nsalt != 0 && txintalt == 0) {
+                *nsalt = 0;
         }
 
         //
         // Initialize interface stats on first PDU if sysfs FD is valid
         //
-        if (repo.intfFD >= 0 && !tspecisset(&repo.intfTime)) {
+        if (repo.intfFD >= 0 && repo.intfTime == 0) {
                 upd_intf_stats(TRUE);
         }
 
@@ -756,11 +2211,10 @@ int send_loadpdu(int connindex, int transmitter) {
         //
         // If receive traffic stopped, set indicator to inform peer and generate warning (else clear indicator)
         //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                if (tspecvar.tv_sec >= WARNING_NOTRAFFIC) {
+        if (c->pduRxTime != 0) {
+                if (repo.monoClock - c->pduRxTime >= (nstime_t) WARNING_NOTRAFFIC * NSECINSEC) {
                         c->rxStoppedLoc = TRUE;
-                        tspecclear(&c->pduRxTime); // Clear PDU receive time to maintain indicator until traffic resumes
+                        c->pduRxTime    = 0; // Clear PDU receive time to maintain indicator until traffic resumes
                         if (c->warningCount < WARNING_MSG_LIMIT) {
                                 c->warningCount++;
                                 output_warning(connindex, WARN_LOC_STOPPED);
@@ -773,34 +2227,91 @@ int send_loadpdu(int connindex, int transmitter) {
         }
 
         //
-        // Build complete burst of datagrams and message structures
+        // Build complete burst of datagrams and message structures (via transmit method selected for burst)
         //
         totalburst = burstsize;
         if (addon > 0)
                 totalburst++;
-#if defined(HAVE_SENDMMSG)
-#if defined(HAVE_GSO)
-        _sendmmsg_gso(connindex, totalburst, burstsize, payload, addon);
-#else
-        _sendmmsg_burst(connindex, totalburst, burstsize, payload, addon);
-#endif // HAVE_GSO
-#else
-        _sendmsg_burst(connindex, totalburst, burstsize, payload, addon);
-#endif // HAVE_SENDMMSG
+        if (c->txq != NULL && c->txq->dgCount > 0) {
+                flush_txqueue(connindex); // Deferred datagrams are sent first
+        }
+        var = _select_tx_method(c, burstsize, payload, addon);
+        if (c->hotPath & HP_TXMASK)
+                _send_burst_any(connindex, var, totalburst, burstsize, payload, addon);
+        else
+                _send_burst_std(connindex, var, totalburst, burstsize, payload, addon);
 
         return 0;
 }
 //----------------------------------------------------------------------------
 //
+// Add one-way delay variation sample (us) to sketch
+//
+// Values below PDVSK_SUBCOUNT map to individual buckets, larger values to PDVSK_SUBCOUNT linear sub-buckets per
+// power of two (relative error below 1/PDVSK_SUBCOUNT), value must not exceed PDVSK_MAXVAL
+//
+static inline void _pdv_add(struct pdvSketch *sk, unsigned int us) {
+        int exp, idx;
+
+        if (us < PDVSK_SUBCOUNT) {
+                idx = (int) us;
+        } else {
+                exp = 31 - __builtin_clz(us);
+                idx = PDVSK_SUBCOUNT * (exp - PDVSK_SUBBITS + 1) + (int) ((us >> (exp - PDVSK_SUBBITS)) & (PDVSK_SUBCOUNT - 1));
+        }
+        sk->bucket[idx]++;
+        sk->count++;
+}
+//----------------------------------------------------------------------------
+//
+// Merge one-way delay variation sketch into another
+//
+static void _pdv_merge(struct pdvSketch *d, struct pdvSketch *s) {
+        int i;
+
+        if (s->count == 0)
+                return;
+        for (i = 0; i < PDVSK_BUCKETS; i++)
+                d->bucket[i] += s->bucket[i];
+        d->count += s->count;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain percentile (us) of one-way delay variation sketch, as midpoint of bucket containing the ranked sample
+//
+// Sketch must not be empty
+//
+static unsigned int _pdv_quantile(struct pdvSketch *sk, int pct) {
+        int i, exp;
+        unsigned int rank, cum = 0, low, width;
+
+        rank = (unsigned int) (((unsigned long long) sk->count * (unsigned int) pct + 99) / 100);
+        if (rank == 0)
+                rank = 1;
+        for (i = 0; i < PDVSK_BUCKETS - 1; i++) {
+                cum += sk->bucket[i];
+                if (cum >= rank)
+                        break;
+        }
+        if (i < PDVSK_SUBCOUNT)
+                return (unsigned int) i;
+        exp   = (i / PDVSK_SUBCOUNT) + PDVSK_SUBBITS - 1;
+        width = 1U << (exp - PDVSK_SUBBITS);
+        low   = (1U << exp) + (unsigned int) (i % PDVSK_SUBCOUNT) * width;
+        return low + (width / 2);
+}
+//----------------------------------------------------------------------------
+//
 // Service incoming load PDUs
 //
-int service_loadpdu(int connindex) {
+HOT_PATH int _service_loadpdu(int connindex, const int hp) {
         register struct connection *c = &conn[connindex];
         int i, delta, var;
         BOOL bvar, firstpdu = FALSE;
         unsigned int uvar, seqno, rttrd, payload;
+        long long deltaus;
         struct loadHdr *lHdr = (struct loadHdr *) repo.rcvDataPtr;
-        struct timespec tspecvar, tspecdelta;
+        nstime_t nsvar;
         char *nulloutput              = ",,,,,\n";
         struct perfStatsAverages *psA = &repo.psAverages;
 
@@ -820,7 +2331,7 @@ int service_loadpdu(int connindex) {
                         // If client is confirming stop, end test
                         //
                         if (lHdr->testAction != TEST_ACT_TEST) {
-                                tspeccpy(&c->endTime, &repo.systemClock);
+                                c->endTime = repo.monoClock;
                                 return 0;
                         }
                 } else {
@@ -837,15 +2348,13 @@ int service_loadpdu(int connindex) {
                         return 0;
                 }
         } else {
-                tspecvar.tv_sec  = TIMEOUT_NOTRAFFIC;
-                tspecvar.tv_nsec = 0;
-                tspecplus(&repo.systemClock, &tspecvar, &c->endTime);
+                c->endTime = repo.monoClock + (nstime_t) TIMEOUT_NOTRAFFIC * NSECINSEC;
         }
 
         //
         // Save receive time for this PDU
         //
-        tspeccpy(&c->pduRxTime, &repo.systemClock);
+        c->pduRxTime = repo.monoClock;
 
         //
         // Generate warning if peer indicates receive traffic has stopped
@@ -870,7 +2379,7 @@ int service_loadpdu(int connindex) {
         c->sisAct.rxBytes += (uint64_t) payload;
         c->tiRxDatagrams++;
         c->tiRxBytes += payload;
-        if (c->ecnCEThresh > 0) {
+        if (hp & HP_ECN) {
                 //
                 // Process received ECN bits
                 //
@@ -941,19 +2450,19 @@ int service_loadpdu(int connindex) {
                 c->lpduHistIdx &= LPDU_HISTORY_MASK;    // Maintain index limit
         }
         //
-        // Calculate one-way clock delta (used again further down)
+        // Calculate one-way clock delta (used again further down), based on the kernel receive timestamp when available
+        // as datagrams of a receive batch would otherwise all share the time the batch was serviced
         //
-        tspecvar.tv_sec  = (time_t) ntohl(lHdr->lpduTime_sec);
-        tspecvar.tv_nsec = (long) ntohl(lHdr->lpduTime_nsec);
-        tspecminus(&repo.systemClock, &tspecvar, &tspecdelta);
-        delta = (int) tspecmsec(&tspecdelta);
-        if (c->outputFPtr != NULL) { // Start output data with one-way values (store in scratch2 for below)
+        nsvar = (nstime_t) ntohl(lHdr->lpduTime_sec) * NSECINSEC + ntohl(lHdr->lpduTime_nsec);
+        delta   = (int) nsmsec(repo.rcvTime - nsvar);
+        deltaus = (long long) nsusec(repo.rcvTime - nsvar);
+        if (hp & HP_EXPORT) { // Start output data with one-way values (store in scratch2 for below)
                 sprintf(scratch2, "%u,%u,%d,%ld.%06ld,%ld.%06ld,%d,%.2f,%.2f", seqno, payload, repo.rcvEcnBits,
-                        (long) tspecvar.tv_sec, tspecvar.tv_nsec / NSECINUSEC, (long) repo.systemClock.tv_sec,
-                        repo.systemClock.tv_nsec / NSECINUSEC, delta, repo.intfMbps, repo.intfMbpsAlt);
+                        (long) nssec(nsvar), nsnsec(nsvar) / NSECINUSEC, (long) nssec(repo.rcvTime),
+                        nsnsec(repo.rcvTime) / NSECINUSEC, delta, repo.intfMbps, repo.intfMbpsAlt);
         }
         if (var > 0) {
-                if (c->outputFPtr != NULL && conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
+                if ((hp & HP_EXPORT) && conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
                         fprintf(c->outputFPtr, "%s%s", scratch2, nulloutput);
                 }
                 return 0; // No further processing for non-increasing sequence numbers
@@ -963,11 +2472,9 @@ int service_loadpdu(int connindex) {
         // If an updated value is detected (because another status PDU was sent),
         // calculate round-trip time from the last status PDU sent until this load PDU
         //
-        tspecvar.tv_sec  = (time_t) ntohl(lHdr->spduTime_sec);
-        tspecvar.tv_nsec = (long) ntohl(lHdr->spduTime_nsec);
-        if (tspecvar.tv_nsec != c->spduTime.tv_nsec || tspecvar.tv_sec != c->spduTime.tv_sec) {
-                tspecminus(&repo.systemClock, &tspecvar, &tspecdelta);
-                uvar = (unsigned int) tspecmsec(&tspecdelta);
+        nsvar = (nstime_t) ntohl(lHdr->spduTime_sec) * NSECINSEC + ntohl(lHdr->spduTime_nsec);
+        if (nsvar != c->spduTime) {
+                uvar = (unsigned int) nsmsec(repo.systemClock - nsvar);
                 //
                 // Adjust RTT based on delay between when status PDU was received and load PDU sent
                 //
@@ -988,10 +2495,10 @@ int service_loadpdu(int connindex) {
                         if (c->testAction == TEST_ACT_TEST)
                                 psA->remStatusLoss += (unsigned int) c->spduSeqErr;
                 }
-                if (c->outputFPtr != NULL) { // Finalize output data with RTT values (use scratch2 from above)
-                        fprintf(c->outputFPtr, "%s,%ld.%06ld,%ld.%06ld,%u,%u,%d\n", scratch2, (long) tspecvar.tv_sec,
-                                tspecvar.tv_nsec / NSECINUSEC, (long) repo.systemClock.tv_sec,
-                                repo.systemClock.tv_nsec / NSECINUSEC, rttrd, uvar, c->spduSeqErr);
+                if (hp & HP_EXPORT) { // Finalize output data with RTT values (use scratch2 from above)
+                        fprintf(c->outputFPtr, "%s,%ld.%06ld,%ld.%06ld,%u,%u,%d\n", scratch2, (long) nssec(nsvar),
+                                nsnsec(nsvar) / NSECINUSEC, (long) nssec(repo.systemClock),
+                                nsnsec(repo.systemClock) / NSECINUSEC, rttrd, uvar, c->spduSeqErr);
                 }
                 //
                 // Check for new minimum
@@ -1010,9 +2517,9 @@ int service_loadpdu(int connindex) {
                         c->sisAct.rttVarMaximum = (uint32_t) c->rttVarSample;
                 c->rttVarSum += c->rttVarSample; // Update local RTT variation sum and count
                 c->rttVarCnt++;
-                tspeccpy(&c->spduTime, &tspecvar); // Save to detect updated value
+                c->spduTime = nsvar; // Save to detect updated value
         } else {
-                if (c->outputFPtr != NULL && conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
+                if ((hp & HP_EXPORT) && conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
                         fprintf(c->outputFPtr, "%s%s", scratch2, nulloutput);
                 }
         }
@@ -1021,8 +2528,9 @@ int service_loadpdu(int connindex) {
         // Process one-way clock delta (calculated above) and delay variation for this load PDU
         //
         if (firstpdu) {
-                c->clockDeltaMin = delta;
-                c->delayMinUpd   = TRUE;
+                c->clockDeltaMin   = delta;
+                c->clockDeltaMinUs = deltaus;
+                c->delayMinUpd     = TRUE;
         } else {
                 //
                 // Check for new minimum
@@ -1031,6 +2539,17 @@ int service_loadpdu(int connindex) {
                         c->clockDeltaMin = delta;
                         c->delayMinUpd   = TRUE;
                 }
+                if (deltaus < c->clockDeltaMinUs)
+                        c->clockDeltaMinUs = deltaus;
+                //
+                // Update microsecond delay variation sketches (sub-interval percentiles and percentile-based rate adjustment)
+                //
+                deltaus -= c->clockDeltaMinUs;
+                if (deltaus > PDVSK_MAXVAL)
+                        deltaus = PDVSK_MAXVAL;
+                _pdv_add(&c->sisActPdv, (unsigned int) deltaus);
+                if (c->pdvPercentile > 0)
+                        _pdv_add(&c->tiPdv, (unsigned int) deltaus);
                 uvar = (unsigned int) (delta - c->clockDeltaMin);
                 //
                 // Update one-way delay variation stats for trial interval
@@ -1053,6 +2572,56 @@ int service_loadpdu(int connindex) {
         }
         return 0;
 }
+//
+// Specialized receive variants (see select_hotpath)
+//
+static int _service_loadpdu_std(int connindex) {
+        return _service_loadpdu(connindex, 0);
+}
+static int _service_loadpdu_ecn(int connindex) {
+        return _service_loadpdu(connindex, HP_ECN);
+}
+static int _service_loadpdu_any(int connindex) {
+        return _service_loadpdu(connindex, conn[connindex].hotPath & HP_RXMASK);
+}
+int service_loadpdu(int connindex) {
+        return conn[connindex].loadAction(connindex);
+}
+//----------------------------------------------------------------------------
+//
+// Select hot path feature set of connection and the corresponding specialized load PDU receive variant
+//
+// Must be called again whenever a feature is enabled or disabled after connection setup.
+//
+void select_hotpath(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int hp = 0;
+
+        if (c->ecnCEThresh > 0)
+                hp |= HP_ECN;
+        if (c->outputFPtr != NULL)
+                hp |= HP_EXPORT;
+        if (c->randPayload)
+                hp |= HP_RANDPAY;
+        if (conf.psFile != NULL)
+                hp |= HP_PSTATS;
+        if (conf.seqNumAdjust)
+                hp |= HP_SEQADJ;
+        if (c->type == T_SHARED)
+                hp |= HP_SHARED;
+        c->hotPath = hp;
+        switch (hp & HP_RXMASK) {
+        case 0:
+                c->loadAction = &_service_loadpdu_std;
+                break;
+        case HP_ECN:
+                c->loadAction = &_service_loadpdu_ecn;
+                break;
+        default:
+                c->loadAction = &_service_loadpdu_any;
+        }
+        return;
+}
 //----------------------------------------------------------------------------
 //
 // Send status PDUs via periodic timer
@@ -1060,7 +2629,7 @@ int service_loadpdu(int connindex) {
 int send_statuspdu(int connindex) {
         register struct connection *c = &conn[connindex];
         int var;
-        struct timespec tspecvar;
+        double dvar;
         struct sendingRate *sr;
         struct statusHdr *sHdr        = (struct statusHdr *) repo.defBuffer;
         struct perfStatsAverages *psA = &repo.psAverages;
@@ -1070,7 +2639,7 @@ int send_statuspdu(int connindex) {
         // Check for test stop in progress, else reset status send timer
         //
         if (c->testAction != TEST_ACT_TEST) {
-                tspecclear(&c->timer1Thresh); // Stop subsequent status messages
+                c->timer1Thresh = 0; // Stop subsequent status messages
                 if (repo.isServer) {
                         if (conf.verbose && c->testAction == TEST_ACT_STOP1) {
                                 var = sprintf(scratch, "[%d]Sending test stop\n", connindex);
@@ -1082,14 +2651,12 @@ int send_statuspdu(int connindex) {
                         // The PDU sent in this pass will confirm the test stop back to the server,
                         // schedule an immediate/subsequent test end
                         //
-                        tspeccpy(&c->endTime, &repo.systemClock);
+                        c->endTime = repo.monoClock;
                 }
                 if (repo.endTimeStatus > STATUS_WARNMAX)     // Declare success, but retain warnings
                         repo.endTimeStatus = STATUS_SUCCESS; // ErrorStatus
         } else {
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = (long) (c->trialInt * NSECINMSEC);
-                tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+                c->timer1Thresh = repo.monoClock + (c->trialInt * NSECINMSEC);
 
                 //
                 // Only continue if some data has been received (initial load PDUs could still be in transit)
@@ -1104,6 +2671,13 @@ int send_statuspdu(int connindex) {
                         return 0;
                 }
 
+                //
+                // Obtain one-way delay variation percentile of trial interval (if used for rate adjustment)
+                //
+                c->tiDelayVarPct = STATUS_NODEL;
+                if (c->pdvPercentile > 0 && c->tiPdv.count > 0)
+                        c->tiDelayVarPct = _pdv_quantile(&c->tiPdv, c->pdvPercentile);
+
                 //
                 // If server, adjust sending rate based on our receive traffic conditions
                 //
@@ -1115,11 +2689,10 @@ int send_statuspdu(int connindex) {
         //
         // If receive traffic stopped, set indicator to inform peer and generate warning (else clear indicator)
         //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                if (tspecvar.tv_sec >= WARNING_NOTRAFFIC) {
+        if (c->pduRxTime != 0) {
+                if (repo.monoClock - c->pduRxTime >= (nstime_t) WARNING_NOTRAFFIC * NSECINSEC) {
                         c->rxStoppedLoc = TRUE;
-                        tspecclear(&c->pduRxTime); // Clear PDU receive time to maintain indicator until traffic resumes
+                        c->pduRxTime    = 0; // Clear PDU receive time to maintain indicator until traffic resumes
                         if (c->warningCount < WARNING_MSG_LIMIT) {
                                 c->warningCount++;
                                 output_warning(connindex, WARN_LOC_STOPPED);
@@ -1134,7 +2707,7 @@ int send_statuspdu(int connindex) {
         //
         // Initialize interface stats on first PDU if sysfs FD is valid
         //
-        if (repo.intfFD >= 0 && !tspecisset(&repo.intfTime)) {
+        if (repo.intfFD >= 0 && repo.intfTime == 0) {
                 upd_intf_stats(TRUE);
         }
 
@@ -1186,8 +2759,7 @@ int send_statuspdu(int connindex) {
         //
         // Include trial interval info
         //
-        tspecminus(&repo.systemClock, &c->trialIntClock, &tspecvar);
-        c->tiDeltaTime      = (unsigned int) tspecusec(&tspecvar);
+        c->tiDeltaTime      = (unsigned int) nsusec(repo.monoClock - c->trialIntClock);
         sHdr->tiDeltaTime   = htonl((uint32_t) c->tiDeltaTime);
         sHdr->tiRxDatagrams = htonl((uint32_t) c->tiRxDatagrams);
         sHdr->tiRxBytes     = htonl((uint32_t) c->tiRxBytes);
@@ -1195,8 +2767,8 @@ int send_statuspdu(int connindex) {
         //
         // Include time reference for this status PDU
         //
-        sHdr->spduTime_sec  = htonl((uint32_t) repo.systemClock.tv_sec);
-        sHdr->spduTime_nsec = htonl((uint32_t) repo.systemClock.tv_nsec);
+        sHdr->spduTime_sec  = htonl((uint32_t) nssec(repo.systemClock));
+        sHdr->spduTime_nsec = htonl((uint32_t) nsnsec(repo.systemClock));
 
         //
         // Authentication (not supported for status PDUs) and ECN CE fields
@@ -1204,7 +2776,13 @@ int send_statuspdu(int connindex) {
         //
         if (c->protocolVer >= AUTH_ECN_PVER) {
                 memset(sAR, 0, sizeof(struct statusAuthReuse));
-                sAR->authMode = (uint8_t) c->authMode;
+                sAR->authMode      = (uint8_t) c->authMode;
+                sAR->tiRxDropCnt   = htonl((uint32_t) c->tiRxDropCnt);
+                sAR->sisSavDropCnt = htonl((uint32_t) c->sisSavDropCnt);
+                if (c->tiDelayVarPct != STATUS_NODEL) {
+                        sAR->tiDelayVarPct   = htonl((uint32_t) c->tiDelayVarPct);
+                        sAR->modifierBitmap |= STATUS_PDV_PCT; // Set delay variation percentile included
+                }
                 //
                 // Include ECN CE count and generate warning if bleaching detected
                 //
@@ -1260,6 +2838,26 @@ int send_statuspdu(int connindex) {
                 //
                 psA->rxSeqErrLoss += c->seqErrLoss;
                 psA->rxSeqErrOooDup += c->seqErrOoo + c->seqErrDup;
+                psA->rxLocalDrops += c->tiRxDropCnt;
+        }
+
+        //
+        // Accumulate L3 bytes delivered (received) for utilization-driven admission
+        //
+        if (conf.utilTarget > 0) {
+                repo.utilBytes[1] += (unsigned long long) c->tiRxBytes;
+                repo.utilBytes[1] += (unsigned long long) (c->tiRxDatagrams * L3DG_OVERHEAD);
+                if (c->ipProtocol == IPPROTO_IPV6) {
+                        repo.utilBytes[1] += (unsigned long long) (c->tiRxDatagrams * IPV6_ADDSIZE);
+                }
+        }
+
+        //
+        // If client, resize receive buffer from measured receive rate (server sizes from its sending rate)
+        //
+        if (!repo.isServer && c->trialInt > 0) {
+                dvar = (double) c->tiRxBytes + ((double) c->tiRxDatagrams * L3DG_OVERHEAD);
+                tune_sockbuf(connindex, NULL, (dvar * MSECINSEC) / (double) c->trialInt);
         }
 
         //
@@ -1276,11 +2874,15 @@ int send_statuspdu(int connindex) {
         // Do not clear global RTT minimum
         c->rttVarSample = STATUS_NODEL;
         c->delayMinUpd  = FALSE;
-        tspeccpy(&c->trialIntClock, &repo.systemClock);
+        c->trialIntClock = repo.monoClock;
         c->tiDeltaTime   = 0;
         c->tiRxDatagrams = 0;
         c->tiRxBytes     = 0;
         c->tiRxCECount   = 0;
+        c->tiRxDropCnt   = 0;
+        c->tiDelayVarPct = STATUS_NODEL;
+        if (c->tiPdv.count > 0)
+                memset(&c->tiPdv, 0, sizeof(struct pdvSketch));
 
         //
         // Send status message
@@ -1300,7 +2902,7 @@ int send_statuspdu(int connindex) {
         // Initialize or process sub-interval statistics. Because it is checked with each
         // status message, the sub-interval time has the granularity of the trial interval.
         //
-        if (!tspecisset(&c->subIntClock)) { // If clock never set
+        if (c->subIntClock == 0) { // If clock never set
                 //
                 // Initialize stats and sub-interval clock on first status message
                 //
@@ -1309,16 +2911,8 @@ int send_statuspdu(int connindex) {
                 //
                 // Check sub-interval clock for expiration
                 //
-                tspecminus(&repo.systemClock, &c->subIntClock, &tspecvar);
                 var = c->subIntPeriod - (c->trialInt / 2);
-                if ((int) tspecmsec(&tspecvar) > var) {
-                        if (!repo.isServer && (c->subIntCount > conn[aggConn].subIntCount)) {
-                                //
-                                // Process aggregate connection if this one has started the next sub-interval. This can
-                                // happen when active connections fail during a test.
-                                //
-                                output_currate(aggConn);
-                        }
+                if ((int) nsmsec(repo.monoClock - c->subIntClock) > var) {
                         proc_subinterval(connindex, FALSE);
                 }
         }
@@ -1333,7 +2927,6 @@ int service_statuspdu(int connindex) {
         int var;
         BOOL bvar;
         unsigned int uvar, seqno;
-        struct timespec tspecvar;
         struct statusHdr *sHdr        = (struct statusHdr *) repo.defBuffer;
         struct perfStatsAverages *psA = &repo.psAverages;
         struct statusAuthReuse *sAR   = (struct statusAuthReuse *) &sHdr->reserved3;
@@ -1365,7 +2958,7 @@ int service_statuspdu(int connindex) {
                         // If client is confirming stop, end test
                         //
                         if (sHdr->testAction != TEST_ACT_TEST) {
-                                tspeccpy(&c->endTime, &repo.systemClock);
+                                c->endTime = repo.monoClock;
                                 // Delay return until after statistics are updated below
                                 // return 0;
                         }
@@ -1384,15 +2977,13 @@ int service_statuspdu(int connindex) {
                         // return 0;
                 }
         } else {
-                tspecvar.tv_sec  = TIMEOUT_NOTRAFFIC;
-                tspecvar.tv_nsec = 0;
-                tspecplus(&repo.systemClock, &tspecvar, &c->endTime);
+                c->endTime = repo.monoClock + (nstime_t) TIMEOUT_NOTRAFFIC * NSECINSEC;
         }
 
         //
         // Save receive time for this PDU
         //
-        tspeccpy(&c->pduRxTime, &repo.systemClock);
+        c->pduRxTime = repo.monoClock;
 
         //
         // Generate warning if peer indicates receive traffic has stopped
@@ -1465,14 +3056,18 @@ int service_statuspdu(int connindex) {
         //
         // Save time reference for this status PDU
         //
-        c->spduTime.tv_sec  = (time_t) ntohl(sHdr->spduTime_sec);
-        c->spduTime.tv_nsec = (long) ntohl(sHdr->spduTime_nsec);
+        c->spduTime = (nstime_t) ntohl(sHdr->spduTime_sec) * NSECINSEC + ntohl(sHdr->spduTime_nsec);
 
         //
         // Authentication (not supported for status PDUs) and ECN CE fields
         // Uses struct statusAuthReuse...
         //
         if (c->protocolVer >= AUTH_ECN_PVER) {
+                c->tiRxDropCnt = (unsigned int) ntohl(sAR->tiRxDropCnt); // Local drops of peer receiver
+                if (sAR->modifierBitmap & STATUS_PDV_PCT)
+                        c->tiDelayVarPct = (unsigned int) ntohl(sAR->tiDelayVarPct);
+                else
+                        c->tiDelayVarPct = STATUS_NODEL;
                 //
                 // Save ECN CE count and generate warning if bleaching detected
                 //
@@ -1509,6 +3104,17 @@ int service_statuspdu(int connindex) {
                 psA->txSeqErrOooDup += c->seqErrOoo + c->seqErrDup;
         }
 
+        //
+        // Accumulate L3 bytes delivered (transmitted) for utilization-driven admission
+        //
+        if (conf.utilTarget > 0) {
+                repo.utilBytes[0] += (unsigned long long) c->tiRxBytes;
+                repo.utilBytes[0] += (unsigned long long) (c->tiRxDatagrams * L3DG_OVERHEAD);
+                if (c->ipProtocol == IPPROTO_IPV6) {
+                        repo.utilBytes[0] += (unsigned long long) (c->tiRxDatagrams * IPV6_ADDSIZE);
+                }
+        }
+
         //
         // All stats updated, process delayed return from above
         //
@@ -1523,6 +3129,8 @@ int service_statuspdu(int connindex) {
                 // Copy sending rate parameters specified by server in this status message
                 //
                 sr_copy(&c->srStruct, &sHdr->srStruct, FALSE);
+                tune_sockbuf(connindex, &c->srStruct, 0.0); // Resize send buffer for new sending rate
+                set_tx_method(connindex, &c->srStruct);
 
                 //
                 // Output verbose/debug messages if configured
@@ -1547,19 +3155,13 @@ int service_statuspdu(int connindex) {
                 if (c->protocolVer >= AUTH_ECN_PVER) {
                         if (c->ecnCEThresh > 0)
                                 c->sisSavCECount = (unsigned int) ntohl(sAR->sisSavCECount);
+                        c->sisSavDropCnt = (unsigned int) ntohl(sAR->sisSavDropCnt);
                 }
                 //
                 // Process and output the latest rate info indicated by receiver
                 //
                 if (c->testAction == TEST_ACT_TEST) {
                         if (!repo.isServer || conf.verbose) {
-                                if (!repo.isServer && (c->subIntCount > conn[aggConn].subIntCount)) {
-                                        //
-                                        // Process aggregate connection if this one has started the next sub-interval. This can
-                                        // happen when active connections fail during a test.
-                                        //
-                                        output_currate(aggConn);
-                                }
                                 output_currate(connindex);
                         }
                 }
@@ -1581,24 +3183,39 @@ int service_statuspdu(int connindex) {
 int adjust_sending_rate(int connindex) {
         register struct connection *c = &conn[connindex];
         unsigned int uvar, dvmin, dvavg;
-        int var, delay, seqerr;
+        int var, delay, seqerr, lowthresh, upperthresh;
         BOOL cethresh = FALSE;
-        char celabel[8], cedata[16];
+        char celabel[16], cedata[32], intfdata[64];
 
         //
         // Select algorithm parameters
         //
         seqerr = (int) c->seqErrLoss;
+        if (conf.excludeLocDrop) { // Exclude loss caused by receiver socket overflow (not the network)
+                if (c->tiRxDropCnt < c->seqErrLoss)
+                        seqerr -= (int) c->tiRxDropCnt;
+                else
+                        seqerr = 0;
+        }
         if (!c->ignoreOooDup) {
                 seqerr += (int) (c->seqErrOoo + c->seqErrDup);
         }
-        delay = c->lowThresh; // Default to 'no change' if data not available
+        lowthresh   = c->lowThresh;
+        upperthresh = c->upperThresh;
+        delay       = lowthresh; // Default to 'no change' if data not available
         dvmin = dvavg = 0;
         if (c->delayVarCnt > 0) {
                 dvmin = c->delayVarMin;
                 dvavg = (((c->delayVarSum * 10) / c->delayVarCnt) + 5) / 10;
         }
-        if (c->useOwDelVar) {
+        if (c->useOwDelVar && c->pdvPercentile > 0) {
+                // Use configured percentile of one-way delay variation (with thresholds scaled to usec)
+                if (c->tiDelayVarPct != STATUS_NODEL) {
+                        lowthresh   = c->lowThresh * USECINMSEC;
+                        upperthresh = c->upperThresh * USECINMSEC;
+                        delay       = (int) c->tiDelayVarPct;
+                }
+        } else if (c->useOwDelVar) {
                 // Use average one-way delay variation
                 if (c->delayVarCnt > 0) {
                         delay = (int) dvavg;
@@ -1633,7 +3250,7 @@ int adjust_sending_rate(int connindex) {
                 // This section of code corresponds to the flowchart in TR-471 section 5.2.1,
                 // Sending Rate Search Algorithm, and ITU-T Recommendation Y.1540, Annex B
                 //
-                if (seqerr <= c->seqErrThresh && delay < c->lowThresh && !cethresh) {
+                if (seqerr <= c->seqErrThresh && delay < lowthresh && !cethresh) {
                         if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount < c->slowAdjThresh) {
                                 if (c->srIndex + c->highSpeedDelta > repo.hSpeedThresh)
                                         c->srIndex = repo.hSpeedThresh;
@@ -1644,7 +3261,7 @@ int adjust_sending_rate(int connindex) {
                                 if (c->srIndex < repo.maxSendingRates - 1)
                                         c->srIndex++;
                         }
-                } else if (seqerr > c->seqErrThresh || delay > c->upperThresh || cethresh) {
+                } else if (seqerr > c->seqErrThresh || delay > upperthresh || cethresh) {
                         c->slowAdjCount++;
                         if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount == c->slowAdjThresh) {
                                 if (c->srIndex > c->highSpeedDelta * HS_DELTA_BACKUP)
@@ -1664,7 +3281,7 @@ int adjust_sending_rate(int connindex) {
                 // This section of code provides an optional algorithm, with the properties of faster search to the
                 // max region, meaning less time when errors might end a fast search, and retry fast if that happens.
                 //
-                if (seqerr <= c->seqErrThresh && delay < c->lowThresh && !cethresh) {
+                if (seqerr <= c->seqErrThresh && delay < lowthresh && !cethresh) {
                         if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount < c->slowAdjThresh) { // Congestion not detected
                                 if (c->srIndex * 2 > repo.hSpeedThresh) { // If no room to jump within high-speed threshold
                                         c->srIndex = repo.hSpeedThresh;   // Truncate jump at high-speed threshold
@@ -1692,7 +3309,7 @@ int adjust_sending_rate(int connindex) {
                                             RETRY_THRESH_ALGOC; // Use higher wait threshold for the next fast ramp-up
                                 }
                         }
-                } else if (seqerr > c->seqErrThresh || delay > c->upperThresh || cethresh) {
+                } else if (seqerr > c->seqErrThresh || delay > upperthresh || cethresh) {
                         c->slowAdjCount++;
                         if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount == c->slowAdjThresh) { // Congestion detected
                                 if (c->srIndex > c->highSpeedDelta * HS_DELTA_BACKUP) {              // If room to jump backward
@@ -1752,6 +3369,8 @@ int adjust_sending_rate(int connindex) {
                 }
         }
 #endif // RATE_LIMITING
+        tune_sockbuf(connindex, &repo.sendingRates[c->srIndex], 0.0); // Resize socket buffer for new sending rate
+        set_tx_method(connindex, &repo.sendingRates[c->srIndex]);
 
         //
         // Output debug messages if configured
@@ -1765,8 +3384,13 @@ int adjust_sending_rate(int connindex) {
                         strcpy(celabel, CE_LABEL_TEXT);
                         sprintf(cedata, "/%u", c->tiRxCECount);
                 }
+                if (c->tiRxDropCnt > 0) { // Append local receive drops when present
+                        strcat(celabel, LOCDROP_TEXT);
+                        sprintf(&cedata[strlen(cedata)], "/%u", c->tiRxDropCnt);
+                }
+                _intf_debug(intfdata);
                 var = sprintf(scratch, SERVER_DEBUG, connindex, celabel, c->seqErrLoss, c->seqErrOoo, c->seqErrDup, cedata, dvmin,
-                              dvavg, c->delayVarMax, var, c->srIndex);
+                              dvavg, c->delayVarMax, var, c->srIndex, intfdata);
                 send_proc(monConn, scratch, var);
         }
         return 0;
@@ -1777,7 +3401,7 @@ int adjust_sending_rate(int connindex) {
 //
 int proc_subinterval(int connindex, BOOL initialize) {
         register struct connection *c = &conn[connindex];
-        struct timespec tspecvar;
+        nstime_t nsvar;
 
         //
         // If not doing initialization
@@ -1787,12 +3411,14 @@ int proc_subinterval(int connindex, BOOL initialize) {
                 // Finalize active statistics for this sub-interval and save them
                 //
                 c->subIntSeqNo++; // Indicate updated stats
-                tspecminus(&repo.systemClock, &c->subIntClock, &tspecvar);
-                c->sisAct.deltaTime = (uint32_t) tspecusec(&tspecvar); // Measured sub-interval time
-                c->accumTime += (unsigned int) tspecmsec(&tspecvar);
+                nsvar               = repo.monoClock - c->subIntClock;
+                c->sisAct.deltaTime = (uint32_t) nsusec(nsvar); // Measured sub-interval time
+                c->accumTime += (unsigned int) nsmsec(nsvar);
                 c->sisAct.accumTime = (uint32_t) c->accumTime;
                 memcpy(&c->sisSav, &c->sisAct, sizeof(struct subIntStats));
                 c->sisSavCECount = c->sisActCECount;
+                c->sisSavDropCnt = c->sisActDropCnt;
+                memcpy(&c->sisSavPdv, &c->sisActPdv, sizeof(struct pdvSketch));
 
                 //
                 // Process and output our latest rate info as receiver
@@ -1810,10 +3436,12 @@ int proc_subinterval(int connindex, BOOL initialize) {
         memset(&c->sisAct, 0, sizeof(struct subIntStats));
         c->sisAct.delayVarMin   = STATUS_NODEL;
         c->sisAct.rttVarMinimum = STATUS_NODEL;
-        tspeccpy(&c->subIntClock, &repo.systemClock);
+        c->subIntClock = repo.monoClock;
         if (initialize)
                 c->accumTime = 0;
         c->sisActCECount = 0;
+        c->sisActDropCnt = 0;
+        memset(&c->sisActPdv, 0, sizeof(struct pdvSketch));
 
         return 0;
 }
@@ -1824,48 +3452,57 @@ int proc_subinterval(int connindex, BOOL initialize) {
 int agg_query_proc(int connindex) {
         register struct connection *a = &conn[connindex];
         int var;
-        struct timespec tspecvar;
 
         //
-        // Query aggregate connection and overall state of testing
+        // Update active test count of this worker process for parent, else include test counts of worker processes
+        //
+        var = repo.actConnCount;
+        if (repo.workerIndex > 0)
+                worker_status(FALSE);
+        else
+                var += worker_actconn();
+
+        //
+        // Query aggregate connection and overall state of testing (minimum only checked by parent of worker processes)
         //
-        if (repo.actConnCount < conf.minConnCount) { // Active test count is below minimum
+        if (repo.workerIndex == 0 && var < conf.minConnCount) { // Active test count is below minimum
                 var = sprintf(scratch, "ERROR: Minimum required connections (%d) unavailable\n", conf.minConnCount);
                 send_proc(errConn, scratch, var);
                 if (repo.endTimeStatus <= STATUS_WARNMAX)                          // Retain any original error
                         repo.endTimeStatus = STATUS_CONN_ERRBASE + ERROR_CONN_MIN; // ErrorStatus
-                tspeccpy(&a->endTime, &repo.systemClock);                          // Trigger process shutdown
+                a->endTime = repo.monoClock;                          // Trigger process shutdown
 
-        } else if (repo.maxConnIndex == aggConn) { // All test connections finished/failed (only aggregate exists)
+        } else if (repo.maxConnIndex == aggConn && worker_wait(INT_MAX) == 0) {
                 //
-                // Process aggregate connection for the final sub-interval if some connections haven't been
+                // All test connections finished/failed (only aggregate exists) and all worker processes finished.
+                // Process aggregate connection for any final sub-intervals if some connections haven't been
                 // accounted for. This can happen when active connections fail during the last sub-interval.
                 //
-                if (repo.sisConnCount > 0) {
+                while (_agg_pending()) {
                         output_currate(connindex);
                 }
+                worker_status(TRUE); // Report (worker) or retain (parent) final status of worker processes
                 //
                 // Output maximums and end testing
                 //
-                if (repo.testSum[0].sampleCount > 0) {
+                if (repo.workerIndex == 0 && repo.testSum[0].sampleCount > 0) {
                         output_maxrate(connindex);
                 }
-                tspeccpy(&a->endTime, &repo.systemClock); // Trigger process shutdown
+                a->endTime = repo.monoClock; // Trigger process shutdown
         } else {
                 //
-                // Reset aggregate query timer
+                // Reset aggregate query timer (polling more often for sub-interval stats published by worker processes)
                 //
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = AGG_QUERY_TIME * NSECINMSEC;
-                tspecplus(&repo.systemClock, &tspecvar, &a->timer1Thresh);
+                a->timer1Thresh = repo.monoClock + AGG_QUERY_TIME * NSECINMSEC;
+                if (conf.workerCount > 1 && repo.workerIndex == 0)
+                        a->timer1Thresh = repo.monoClock + AGG_WORKER_TIME * NSECINMSEC;
 
                 //
-                // Process aggregate sub-interval stats if all active connections have done so individually. This is the
-                // normal method by which the aggregate is processed (when no connections have failed).
+                // Process aggregate sub-interval stats if all remaining active connections (and worker processes) have
+                // done so individually. Normally the aggregate is already processed when the last connection completes
+                // its sub-interval, so this only applies when connections have failed (or to worker processes).
                 //
-                if (repo.sisConnCount == repo.actConnCount) {
-                        output_currate(connindex);
-                }
+                _agg_check();
         }
         return 0;
 }
@@ -1874,12 +3511,13 @@ int agg_query_proc(int connindex) {
 // Output sampled data rate and summary statistics
 //
 int output_currate(int connindex) {
-        register struct connection *c = &conn[connindex], *a;
+        register struct connection *c = &conn[connindex];
         int i, var;
         unsigned int dvmin, dvavg, rttmin, rttavg;
         double dvar, mbps, sent, delivered = 0.0, intfmbps = 0.0;
-        char connid[8], intfrate[16], celabel[8], cedata[16];
+        char connid[8], intfrate[16], celabel[16], cedata[32];
         struct testSummary *ts;
+        struct aggSnap snap, *s;
 
         //
         // Do not allow sub-interval count to exceed expected maximum
@@ -1887,6 +3525,13 @@ int output_currate(int connindex) {
         if (connindex != aggConn) {
                 if (c->subIntCount >= (c->testIntTime * MSECINSEC) / c->subIntPeriod)
                         return 0;
+        } else {
+                worker_merge(connindex);     // Merge sub-interval stats published by worker processes
+                intfmbps = _agg_load(c);     // Load aggregation slot (and interface rate) of this sub-interval
+                if (repo.workerIndex > 0) {
+                        worker_publish(connindex); // Aggregate of worker process is output by parent
+                        return 0;
+                }
         }
 
         //
@@ -1897,24 +3542,28 @@ int output_currate(int connindex) {
                 mbps = get_rate(connindex, &c->sisSav, L3DG_OVERHEAD);
                 if (!repo.isServer) {
                         //
-                        // Accumulate all rate types into aggregates
+                        // Merge stats and all rate types into aggregation slot of this sub-interval, obtaining interface
+                        // rate at first connection of the sub-interval (for subsequent use by aggregate connection)
                         //
-                        repo.siAggRateL3 += mbps;
-                        repo.siAggRateL2 += get_rate(connindex, &c->sisSav, L2DG_OVERHEAD);
-                        repo.siAggRateL1 += get_rate(connindex, &c->sisSav, L1DG_OVERHEAD);
-                        repo.siAggRateL0 += get_rate(connindex, &c->sisSav, L0DG_OVERHEAD);
-                }
-                //
-                // Obtain interface rate at first non-aggregate sub-interval
-                //
-                if (repo.intfFD >= 0 && repo.sisConnCount == 0) {
-                        upd_intf_stats(FALSE); // Save for subsequent use by aggregate connection
+                        s = _agg_slot(c->subIntCount);
+                        if (repo.intfFD >= 0 && s->connCount == 0) {
+                                upd_intf_stats(FALSE);
+                                s->intfMbps = repo.intfMbps;
+                        }
+                        _snap_subint(&snap, c);
+                        snap.rateL3 = mbps;
+                        snap.rateL2 = get_rate(connindex, &c->sisSav, L2DG_OVERHEAD);
+                        snap.rateL1 = get_rate(connindex, &c->sisSav, L1DG_OVERHEAD);
+                        snap.rateL0 = get_rate(connindex, &c->sisSav, L0DG_OVERHEAD);
+                        _merge_snap(s, &snap);
+                } else {
+                        if (repo.intfFD >= 0 && repo.sisConnCount == 0) {
+                                upd_intf_stats(FALSE);
+                        }
+                        repo.sisConnCount++;
                 }
-                repo.sisConnCount++; // Increment connection count for this sub-interval
         } else {
-                mbps              = repo.siAggRateL3; // Previously accumulated aggregate
-                intfmbps          = repo.intfMbps;    // Previously obtained interface rate
-                repo.sisConnCount = 0;                // Reset counter for next sub-interval
+                mbps = repo.siAggRateL3; // Previously accumulated aggregate
         }
 
         //
@@ -1937,8 +3586,8 @@ int output_currate(int connindex) {
                 // If new max save sub-interval time, stats, and rates
                 //
                 if (var) {
-                        tspeccpy(&repo.timeOfMax[i], &repo.systemClock);
-                        repo.actConnections[i] = repo.actConnCount;
+                        repo.timeOfMax[i] = repo.systemClock;
+                        repo.actConnections[i] = repo.actConnCount + worker_actconn();
                         memcpy(&repo.sisMax[i], &c->sisSav, sizeof(struct subIntStats));
                         repo.sisMaxCECount[i] = c->sisSavCECount;
                         repo.rateMaxL3[i]     = mbps;
@@ -1954,51 +3603,6 @@ int output_currate(int connindex) {
                 }
         }
 
-        //
-        // Merge non-aggregate connection stats into aggregate connection
-        //
-        if (connindex != aggConn && !repo.isServer) {
-                a = &conn[aggConn]; // Aggregate connection pointer
-                if (repo.sisConnCount == 1 && a->subIntCount == 0) {
-                        // Initialize if first non-aggregate connection AND prior to first aggregate sub-interval
-                        a->clockDeltaMin        = c->clockDeltaMin;
-                        a->rttMinimum           = c->rttMinimum;
-                        a->sisSav.delayVarMin   = STATUS_NODEL;
-                        a->sisSav.rttVarMinimum = STATUS_NODEL;
-                        a->ecnCEThresh          = c->ecnCEThresh;
-                } else {
-                        if (c->clockDeltaMin < a->clockDeltaMin)
-                                a->clockDeltaMin = c->clockDeltaMin;
-                        if (c->rttMinimum < a->rttMinimum)
-                                a->rttMinimum = c->rttMinimum;
-                }
-                a->sisSav.rxDatagrams += c->sisSav.rxDatagrams;
-                a->sisSav.rxBytes += c->sisSav.rxBytes;
-                a->sisSav.deltaTime += c->sisSav.deltaTime;
-                a->sisSav.seqErrLoss += c->sisSav.seqErrLoss;
-                a->sisSav.seqErrOoo += c->sisSav.seqErrOoo;
-                a->sisSav.seqErrDup += c->sisSav.seqErrDup;
-                if (c->sisSav.delayVarMin < a->sisSav.delayVarMin)
-                        a->sisSav.delayVarMin = c->sisSav.delayVarMin;
-                a->sisSav.delayVarSum += c->sisSav.delayVarSum;
-                a->sisSav.delayVarCnt += c->sisSav.delayVarCnt;
-                if (c->sisSav.delayVarMax > a->sisSav.delayVarMax)
-                        a->sisSav.delayVarMax = c->sisSav.delayVarMax;
-                if (c->sisSav.rttVarMinimum < a->sisSav.rttVarMinimum)
-                        a->sisSav.rttVarMinimum = c->sisSav.rttVarMinimum;
-                if (c->sisSav.rttVarMaximum > a->sisSav.rttVarMaximum)
-                        a->sisSav.rttVarMaximum = c->sisSav.rttVarMaximum;
-                //
-                a->rttVarSum += c->rttVarSum; // Merge local RTT variation sum and count
-                a->rttVarCnt += c->rttVarCnt;
-                //
-                a->sisSavCECount += c->sisSavCECount; // Merge CE count
-                if (c->ecnBleachCount != 0) {
-                        a->ecnBleachCount = -1; // Merge ECN bleaching detection
-                }
-                a->sisSav.accumTime = c->sisSav.accumTime; // Use accumulated time of last test connection processed
-        }
-
         //
         // Output sampled rate info
         //
@@ -2046,6 +3650,10 @@ int output_currate(int connindex) {
                                 strcpy(celabel, CE_LABEL_TEXT);
                                 sprintf(cedata, "/%u", c->sisSavCECount);
                         }
+                        if (c->sisSavDropCnt > 0) { // Append local receive drops when present
+                                strcat(celabel, LOCDROP_TEXT);
+                                sprintf(&cedata[strlen(cedata)], "/%u", c->sisSavDropCnt);
+                        }
                         var = sprintf(scratch, scratch2, connid, c->subIntCount, i, dvar, delivered, celabel, c->sisSav.seqErrLoss,
                                       c->sisSav.seqErrOoo, c->sisSav.seqErrDup, cedata, dvmin, dvavg, c->sisSav.delayVarMax, rttmin,
                                       rttavg, c->sisSav.rttVarMaximum, mbps, intfrate);
@@ -2065,9 +3673,9 @@ int output_currate(int connindex) {
                         dvar = (double) c->sisSav.accumTime / MSECINSEC;
                         cJSON_AddNumberPToObject(json_subint, "Seconds", dvar, 1);
                         //
-                        create_timestamp(&repo.systemClock, TRUE);
+                        create_timestamp(repo.systemClock, TRUE);
                         cJSON_AddStringToObject(json_subint, "TimeOfSubInterval", scratch);
-                        cJSON_AddNumberToObject(json_subint, "ActiveConnections", repo.actConnCount);
+                        cJSON_AddNumberToObject(json_subint, "ActiveConnections", repo.actConnCount + worker_actconn());
                         //
                         if (sent > 0.0) {
                                 dvar = ((double) c->sisSav.rxDatagrams * 100.0) / sent;
@@ -2093,6 +3701,7 @@ int output_currate(int connindex) {
                         cJSON_AddNumberToObject(json_subint, "ReorderedCount", c->sisSav.seqErrOoo);
                         cJSON_AddNumberToObject(json_subint, "ReplicatedCount", c->sisSav.seqErrDup);
                         cJSON_AddNumberToObject(json_subint, "CECountOfDelivered", c->sisSavCECount);
+                        cJSON_AddNumberToObject(json_subint, "LocalDropCount", c->sisSavDropCnt);
                         //
                         dvar = (double) dvmin / 1000.0;
                         cJSON_AddNumberPToObject(json_subint, "PDVMin", dvar, -9);
@@ -2102,6 +3711,14 @@ int output_currate(int connindex) {
                         cJSON_AddNumberPToObject(json_subint, "PDVMax", dvar, -9);
                         dvar = (double) (c->sisSav.delayVarMax - dvmin) / 1000.0;
                         cJSON_AddNumberPToObject(json_subint, "PDVRange", dvar, -9);
+                        if (c->sisSavPdv.count > 0) { // Percentiles from microsecond delay variation sketch
+                                dvar = (double) _pdv_quantile(&c->sisSavPdv, 50) / USECINSEC;
+                                cJSON_AddNumberPToObject(json_subint, "PDVPercentile50", dvar, -9);
+                                dvar = (double) _pdv_quantile(&c->sisSavPdv, 95) / USECINSEC;
+                                cJSON_AddNumberPToObject(json_subint, "PDVPercentile95", dvar, -9);
+                                dvar = (double) _pdv_quantile(&c->sisSavPdv, 99) / USECINSEC;
+                                cJSON_AddNumberPToObject(json_subint, "PDVPercentile99", dvar, -9);
+                        }
                         //
                         dvar = (double) rttmin / 1000.0;
                         cJSON_AddNumberPToObject(json_subint, "RTTMin", dvar, -9);
@@ -2125,66 +3742,517 @@ int output_currate(int connindex) {
         }
 
         //
-        // Final processing for aggregate connection
+        // Final processing for aggregate connection
+        //
+        if (connindex == aggConn) {
+                //
+                // Accumulate overall test summary statistics
+                //
+                i = 0; // Initialize to single summary or first bimodal summary
+                if (conf.bimodalCount > 0 && c->subIntCount > conf.bimodalCount) {
+                        i++; // Adjust to save as second bimodal summary
+                }
+                ts = &repo.testSum[i];
+                if (ts->sampleCount == 0) {
+                        ts->delayVarMin = dvmin;
+                        ts->delayVarMax = (unsigned int) c->sisSav.delayVarMax;
+                        ts->delayVarSum = dvavg; // Sum averages to prevent overflow
+                        //
+                        ts->rttVarMinimum = rttmin;
+                        ts->rttVarMaximum = (unsigned int) c->sisSav.rttVarMaximum;
+                } else {
+                        if (dvmin < ts->delayVarMin)
+                                ts->delayVarMin = dvmin;
+                        if (c->sisSav.delayVarMax > (uint32_t) ts->delayVarMax)
+                                ts->delayVarMax = (unsigned int) c->sisSav.delayVarMax;
+                        ts->delayVarSum += dvavg; // Sum averages to prevent overflow
+                        //
+                        if (rttmin < ts->rttVarMinimum)
+                                ts->rttVarMinimum = rttmin;
+                        if (c->sisSav.rttVarMaximum > (uint32_t) ts->rttVarMaximum)
+                                ts->rttVarMaximum = (unsigned int) c->sisSav.rttVarMaximum;
+                }
+                ts->rxDatagrams += (unsigned int) c->sisSav.rxDatagrams;
+                ts->seqErrLoss += (unsigned int) c->sisSav.seqErrLoss;
+                ts->seqErrOoo += (unsigned int) c->sisSav.seqErrOoo;
+                ts->seqErrDup += (unsigned int) c->sisSav.seqErrDup;
+                ts->rttVarSum += c->rttVarSum; // Local RTT variation sum and count
+                ts->rttVarCnt += c->rttVarCnt;
+                ts->rxCECount += c->sisSavCECount; // Total CE count
+                ts->rateSumL3 += (double) mbps;
+                ts->rateSumIntf += (double) intfmbps;
+                ts->sampleCount++;
+
+                //
+                // Re-initialize stats for next sub-interval
+                //
+                memset(&c->sisSav, 0, sizeof(struct subIntStats));
+                c->sisSav.delayVarMin   = STATUS_NODEL;
+                c->sisSav.rttVarMinimum = STATUS_NODEL;
+                c->sisSavCECount        = 0;
+                c->sisSavDropCnt        = 0;
+                memset(&c->sisSavPdv, 0, sizeof(struct pdvSketch));
+                repo.siAggRateL3        = 0.0;
+                repo.siAggRateL2        = 0.0;
+                repo.siAggRateL1        = 0.0;
+                repo.siAggRateL0        = 0.0;
+        }
+        //
+        // Re-initialize local RTT variation sum and count
+        //
+        c->rttVarSum = 0;
+        c->rttVarCnt = 0;
+
+        //
+        // Process aggregate if this was the last active connection to complete the sub-interval
+        //
+        if (connindex != aggConn && !repo.isServer)
+                _agg_check();
+
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Save sub-interval stats of connection for merge into aggregation slot
+//
+static void _snap_subint(struct aggSnap *s, struct connection *c) {
+
+        memcpy(&s->sisSav, &c->sisSav, sizeof(struct subIntStats));
+        memcpy(&s->sisSavPdv, &c->sisSavPdv, sizeof(struct pdvSketch));
+        s->sisSavCECount  = c->sisSavCECount;
+        s->sisSavDropCnt  = c->sisSavDropCnt;
+        s->rttVarSum      = c->rttVarSum;
+        s->rttVarCnt      = c->rttVarCnt;
+        s->clockDeltaMin  = c->clockDeltaMin;
+        s->rttMinimum     = c->rttMinimum;
+        s->ecnCEThresh    = c->ecnCEThresh;
+        s->ecnBleachCount = c->ecnBleachCount;
+}
+//
+// Merge saved sub-interval stats (of test connection or worker process) into aggregation slot
+//
+static void _merge_snap(struct aggSnap *d, struct aggSnap *s) {
+        double intfmbps;
+
+        if (d->connCount == 0) {
+                intfmbps     = d->intfMbps; // Copy all stats of first connection, retaining interface rate
+                *d           = *s;
+                d->intfMbps  = intfmbps;
+                d->connCount = 1;
+                return;
+        }
+        if (s->clockDeltaMin < d->clockDeltaMin)
+                d->clockDeltaMin = s->clockDeltaMin;
+        if (s->rttMinimum < d->rttMinimum)
+                d->rttMinimum = s->rttMinimum;
+        d->sisSav.rxDatagrams += s->sisSav.rxDatagrams;
+        d->sisSav.rxBytes += s->sisSav.rxBytes;
+        d->sisSav.deltaTime += s->sisSav.deltaTime;
+        d->sisSav.seqErrLoss += s->sisSav.seqErrLoss;
+        d->sisSav.seqErrOoo += s->sisSav.seqErrOoo;
+        d->sisSav.seqErrDup += s->sisSav.seqErrDup;
+        if (s->sisSav.delayVarMin < d->sisSav.delayVarMin)
+                d->sisSav.delayVarMin = s->sisSav.delayVarMin;
+        d->sisSav.delayVarSum += s->sisSav.delayVarSum;
+        d->sisSav.delayVarCnt += s->sisSav.delayVarCnt;
+        if (s->sisSav.delayVarMax > d->sisSav.delayVarMax)
+                d->sisSav.delayVarMax = s->sisSav.delayVarMax;
+        if (s->sisSav.rttVarMinimum < d->sisSav.rttVarMinimum)
+                d->sisSav.rttVarMinimum = s->sisSav.rttVarMinimum;
+        if (s->sisSav.rttVarMaximum > d->sisSav.rttVarMaximum)
+                d->sisSav.rttVarMaximum = s->sisSav.rttVarMaximum;
+        d->sisSav.accumTime = s->sisSav.accumTime; // Use accumulated time of last test connection processed
+        //
+        d->rttVarSum += s->rttVarSum; // Merge local RTT variation sum and count
+        d->rttVarCnt += s->rttVarCnt;
+        //
+        d->sisSavCECount += s->sisSavCECount; // Merge CE count
+        d->sisSavDropCnt += s->sisSavDropCnt; // Merge local drop count
+        _pdv_merge(&d->sisSavPdv, &s->sisSavPdv);
+        if (s->ecnBleachCount != 0) {
+                d->ecnBleachCount = -1; // Merge ECN bleaching detection
+        }
+        d->rateL3 += s->rateL3; // Accumulate all rate types
+        d->rateL2 += s->rateL2;
+        d->rateL1 += s->rateL1;
+        d->rateL0 += s->rateL0;
+        d->connCount++;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain aggregation slot of a sub-interval. A connection completing a sub-interval whose aggregate was already
+// processed is folded into the next one, while the oldest aggregate is processed if the slots are exhausted (i.e.,
+// a connection is too far ahead of one that has stalled).
+//
+static struct aggSnap *_agg_slot(int subint) {
+        register struct connection *a = &conn[aggConn];
+
+        if (subint <= a->subIntCount)
+                subint = a->subIntCount + 1;
+        while (subint > a->subIntCount + AGG_SLOTS)
+                output_currate(aggConn);
+        return &aggSlot[(subint - 1) % AGG_SLOTS];
+}
+//
+// Load aggregation slot of the next sub-interval into aggregate connection, and return its interface rate
+//
+static double _agg_load(struct connection *a) {
+        struct aggSnap *s = &aggSlot[a->subIntCount % AGG_SLOTS];
+        double intfmbps;
+
+        if (s->connCount > 0) {
+                if (a->subIntCount == 0) {
+                        // Initialize prior to first aggregate sub-interval
+                        a->clockDeltaMin = s->clockDeltaMin;
+                        a->rttMinimum    = s->rttMinimum;
+                        a->ecnCEThresh   = s->ecnCEThresh;
+                } else {
+                        if (s->clockDeltaMin < a->clockDeltaMin)
+                                a->clockDeltaMin = s->clockDeltaMin;
+                        if (s->rttMinimum < a->rttMinimum)
+                                a->rttMinimum = s->rttMinimum;
+                }
+                if (s->ecnBleachCount != 0) {
+                        a->ecnBleachCount = -1; // Merge ECN bleaching detection
+                }
+                memcpy(&a->sisSav, &s->sisSav, sizeof(struct subIntStats));
+        } else {
+                memset(&a->sisSav, 0, sizeof(struct subIntStats));
+                a->sisSav.delayVarMin   = STATUS_NODEL;
+                a->sisSav.rttVarMinimum = STATUS_NODEL;
+        }
+        a->sisSavCECount = s->sisSavCECount;
+        a->sisSavDropCnt = s->sisSavDropCnt;
+        memcpy(&a->sisSavPdv, &s->sisSavPdv, sizeof(struct pdvSketch));
+        a->rttVarSum     = s->rttVarSum;
+        a->rttVarCnt     = s->rttVarCnt;
+        repo.siAggRateL3 = s->rateL3;
+        repo.siAggRateL2 = s->rateL2;
+        repo.siAggRateL1 = s->rateL1;
+        repo.siAggRateL0 = s->rateL0;
+        intfmbps         = s->intfMbps;
+        memset(s, 0, sizeof(struct aggSnap)); // Clear slot for reuse
+        return intfmbps;
+}
+//
+// Process aggregate sub-interval(s) once all active connections (and worker processes) have completed them
+//
+static void _agg_check(void) {
+        register struct connection *a = &conn[aggConn];
+        struct aggSnap *s;
+
+        while (a->state == S_DATA) {
+                s = &aggSlot[a->subIntCount % AGG_SLOTS];
+                if (s->connCount < repo.actConnCount || worker_wait(a->subIntCount + 1) > 0)
+                        break;
+                if (s->connCount == 0 && !worker_pending())
+                        break; // Nothing to process
+                output_currate(aggConn);
+        }
+}
+//
+// Check if any aggregation slot (or published sub-interval stats of worker processes) remains to be processed
+//
+static BOOL _agg_pending(void) {
+        int i;
+
+        for (i = 0; i < AGG_SLOTS; i++) {
+                if (aggSlot[i].connCount > 0)
+                        return TRUE;
+        }
+        return worker_pending();
+}
+//----------------------------------------------------------------------------
+//
+// Start client worker processes, each testing every Nth connection of the multi-connection test (with parent
+// as worker 0). Each worker aggregates its own connections and publishes a snapshot per sub-interval to shared
+// memory, which the parent merges into its aggregate connection for output (see worker_merge).
+//
+// Populate scratch buffer and return length on error
+//
+int worker_start(void) {
+        int i;
+        pid_t pid;
+
+        if (conf.workerCount > conf.maxConnCount)
+                conf.workerCount = conf.maxConnCount; // At least one test connection per worker
+        if (conf.workerCount <= 1)
+                return 0;
+        if (repo.mcIdent == 0) {
+                repo.mcIdent = getuniform(1, UINT16_MAX); // Multi-connection identifier common to all workers
+        }
+        workerShm = mmap(NULL, sizeof(struct workerShm) * (size_t) conf.workerCount, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (workerShm == MAP_FAILED) {
+                workerShm = NULL;
+                return sprintf(scratch, "ERROR: Unable to allocate shared memory of worker processes: %s\n", strerror(errno));
+        }
+        for (i = 1; i < conf.workerCount; i++) {
+                atomic_init(&workerShm[i].published, 0);
+                atomic_init(&workerShm[i].merged, 0);
+                atomic_init(&workerShm[i].actConnCount, (conf.maxConnCount - i + conf.workerCount - 1) / conf.workerCount);
+                atomic_init(&workerShm[i].endTimeStatus, STATUS_ERROR);
+                atomic_init(&workerShm[i].done, 0);
+                if ((pid = fork()) < 0) {
+                        return sprintf(scratch, "ERROR: Unable to start worker process: %s\n", strerror(errno));
+                } else if (pid == 0) {
+                        //
+                        // Worker process uses its own epoll instance (the inherited one is shared with parent)
+                        //
+                        repo.workerIndex = i;
+                        repo.testHdrDone = TRUE; // Test settings are only output by parent
+                        srandom((unsigned int) (nsnsec(repo.systemClock) ^ getpid()));
+                        close(repo.epollFD);
+                        if ((repo.epollFD = epoll_create1(0)) < 0) {
+                                return sprintf(scratch, "EPOLL ERROR: %s\n", strerror(errno));
+                        }
+                        return 0;
+                }
+                workerShm[i].pid = pid;
+        }
+        return 0;
+}
+//
+// Publish aggregate sub-interval stats of worker process to parent, and re-initialize for next sub-interval
+//
+void worker_publish(int connindex) {
+        register struct connection *c = &conn[connindex];
+        struct workerShm *w = &workerShm[repo.workerIndex];
+        struct aggSnap *s;
+        int slot;
+
+        //
+        // Snapshots are retained in a ring, as this worker may be up to a sub-interval ahead of slower workers. If
+        // the parent has fallen a full ring behind (e.g., stalled in output), the oldest unmerged snapshot is left
+        // in place and this one is dropped, as the parent may be reading it (detected via its sub-interval count).
         //
-        if (connindex == aggConn) {
-                //
-                // Accumulate overall test summary statistics
-                //
-                i = 0; // Initialize to single summary or first bimodal summary
-                if (conf.bimodalCount > 0 && c->subIntCount > conf.bimodalCount) {
-                        i++; // Adjust to save as second bimodal summary
+        c->subIntCount++;
+        slot = (c->subIntCount - 1) % WORKER_SNAP_RING;
+        if (c->subIntCount - atomic_load_explicit(&w->merged, memory_order_acquire) <= WORKER_SNAP_RING) {
+                s = &w->snap[slot];
+                _snap_subint(s, c);
+                s->rateL3        = repo.siAggRateL3;
+                s->rateL2        = repo.siAggRateL2;
+                s->rateL1        = repo.siAggRateL1;
+                s->rateL0        = repo.siAggRateL0;
+                w->snapSeq[slot] = c->subIntCount;
+        }
+        atomic_store_explicit(&w->actConnCount, repo.actConnCount, memory_order_relaxed);
+        atomic_store_explicit(&w->published, c->subIntCount, memory_order_release);
+
+        memset(&c->sisSav, 0, sizeof(struct subIntStats));
+        c->sisSav.delayVarMin   = STATUS_NODEL;
+        c->sisSav.rttVarMinimum = STATUS_NODEL;
+        c->sisSavCECount        = 0;
+        c->sisSavDropCnt        = 0;
+        memset(&c->sisSavPdv, 0, sizeof(struct pdvSketch));
+        c->rttVarSum            = 0;
+        c->rttVarCnt            = 0;
+        repo.siAggRateL3        = 0.0;
+        repo.siAggRateL2        = 0.0;
+        repo.siAggRateL1        = 0.0;
+        repo.siAggRateL0        = 0.0;
+}
+//
+// Merge published sub-interval stats of worker processes (up to the next aggregate sub-interval) into aggregate
+//
+void worker_merge(int connindex) {
+        register struct connection *a = &conn[connindex];
+        struct workerShm *w;
+        int i, var, published, merged;
+
+        for (i = 1; i < conf.workerCount && workerShm != NULL && repo.workerIndex == 0; i++) {
+                w         = &workerShm[i];
+                published = atomic_load_explicit(&w->published, memory_order_acquire);
+                merged    = atomic_load_explicit(&w->merged, memory_order_relaxed);
+                while (merged < published && merged <= a->subIntCount) {
+                        if (w->snapSeq[merged % WORKER_SNAP_RING] == merged + 1) {
+                                // Worker is counted as a connection of this sub-interval
+                                _merge_snap(&aggSlot[a->subIntCount % AGG_SLOTS], &w->snap[merged % WORKER_SNAP_RING]);
+                        } else {
+                                var = sprintf(scratch, "[%d]WARNING: Worker %d sub-interval %d stats dropped\n", connindex, i,
+                                              merged + 1);
+                                send_proc(errConn, scratch, var);
+                        }
+                        atomic_store_explicit(&w->merged, ++merged, memory_order_release); // Slot may now be reused
                 }
-                ts = &repo.testSum[i];
-                if (ts->sampleCount == 0) {
-                        ts->delayVarMin = dvmin;
-                        ts->delayVarMax = (unsigned int) c->sisSav.delayVarMax;
-                        ts->delayVarSum = dvavg; // Sum averages to prevent overflow
-                        //
-                        ts->rttVarMinimum = rttmin;
-                        ts->rttVarMaximum = (unsigned int) c->sisSav.rttVarMaximum;
-                } else {
-                        if (dvmin < ts->delayVarMin)
-                                ts->delayVarMin = dvmin;
-                        if (c->sisSav.delayVarMax > (uint32_t) ts->delayVarMax)
-                                ts->delayVarMax = (unsigned int) c->sisSav.delayVarMax;
-                        ts->delayVarSum += dvavg; // Sum averages to prevent overflow
-                        //
-                        if (rttmin < ts->rttVarMinimum)
-                                ts->rttVarMinimum = rttmin;
-                        if (c->sisSav.rttVarMaximum > (uint32_t) ts->rttVarMaximum)
-                                ts->rttVarMaximum = (unsigned int) c->sisSav.rttVarMaximum;
+        }
+}
+//
+// Return count of worker processes that have neither published the specified sub-interval nor finished
+//
+int worker_wait(int subint) {
+        struct workerShm *w;
+        int i, status, count = 0;
+
+        for (i = 1; i < conf.workerCount && workerShm != NULL && repo.workerIndex == 0; i++) {
+                w = &workerShm[i];
+                if (atomic_load_explicit(&w->done, memory_order_acquire) ||
+                    atomic_load_explicit(&w->published, memory_order_acquire) >= subint)
+                        continue;
+                if (w->pid > 0 && waitpid(w->pid, &status, WNOHANG) == w->pid) {
+                        w->pid = 0; // Worker process ended without finishing, treat its test connections as failed
+                        atomic_store(&w->actConnCount, 0);
+                        atomic_store(&w->done, 1);
+                        continue;
                 }
-                ts->rxDatagrams += (unsigned int) c->sisSav.rxDatagrams;
-                ts->seqErrLoss += (unsigned int) c->sisSav.seqErrLoss;
-                ts->seqErrOoo += (unsigned int) c->sisSav.seqErrOoo;
-                ts->seqErrDup += (unsigned int) c->sisSav.seqErrDup;
-                ts->rttVarSum += c->rttVarSum; // Local RTT variation sum and count
-                ts->rttVarCnt += c->rttVarCnt;
-                ts->rxCECount += c->sisSavCECount; // Total CE count
-                ts->rateSumL3 += (double) mbps;
-                ts->rateSumIntf += (double) intfmbps;
-                ts->sampleCount++;
+                count++;
+        }
+        return count;
+}
+//
+// Check if any published sub-interval stats of worker processes have not yet been merged
+//
+BOOL worker_pending(void) {
+        int i;
 
-                //
-                // Re-initialize stats for next sub-interval
-                //
-                memset(&c->sisSav, 0, sizeof(struct subIntStats));
-                c->sisSav.delayVarMin   = STATUS_NODEL;
-                c->sisSav.rttVarMinimum = STATUS_NODEL;
-                c->sisSavCECount        = 0;
-                repo.siAggRateL3        = 0.0;
-                repo.siAggRateL2        = 0.0;
-                repo.siAggRateL1        = 0.0;
-                repo.siAggRateL0        = 0.0;
+        for (i = 1; i < conf.workerCount && workerShm != NULL && repo.workerIndex == 0; i++) {
+                if (atomic_load_explicit(&workerShm[i].merged, memory_order_relaxed) <
+                    atomic_load_explicit(&workerShm[i].published, memory_order_acquire))
+                        return TRUE;
+        }
+        return FALSE;
+}
+//
+// Return total active test connections of worker processes
+//
+int worker_actconn(void) {
+        int i, count = 0;
+
+        for (i = 1; i < conf.workerCount && workerShm != NULL && repo.workerIndex == 0; i++) {
+                count += atomic_load_explicit(&workerShm[i].actConnCount, memory_order_relaxed);
+        }
+        return count;
+}
+//
+// Update state of worker process for parent, or when finished have parent retain any error status of workers
+//
+void worker_status(BOOL done) {
+        struct workerShm *w;
+        int i, status;
+
+        if (workerShm == NULL)
+                return;
+        if (repo.workerIndex > 0) {
+                w = &workerShm[repo.workerIndex];
+                atomic_store_explicit(&w->actConnCount, repo.actConnCount, memory_order_relaxed);
+                if (done) {
+                        atomic_store_explicit(&w->endTimeStatus, repo.endTimeStatus, memory_order_relaxed);
+                        atomic_store_explicit(&w->done, 1, memory_order_release);
+                }
+        } else if (done) {
+                for (i = 1; i < conf.workerCount; i++) {
+                        status = atomic_load_explicit(&workerShm[i].endTimeStatus, memory_order_relaxed);
+                        if (repo.endTimeStatus <= STATUS_WARNMAX && status > repo.endTimeStatus) // Retain any original error
+                                repo.endTimeStatus = status;
+                }
+        }
+}
+//
+// Stop any worker processes still running (parent) and release shared memory
+//
+void worker_finish(void) {
+        int i;
+
+        if (workerShm == NULL)
+                return;
+        for (i = 1; i < conf.workerCount && repo.workerIndex == 0; i++) {
+                if (workerShm[i].pid <= 0)
+                        continue;
+                if (!atomic_load(&workerShm[i].done))
+                        kill(workerShm[i].pid, SIGTERM);
+                waitpid(workerShm[i].pid, NULL, 0);
+        }
+        munmap(workerShm, sizeof(struct workerShm) * (size_t) conf.workerCount);
+        workerShm = NULL;
+}
+//----------------------------------------------------------------------------
+//
+// Apply realtime profile to data-plane of this (worker or server) process. It is pinned to its CPU from the
+// configured list, so that buffers are first touched (prefaulted) on the local NUMA node, and test sockets are
+// associated with the same CPU (see new_conn). Optionally, it is raised to SCHED_FIFO with all memory locked.
+//
+// Warnings are output for any part that cannot be applied (e.g., insufficient privileges)
+//
+void rt_profile(void) {
+        int var;
+        struct sched_param sp;
+        cpu_set_t mask;
+
+        if (conf.rtCpuCount == 0 && conf.rtPriority == 0)
+                return;
+#ifdef __linux__
+        if (conf.rtCpuCount > 0) {
+                sched_getaffinity(0, sizeof(rtMask), &rtMask); // Retained for threads outside data-plane
+                repo.rtCpu = conf.rtCpu[repo.workerIndex % conf.rtCpuCount];
+                CPU_ZERO(&mask);
+                CPU_SET(repo.rtCpu, &mask);
+                if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+                        var = sprintf(scratch, "WARNING: Unable to pin data-plane to CPU %d: %s\n", repo.rtCpu, strerror(errno));
+                        send_proc(errConn, scratch, var);
+                        repo.rtCpu = -1;
+                }
+        }
+#endif
+        if (conf.rtPriority > 0) {
+                memset(&sp, 0, sizeof(sp));
+                sp.sched_priority = conf.rtPriority;
+                if (sched_setscheduler(0, SCHED_FIFO, &sp) != 0) {
+                        var = sprintf(scratch, "WARNING: Unable to set SCHED_FIFO priority %d: %s\n", conf.rtPriority,
+                                      strerror(errno));
+                        send_proc(errConn, scratch, var);
+                }
+                if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+                        var = sprintf(scratch, "WARNING: Unable to lock memory: %s\n", strerror(errno));
+                        send_proc(errConn, scratch, var);
+                } else {
+                        repo.rtLocked = TRUE;
+                }
         }
+
         //
-        // Re-initialize local RTT variation sum and count
+        // Prefault I/O buffers and connection table (also breaking any copy-on-write sharing with parent process)
         //
-        c->rttVarSum = 0;
-        c->rttVarCnt = 0;
+        _rt_prefault(repo.sndBuffer, SND_BUFFER_SIZE);
+        _rt_prefault(repo.sndBufRand, SND_BUFFER_SIZE);
+        _rt_prefault(repo.defBuffer, RCV_BUFFER_SIZE);
+        _rt_prefault(repo.randData, MAX_JPAYLOAD_SIZE);
+        _rt_prefault(rxCmsgBuf, sizeof(rxCmsgBuf));
+        _rt_prefault(demuxBuf, sizeof(demuxBuf));
+        _rt_prefault((char *) conn, sizeof(struct connection) * (size_t) conf.maxConnections);
 
-        return 0;
+        if (conf.verbose) {
+                var = sprintf(scratch, "Realtime profile (Process %d): CPU %d, SCHED_FIFO priority %d, Memory locked: %s\n",
+                              repo.workerIndex, repo.rtCpu, conf.rtPriority, boolText[repo.rtLocked]);
+                send_proc(monConn, scratch, var);
+        }
+}
+//
+// Remove realtime profile from calling thread when it is not part of the data-plane (e.g., control thread)
+//
+void rt_unpin(void) {
+        struct sched_param sp;
+
+#ifdef __linux__
+        if (repo.rtCpu >= 0)
+                sched_setaffinity(0, sizeof(rtMask), &rtMask);
+#endif
+        if (conf.rtPriority > 0) {
+                memset(&sp, 0, sizeof(sp));
+                sched_setscheduler(0, SCHED_OTHER, &sp);
+        }
+}
+//
+// Touch each page of buffer (with a write that preserves its contents)
+//
+static void _rt_prefault(char *buf, size_t size) {
+        volatile char *p;
+        size_t i, page = (size_t) sysconf(_SC_PAGESIZE);
+
+        for (i = 0; i < size; i += page) {
+                p  = buf + i;
+                *p = *p;
+        }
 }
 //----------------------------------------------------------------------------
 //
@@ -2283,7 +4351,7 @@ int output_maxrate(int connindex) {
                         cJSON_AddNumberToObject(json_summary, "Mode", i + 1);
                         cJSON_AddNumberToObject(json_summary, "Intervals", var);
                         //
-                        cJSON_AddNumberToObject(json_summary, "ActiveConnections", repo.actConnCount);
+                        cJSON_AddNumberToObject(json_summary, "ActiveConnections", repo.actConnCount + worker_actconn());
                         if (sent > 0.0) {
                                 dvar = ((double) ts->rxDatagrams * 100.0) / sent;
                                 cJSON_AddNumberPToObject(json_summary, "DeliveredPercent", dvar, 2);
@@ -2370,7 +4438,7 @@ int output_maxrate(int connindex) {
                 if (c->rttMinimum != STATUS_NODEL)
                         rttmin = c->rttMinimum;
                 strcpy(scratch2, "%s%s " MINIMUM_FINAL);
-                var = sprintf(scratch, scratch2, connid, testtype, c->clockDeltaMin, rttmin, repo.actConnCount);
+                var = sprintf(scratch, scratch2, connid, testtype, c->clockDeltaMin, rttmin, repo.actConnCount + worker_actconn());
                 send_proc(errConn, scratch, var);
         }
 
@@ -2413,7 +4481,7 @@ int output_maxrate(int connindex) {
                         cJSON_AddNumberToObject(json_atmax, "Mode", i + 1);
                         cJSON_AddNumberToObject(json_atmax, "Intervals", var);
                         //
-                        create_timestamp(&repo.timeOfMax[i], TRUE);
+                        create_timestamp(repo.timeOfMax[i], TRUE);
                         cJSON_AddStringToObject(json_atmax, "TimeOfMax", scratch);
                         cJSON_AddNumberToObject(json_atmax, "ActiveConnections", repo.actConnections[i]);
                         //
@@ -2507,88 +4575,335 @@ int output_maxrate(int connindex) {
                 sibegin = conf.bimodalCount + 1;
                 siend   = c->subIntCount;
         }
-
-        return 0;
+
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Calculate data rate from trial interval statistics OR sub-interval statistics
+//
+double get_rate(int connindex, struct subIntStats *sis, int overhead) {
+        register struct connection *c = &conn[connindex];
+        unsigned int delta, dgrams;
+        unsigned long long bytes;
+        double mbps = 0.0;
+
+        if (c->ipProtocol == IPPROTO_IPV6)
+                overhead += IPV6_ADDSIZE;
+
+        if (sis == NULL) {
+                delta  = c->tiDeltaTime;
+                dgrams = c->tiRxDatagrams;
+                bytes  = (unsigned long long) c->tiRxBytes;
+        } else {
+                delta  = (unsigned int) sis->deltaTime;
+                dgrams = (unsigned int) sis->rxDatagrams;
+                bytes  = (unsigned long long) sis->rxBytes;
+        }
+        if (delta > 0) {
+                mbps = (double) dgrams;
+                mbps *= (double) overhead;
+                mbps += (double) bytes;
+                mbps *= 8.0;
+                mbps /= (double) delta;
+        }
+        return mbps;
+}
+//----------------------------------------------------------------------------
+//
+// Stop test at the end of test interval time
+//
+int stop_test(int connindex) {
+        register struct connection *c = &conn[connindex];
+
+        //
+        // Clear timer
+        //
+        c->timer3Thresh = 0;
+
+        //
+        // Signal stop
+        //
+        c->testAction = TEST_ACT_STOP1; // First phase of test stop
+
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Service recvmmsg() data buffers for load PDUs
+//
+int service_recvmmsg(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int i;
+        struct perfStatsAverages *psA = &repo.psAverages;
+        struct perfStatsMaximums *psM = &repo.psMaximums;
+
+        int (*loadaction)(int) = c->loadAction;
+        BOOL ecn               = (c->hotPath & HP_ECN) ? TRUE : FALSE;
+        BOOL rxts              = c->rxTimestamp;
+
+        repo.rcvDataPtr = repo.defBuffer; // Global data pointer
+        for (i = 0; i < RECVMMSG_SIZE; i++) {
+                if (mmsgDataSize[i] == 0)
+                        break;
+                repo.rcvDataSize = mmsgDataSize[i]; // Global data size
+                if (ecn)
+                        repo.rcvEcnBits = mmsgEcnBits[i]; // Global ECN value
+                if (rxts)
+                        repo.rcvTime = mmsgRxTime[i]; // Global receive time
+                loadaction(connindex);                // Specialized receive variant
+                repo.rcvDataPtr += RCV_HEADER_SIZE;
+        }
+        if (conf.psFile != NULL) { // Update performance statistics
+                if (i > 0) {
+                        psA->rxBurstCount++;
+                        psA->rxBurstTotal += (unsigned int) i;
+                        if ((unsigned int) i > psM->rxBurstSize)
+                                psM->rxBurstSize = (unsigned int) i;
+                }
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Receive test traffic of all connections on a shared test socket
+//
+// Datagrams are read in a single batch and demultiplexed by their source address to the test connection, where
+// load PDUs are serviced directly from the batch and any other PDUs via the secondary action of the connection
+//
+int recv_shared(int connindex) {
+        register struct connection *c = &conn[connindex], *t;
+        static struct mmsghdr mmsg[RECVMMSG_SIZE];         // Static array
+        static struct iovec iov[RECVMMSG_SIZE];            // Static array
+        static struct sockaddr_storage sas[RECVMMSG_SIZE]; // Static array
+        int i, j, var, ecnbits, count;
+        char *rcvbuf, addrstr[INET6_ADDR_STRLEN], portstr[8];
+        nstime_t rxtime;
+        struct cmsghdr *cmsg;
+        struct perfStatsCounters *psC = &repo.psCounters;
+        struct perfStatsAverages *psA = &repo.psAverages;
+        struct perfStatsMaximums *psM = &repo.psMaximums;
+#ifdef HAVE_SO_RXQ_OVFL
+        unsigned int dropcnt;
+#endif
+
+        //
+        // Prepare message structures and perform read
+        //
+        memset(mmsg, 0, sizeof(mmsg));
+        rcvbuf = demuxBuf;
+        for (i = 0; i < RECVMMSG_SIZE; i++) {
+                iov[i].iov_base                = rcvbuf;
+                iov[i].iov_len                 = DEMUX_RCV_SIZE;
+                mmsg[i].msg_hdr.msg_iov        = &iov[i];
+                mmsg[i].msg_hdr.msg_iovlen     = 1;
+                mmsg[i].msg_hdr.msg_name       = &sas[i];
+                mmsg[i].msg_hdr.msg_namelen    = sizeof(sas[i]);
+                mmsg[i].msg_hdr.msg_control    = &rxCmsgBuf[i * RECV_CMSG_SIZE];
+                mmsg[i].msg_hdr.msg_controllen = RECV_CMSG_SIZE;
+                rcvbuf += DEMUX_RCV_SIZE;
+        }
+#ifdef HAVE_RECVMMSG
+        count = recvmmsg(c->fd, mmsg, RECVMMSG_SIZE, MSG_TRUNC, NULL);
+#else
+        if ((count = (int) recvmsg(c->fd, &mmsg[0].msg_hdr, MSG_TRUNC)) >= 0) {
+                mmsg[0].msg_len = (unsigned int) count;
+                count           = 1;
+        }
+#endif
+        if (count < 0) {
+                if ((var = socket_error(connindex, errno, "RECVMMSG/RECVMSG")) > 0) {
+                        if (!conf.errSuppress && log_event(connindex, LOG_EVT_RECVERR, "RECV ERROR", 0)) {
+                                send_proc(errConn, scratch, var);
+                        }
+                }
+                return 0;
+        }
+        if (count < RECVMMSG_SIZE)
+                c->dataReady = FALSE; // Indicate all data has been read from this socket
+        if (conf.psFile != NULL && count > 0) { // Update performance statistics
+                psA->rxBurstCount++;
+                psA->rxBurstTotal += (unsigned int) count;
+                if ((unsigned int) count > psM->rxBurstSize)
+                        psM->rxBurstSize = (unsigned int) count;
+        }
+
+        //
+        // Demultiplex and service each datagram
+        //
+#ifdef HAVE_SO_RXQ_OVFL
+        dropcnt = c->rxDropLast;
+#endif
+        for (i = 0; i < count; i++) {
+                ecnbits = IPTOS_ECN_NOT_ECT;
+                rxtime  = repo.systemClock;
+                for (cmsg = CMSG_FIRSTHDR(&mmsg[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&mmsg[i].msg_hdr, cmsg)) {
+                        if ((cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS) ||
+                            (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_TCLASS)) {
+                                ecnbits = IPTOS_ECN(*(int *) CMSG_DATA(cmsg));
+                        }
+#ifdef HAVE_SO_RXQ_OVFL
+                        else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                                dropcnt = *(uint32_t *) CMSG_DATA(cmsg); // Cumulative socket drops
+                        }
+#endif
+#ifdef HAVE_SO_TIMESTAMPNS
+                        else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                                rxtime = tspec2ns((struct timespec *) CMSG_DATA(cmsg)); // Kernel receive timestamp
+                        }
+#endif
+                }
+                if ((j = _demux_lookup(&sas[i])) < 0) {
+                        psC->sharedUnmatched++;
+                        if (log_event(connindex, LOG_EVT_DEMUX, "DEMUX MISS", 1)) {
+                                getnameinfo((struct sockaddr *) &sas[i], mmsg[i].msg_hdr.msg_namelen, addrstr, INET6_ADDR_STRLEN,
+                                            portstr, sizeof(portstr), NI_NUMERICHOST | NI_NUMERICSERV);
+                                var = sprintf(scratch, "[%d]DEMUX MISS: Datagram from %s:%s matches no test connection\n",
+                                              connindex, addrstr, portstr);
+                                send_proc(errConn, scratch, var);
+                        }
+                        continue;
+                }
+                t                = &conn[j];
+                repo.rcvDataSize = (int) mmsg[i].msg_len; // Actual received length (although truncated)
+                repo.rcvEcnBits  = IPTOS_ECN_NOT_ECT;
+                repo.rcvTime     = rxtime;
+                if (t->ecnCEThresh > 0)
+                        repo.rcvEcnBits = ecnbits;
+                if (t->secAction == &service_recvmmsg || t->secAction == &service_loadpdu) {
+                        repo.rcvDataPtr = (char *) iov[i].iov_base;
+                        t->loadAction(j);
+                        continue;
+                }
+                //
+                // Copy control or status PDU to general I/O buffer (with its source address) as expected by handler,
+                // discarding any that was truncated (unlike load PDUs, only the header of which is needed)
+                //
+                if (mmsg[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                        psC->sharedUnmatched++;
+                        if (log_event(connindex, LOG_EVT_DEMUX, "DEMUX MISS", 1)) {
+                                var = sprintf(scratch, "[%d]DEMUX MISS: Truncated PDU (%d bytes) of connection %d discarded\n",
+                                              connindex, repo.rcvDataSize, j);
+                                send_proc(errConn, scratch, var);
+                        }
+                        continue;
+                }
+                memcpy(repo.defBuffer, iov[i].iov_base, repo.rcvDataSize);
+                repo.rcvDataPtr = repo.defBuffer;
+                memcpy(&repo.remSas, &sas[i], mmsg[i].msg_hdr.msg_namelen);
+                repo.remSasLen = mmsg[i].msg_hdr.msg_namelen;
+                if ((t->secAction)(j) < 0)
+                        init_conn(j, TRUE);
+        }
+#ifdef HAVE_SO_RXQ_OVFL
+        //
+        // Datagrams dropped by socket receive buffer overflow cannot be attributed to a test connection
+        //
+        if (dropcnt != c->rxDropLast) {
+                psC->sharedSocketDrops += dropcnt - c->rxDropLast; // Allow for counter wrap
+                c->rxDropLast = dropcnt;
+        }
+#endif
+        return count;
 }
 //----------------------------------------------------------------------------
 //
-// Calculate data rate from trial interval statistics OR sub-interval statistics
+// Demultiplexing of shared test socket traffic via hashed table (chained) of test connections keyed by remote
+// address and port
 //
-double get_rate(int connindex, struct subIntStats *sis, int overhead) {
-        register struct connection *c = &conn[connindex];
-        unsigned int delta, dgrams;
-        unsigned long long bytes;
-        double mbps = 0.0;
-
-        if (c->ipProtocol == IPPROTO_IPV6)
-                overhead += IPV6_ADDSIZE;
-
-        if (sis == NULL) {
-                delta  = c->tiDeltaTime;
-                dgrams = c->tiRxDatagrams;
-                bytes  = (unsigned long long) c->tiRxBytes;
+static unsigned int _demux_hash(struct sockaddr_storage *sas) {
+        int i, len;
+        unsigned char *p;
+        unsigned int hash = 2166136261U; // FNV-1a
+
+        if (sas->ss_family == AF_INET6) {
+                p   = (unsigned char *) &((struct sockaddr_in6 *) sas)->sin6_port;
+                len = sizeof(in_port_t);
+                for (i = 0; i < len; i++)
+                        hash = (hash ^ p[i]) * 16777619U;
+                p   = (unsigned char *) &((struct sockaddr_in6 *) sas)->sin6_addr;
+                len = sizeof(struct in6_addr);
         } else {
-                delta  = (unsigned int) sis->deltaTime;
-                dgrams = (unsigned int) sis->rxDatagrams;
-                bytes  = (unsigned long long) sis->rxBytes;
+                p   = (unsigned char *) &((struct sockaddr_in *) sas)->sin_port;
+                len = sizeof(in_port_t) + sizeof(struct in_addr); // Address follows port
         }
-        if (delta > 0) {
-                mbps = (double) dgrams;
-                mbps *= (double) overhead;
-                mbps += (double) bytes;
-                mbps *= 8.0;
-                mbps /= (double) delta;
+        for (i = 0; i < len; i++)
+                hash = (hash ^ p[i]) * 16777619U;
+        return hash & (DEMUX_TABLE_SIZE - 1);
+}
+static BOOL _demux_match(struct sockaddr_storage *sas1, struct sockaddr_storage *sas2) {
+        if (sas1->ss_family != sas2->ss_family)
+                return FALSE;
+        if (sas1->ss_family == AF_INET6) {
+                return (((struct sockaddr_in6 *) sas1)->sin6_port == ((struct sockaddr_in6 *) sas2)->sin6_port &&
+                        memcmp(&((struct sockaddr_in6 *) sas1)->sin6_addr, &((struct sockaddr_in6 *) sas2)->sin6_addr,
+                               sizeof(struct in6_addr)) == 0);
         }
-        return mbps;
+        return (((struct sockaddr_in *) sas1)->sin_port == ((struct sockaddr_in *) sas2)->sin_port &&
+                ((struct sockaddr_in *) sas1)->sin_addr.s_addr == ((struct sockaddr_in *) sas2)->sin_addr.s_addr);
 }
-//----------------------------------------------------------------------------
 //
-// Stop test at the end of test interval time
+// Add test connection to demux table with its remote address (newest connection of a remote address is found first)
 //
-int stop_test(int connindex) {
+void demux_add(int connindex, struct sockaddr_storage *sas, socklen_t saslen) {
         register struct connection *c = &conn[connindex];
+        unsigned int hash;
 
-        //
-        // Clear timer
-        //
-        tspecclear(&c->timer3Thresh);
-
-        //
-        // Signal stop
-        //
-        c->testAction = TEST_ACT_STOP1; // First phase of test stop
+        memcpy(&c->peerSas, sas, saslen);
+        c->peerSasLen    = saslen;
+        hash             = _demux_hash(&c->peerSas);
+        c->demuxNext     = demuxTable[hash];
+        demuxTable[hash] = connindex + 1;
+}
+//
+// Remove test connection from demux table
+//
+void demux_remove(int connindex) {
+        int *link;
 
-        return 0;
+        link = &demuxTable[_demux_hash(&conn[connindex].peerSas)];
+        while (*link > 0) {
+                if (*link == connindex + 1) {
+                        *link = conn[connindex].demuxNext;
+                        break;
+                }
+                link = &conn[*link - 1].demuxNext;
+        }
 }
-//----------------------------------------------------------------------------
 //
-// Service recvmmsg() data buffers for load PDUs
+// Look up test connection by remote address, return -1 if not found
 //
-int service_recvmmsg(int connindex) {
-        register struct connection *c = &conn[connindex];
+static int _demux_lookup(struct sockaddr_storage *sas) {
         int i;
-        struct perfStatsAverages *psA = &repo.psAverages;
-        struct perfStatsMaximums *psM = &repo.psMaximums;
 
-        repo.rcvDataPtr = repo.defBuffer; // Global data pointer
-        for (i = 0; i < RECVMMSG_SIZE; i++) {
-                if (mmsgDataSize[i] == 0)
-                        break;
-                repo.rcvDataSize = mmsgDataSize[i]; // Global data size
-                if (c->ecnCEThresh > 0)
-                        repo.rcvEcnBits = mmsgEcnBits[i]; // Global ECN value
-                service_loadpdu(connindex);
-                repo.rcvDataPtr += RCV_HEADER_SIZE;
+        for (i = demuxTable[_demux_hash(sas)]; i > 0; i = conn[i - 1].demuxNext) {
+                if (_demux_match(&conn[i - 1].peerSas, sas))
+                        return i - 1;
         }
-        if (conf.psFile != NULL) { // Update performance statistics
-                if (i > 0) {
-                        psA->rxBurstCount++;
-                        psA->rxBurstTotal += (unsigned int) i;
-                        if ((unsigned int) i > psM->rxBurstSize)
-                                psM->rxBurstSize = (unsigned int) i;
-                }
+        return -1;
+}
+//
+// Address message from connection on shared test socket to its remote address, with the packet marking of the
+// connection as ancillary data (as a socket option would apply to all connections)
+//
+static void _shared_msghdr(struct connection *c, struct msghdr *msg, char *tosbuf) {
+        struct cmsghdr *cmsg;
+
+        msg->msg_name    = &c->peerSas;
+        msg->msg_namelen = c->peerSasLen;
+        if (c->dscpEcn == DEF_DSCPECN_BYTE)
+                return;
+        cmsg             = (struct cmsghdr *) tosbuf;
+        cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+        cmsg->cmsg_level = IPPROTO_IP;
+        cmsg->cmsg_type  = IP_TOS;
+        if (c->ipProtocol == IPPROTO_IPV6) {
+                cmsg->cmsg_level = IPPROTO_IPV6;
+                cmsg->cmsg_type  = IPV6_TCLASS;
         }
-        return 0;
+        *(int *) CMSG_DATA(cmsg) = c->dscpEcn;
+        msg->msg_control         = tosbuf;
+        msg->msg_controllen      = TOS_CMSG_SIZE;
 }
 //----------------------------------------------------------------------------
 //
@@ -2600,6 +4915,9 @@ int recv_proc(int connindex) {
         static struct iovec iov[RECVMMSG_SIZE];    // Static array
         char *rcvbuf, *nextcmsg;
         int i, var, recvsize;
+#if defined(HAVE_RECVMMSG) && defined(HAVE_SO_RXQ_OVFL)
+        unsigned int dropcnt;
+#endif
 
         //
         // Specify receive buffer size (truncate load PDUs to reduce overhead of memory copy)
@@ -2611,6 +4929,7 @@ int recv_proc(int connindex) {
         }
         repo.rcvDataPtr = repo.defBuffer;    // Default global data pointer to start of general I/O buffer
         repo.rcvEcnBits = IPTOS_ECN_NOT_ECT; // Default global ECN value to Not-ECT
+        repo.rcvTime    = repo.systemClock;  // Default global receive time to current time
 
         //
         // Issue read
@@ -2631,9 +4950,10 @@ int recv_proc(int connindex) {
                                 iov[i].iov_len             = recvsize;
                                 mmsg[i].msg_hdr.msg_iov    = &iov[i];
                                 mmsg[i].msg_hdr.msg_iovlen = 1;
-                                if (c->ecnCEThresh > 0) {
+                                if (c->ecnCEThresh > 0 || c->rxDropTrack || c->rxTimestamp) {
                                         //
-                                        // Ancillary data to receive ECN bits
+                                        // Ancillary data to receive ECN bits, socket receive overflow counter, and
+                                        // kernel receive timestamp
                                         //
                                         mmsg[i].msg_hdr.msg_control    = nextcmsg;
                                         mmsg[i].msg_hdr.msg_controllen = RECV_CMSG_SIZE;
@@ -2646,12 +4966,16 @@ int recv_proc(int connindex) {
                         // Perform read and process messages
                         //
                         repo.rcvDataSize = recvmmsg(c->fd, mmsg, RECVMMSG_SIZE, MSG_TRUNC, NULL); // Returns number of messages
+#ifdef HAVE_SO_RXQ_OVFL
+                        dropcnt = c->rxDropLast;
+#endif
                         for (i = 0; i < repo.rcvDataSize; i++) {
                                 mmsgDataSize[i] = (int) mmsg[i].msg_len; // Save actual received length (although truncated)
-                                if (c->ecnCEThresh > 0) {
+                                if (c->ecnCEThresh > 0 || c->rxDropTrack || c->rxTimestamp) {
                                         mmsgEcnBits[i] = IPTOS_ECN_NOT_ECT; // Default to Not-ECT
+                                        mmsgRxTime[i]  = repo.systemClock;  // Default to current time
                                         //
-                                        // Extract ECN bits
+                                        // Extract ECN bits, socket receive overflow counter, and kernel receive timestamp
                                         //
                                         struct cmsghdr *cmsg;
                                         struct msghdr *msg = &mmsg[i].msg_hdr;
@@ -2661,9 +4985,30 @@ int recv_proc(int connindex) {
                                                         var            = *(int *) CMSG_DATA(cmsg);
                                                         mmsgEcnBits[i] = IPTOS_ECN(var); // Save actual ECN value
                                                 }
+#ifdef HAVE_SO_RXQ_OVFL
+                                                else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                                                        dropcnt = *(uint32_t *) CMSG_DATA(cmsg); // Cumulative socket drops
+                                                }
+#endif
+#ifdef HAVE_SO_TIMESTAMPNS
+                                                else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                                                        mmsgRxTime[i] = tspec2ns((struct timespec *) CMSG_DATA(cmsg));
+                                                }
+#endif
                                         }
                                 }
                         }
+#ifdef HAVE_SO_RXQ_OVFL
+                        //
+                        // Attribute datagrams dropped by socket receive buffer overflow to local loss
+                        //
+                        if (dropcnt != c->rxDropLast) {
+                                dropcnt -= c->rxDropLast; // Change since last read (allow for counter wrap)
+                                c->rxDropLast += dropcnt;
+                                c->sisActDropCnt += dropcnt;
+                                c->tiRxDropCnt += dropcnt;
+                        }
+#endif
                         if (i < RECVMMSG_SIZE)
                                 mmsgDataSize[i] = 0; // Terminate list
                         if (repo.rcvDataSize < RECVMMSG_SIZE) {
@@ -2691,7 +5036,7 @@ int recv_proc(int connindex) {
                 if ((var = receive_trunc(errno, recvsize, RCV_HEADER_SIZE)) > 0) {
                         repo.rcvDataSize = var;
                 } else if ((var = socket_error(connindex, errno, "RECVMMSG/RECV/RECVFROM")) > 0) {
-                        if (!conf.errSuppress) {
+                        if (!conf.errSuppress && log_event(connindex, LOG_EVT_RECVERR, "RECV ERROR", 0)) {
                                 send_proc(errConn, scratch, var);
                         }
                 }
@@ -2711,7 +5056,9 @@ int recv_proc(int connindex) {
 int send_proc(int connindex, char *sendbuffer, int sendsize) {
         register struct connection *c = &conn[connindex];
         int var, actual = 0;
-        char *buf;
+        char *buf, tosbuf[TOS_CMSG_SIZE];
+        struct msghdr msg;
+        struct iovec iov;
 
         //
         // If JSON is configured save error message in JSON error buffer(s)
@@ -2733,13 +5080,27 @@ int send_proc(int connindex, char *sendbuffer, int sendsize) {
         }
 
         //
-        // Prefix send buffer with timestamp for log file write
+        // Prefix send buffer with (cached) timestamp and add to buffered output for log file write (see log_flush)
         //
         if (c->type == T_LOG) {
-                var = strftime(scratch2, sizeof(scratch2), TIME_FORMAT, localtime(&repo.systemClock.tv_sec));
-                var += sprintf(&scratch2[var], " %s", sendbuffer);
-                sendbuffer = scratch2;
-                sendsize   = var;
+                if (logTimeSize == 0 || logTimeSec != nssec(repo.systemClock)) {
+                        logTimeSec  = nssec(repo.systemClock);
+                        logTimeSize = (int) strftime(logTimeText, sizeof(logTimeText), TIME_FORMAT, localtime(&logTimeSec));
+                }
+                var = logTimeSize + 1 + (int) strlen(sendbuffer);
+                if (var > (int) sizeof(scratch2) - 1)
+                        var = (int) sizeof(scratch2) - 1;
+                if (logBufSize + var > LOG_BUFFER_SIZE) {
+                        _log_write();
+                }
+                if (logConn < 0)
+                        atexit(_log_exit); // Write any remaining output if process exits without final flush
+                logConn = connindex;
+                memcpy(&logBuffer[logBufSize], logTimeText, logTimeSize);
+                logBuffer[logBufSize + logTimeSize] = ' ';
+                memcpy(&logBuffer[logBufSize + logTimeSize + 1], sendbuffer, var - logTimeSize - 1);
+                logBufSize += var;
+                return var;
         } else if (sendsize == 0) {
                 sendsize = strlen(sendbuffer);
         }
@@ -2747,7 +5108,16 @@ int send_proc(int connindex, char *sendbuffer, int sendsize) {
         //
         // Issue send
         //
-        if (c->subType == SOCK_STREAM || c->connected) {
+        if (c->type == T_SHARED) {
+                memset((void *) &msg, 0, sizeof(struct msghdr));
+                _shared_msghdr(c, &msg, tosbuf);
+                iov.iov_base   = (void *) sendbuffer;
+                iov.iov_len    = (size_t) sendsize;
+                msg.msg_iov    = &iov;
+                msg.msg_iovlen = 1;
+                actual         = sendmsg(c->fd, &msg, 0);
+
+        } else if (c->subType == SOCK_STREAM || c->connected) {
                 actual = send(c->fd, sendbuffer, sendsize, 0);
 
         } else if (c->subType == SOCK_DGRAM) {
@@ -2772,23 +5142,117 @@ int send_proc(int connindex, char *sendbuffer, int sendsize) {
                 return 0;
         }
 
+        return actual;
+}
+//----------------------------------------------------------------------------
+//
+// Write buffered log file output
+//
+// NOTE: If file operations fail there is no device to send error messages to
+//
+static void _log_write(void) {
+        register struct connection *c;
+        int actual;
+
+        if (logBufSize == 0 || logConn < 0)
+                return;
+        c          = &conn[logConn];
+        actual     = (int) write(c->fd, logBuffer, logBufSize);
+        logBufSize = 0;
+        if (actual <= 0)
+                return;
+
         //
         // Recycle log file if growth size exceeded
         //
-        // NOTE: If file operations fail there is no device to send error messages to
-        //
-        if (c->type == T_LOG) {
-                repo.logFileSize += actual;
-                if (repo.logFileSize > conf.logFileMax) {
-                        close(c->fd);
-                        strcpy(scratch2, conf.logFile);
-                        strcat(scratch2, ".old");
-                        var              = rename(conf.logFile, scratch2);
-                        c->fd            = open(conf.logFile, LOGFILE_FLAGS, LOGFILE_MODE);
-                        repo.logFileSize = 0;
+        repo.logFileSize += actual;
+        if (repo.logFileSize > conf.logFileMax) {
+                close(c->fd);
+                strcpy(scratch2, conf.logFile);
+                strcat(scratch2, ".old");
+                rename(conf.logFile, scratch2);
+                c->fd            = open(conf.logFile, LOGFILE_FLAGS, LOGFILE_MODE);
+                repo.logFileSize = 0;
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Write remaining buffered log file output at process exit (connection table is released after final flush)
+//
+static void _log_exit(void) {
+        if (conn != NULL)
+                _log_write();
+}
+//----------------------------------------------------------------------------
+//
+// Check if an error event should be output, aggregating repeated events of the same type on a connection
+//
+// The first event of an aggregation interval is output by the caller (TRUE is returned), subsequent
+// ones are only counted and then output as a single summary line at the end of the interval
+//
+BOOL log_event(int connindex, int type, char *label, unsigned int amount) {
+        register struct logEvent *e = &conn[connindex].logEvent[type];
+
+        if (e->start != 0) {
+                e->label = label;
+                e->count++;
+                e->amount += amount;
+                return FALSE;
+        }
+        e->start = repo.monoClock;
+        return TRUE;
+}
+//----------------------------------------------------------------------------
+//
+// Output summary of aggregated error events for a connection (when interval ends or if forced)
+//
+void log_summary(int connindex, BOOL force) {
+        register struct logEvent *e;
+        int i, var;
+        char summary[STRING_SIZE];
+        nstime_t nsvar;
+
+        for (i = 0; i < LOG_EVT_COUNT; i++) {
+                e = &conn[connindex].logEvent[i];
+                if (e->start == 0)
+                        continue;
+                nsvar = repo.monoClock - e->start;
+                if (!force && nsmsec(nsvar) < LOG_AGG_INTERVAL)
+                        continue;
+                if (e->count > 0) {
+                        var = sprintf(summary, "[%d]%s: %u more suppressed", connindex, e->label, e->count);
+                        if (e->amount > 0)
+                                var += sprintf(&summary[var], " (%u datagrams)", e->amount);
+                        var += sprintf(&summary[var], " within last %ld ms\n", (long) nsmsec(nsvar));
+                        send_proc(errConn, summary, var);
+                        //
+                        // Continue aggregating while events are still occurring
+                        //
+                        e->count  = 0;
+                        e->amount = 0;
+                        e->start  = repo.monoClock;
+                        if (!force)
+                                continue;
                 }
+                e->start = 0;
         }
-        return actual;
+}
+//----------------------------------------------------------------------------
+//
+// Periodically output aggregated error event summaries and write buffered log file output
+//
+void log_flush(BOOL force) {
+        int i;
+
+        if (!force && repo.monoClock < repo.logFlushTime)
+                return;
+        repo.logFlushTime = repo.monoClock + LOG_FLUSH_INTERVAL * NSECINMSEC;
+
+        for (i = 0; i <= repo.maxConnIndex; i++) {
+                if (conn[i].fd >= 0)
+                        log_summary(i, force);
+        }
+        _log_write();
 }
 #ifdef __linux__
 //----------------------------------------------------------------------------
@@ -2950,17 +5414,18 @@ void output_warning(int connindex, int type) {
 //
 // Populate scratch buffer and return length
 //
-int create_timestamp(struct timespec *tspecvar, BOOL utc) {
+int create_timestamp(nstime_t nstime, BOOL utc) {
         int var;
+        time_t ttime = nssec(nstime);
         struct tm *tm_data;
 
         if (utc) {
-                tm_data = gmtime(&tspecvar->tv_sec);
+                tm_data = gmtime(&ttime);
         } else {
-                tm_data = localtime(&tspecvar->tv_sec);
+                tm_data = localtime(&ttime);
         }
         var = strftime(scratch, STRING_SIZE, "%FT%T", tm_data);
-        var += sprintf(&scratch[var], ".%06ld", tspecvar->tv_nsec / NSECINUSEC);
+        var += sprintf(&scratch[var], ".%06ld", nsnsec(nstime) / NSECINUSEC);
 #ifndef __linux__
         if (utc) {
 #else
@@ -2977,62 +5442,336 @@ int create_timestamp(struct timespec *tspecvar, BOOL utc) {
         }
         return var;
 }
+#ifdef HAVE_RTM_GETSTATS
 //----------------------------------------------------------------------------
 //
-// Update interface statistics via sysfs
+// Read 64-bit interface counters via a single netlink request (RTM_GETSTATS)
 //
-void upd_intf_stats(BOOL initialize) {
+// Return 0 on success, else -1
+//
+static int _intf_netlink_read(int fd, struct intfCounters *ic) {
+        int var;
+        unsigned long long buffer[128]; // Aligned receive buffer
+        struct nlmsghdr *nlh;
+        struct if_stats_msg *ifsm;
+        struct rtattr *rta;
+        struct rtnl_link_stats64 stats;
+        struct {
+                struct nlmsghdr nlh;
+                struct if_stats_msg ifsm;
+        } req;
+
+        //
+        // Request link statistics of interface
+        //
+        memset(&req, 0, sizeof(req));
+        req.nlh.nlmsg_len    = NLMSG_LENGTH(sizeof(struct if_stats_msg));
+        req.nlh.nlmsg_type   = RTM_GETSTATS;
+        req.nlh.nlmsg_flags  = NLM_F_REQUEST;
+        req.ifsm.family      = AF_UNSPEC;
+        req.ifsm.ifindex     = (uint32_t) repo.intfIndex;
+        req.ifsm.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+        if (send(fd, &req, req.nlh.nlmsg_len, 0) < 0)
+                return -1;
+        if ((var = (int) recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) < 0)
+                return -1;
+
+        //
+        // Extract 64-bit link statistics attribute from response
+        //
+        nlh = (struct nlmsghdr *) buffer;
+        if (!NLMSG_OK(nlh, (unsigned int) var) || nlh->nlmsg_type != RTM_NEWSTATS)
+                return -1;
+        ifsm = (struct if_stats_msg *) NLMSG_DATA(nlh);
+        rta  = (struct rtattr *) ((char *) ifsm + NLMSG_ALIGN(sizeof(struct if_stats_msg)));
+        var  = (int) (nlh->nlmsg_len - NLMSG_LENGTH(sizeof(struct if_stats_msg)));
+        for (; RTA_OK(rta, var); rta = RTA_NEXT(rta, var)) {
+                if (rta->rta_type != IFLA_STATS_LINK_64 || RTA_PAYLOAD(rta) < sizeof(stats))
+                        continue;
+                memcpy(&stats, RTA_DATA(rta), sizeof(stats));
+                ic->rxBytes   = (unsigned long long) stats.rx_bytes;
+                ic->txBytes   = (unsigned long long) stats.tx_bytes;
+                ic->rxPackets = (unsigned long long) stats.rx_packets;
+                ic->txPackets = (unsigned long long) stats.tx_packets;
+                ic->rxDropped = (unsigned long long) stats.rx_dropped;
+                ic->txDropped = (unsigned long long) stats.tx_dropped;
+                ic->rxErrors  = (unsigned long long) stats.rx_errors;
+                ic->txErrors  = (unsigned long long) stats.tx_errors;
+                return 0;
+        }
+        return -1;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain link speed of local interface via sysfs (Mbps, zero if unknown or not applicable)
+//
+static int _intf_link_speed(void) {
+        int fd, var;
+        char buffer[32];
+
+        sprintf(scratch, "/sys/class/net/%.*s/speed", IFNAMSIZ, conf.intfName);
+        if ((fd = open(scratch, O_RDONLY)) < 0)
+                return 0;
+        var = (int) read(fd, buffer, sizeof(buffer) - 1);
+        close(fd);
+        if (var <= 0)
+                return 0;
+        buffer[var] = '\0';
+        if ((var = atoi(buffer)) < 0) // Unknown speed is reported as -1
+                var = 0;
+        return var;
+}
+#endif
+//----------------------------------------------------------------------------
+//
+// Open local interface statistics (via netlink if available, else via sysfs counter files)
+//
+// Populate scratch buffer and return length on error
+//
+int open_intf_stats(void) {
         int i, fd, var;
-        unsigned long long intfbytes, *ib; // Always handle counters as 64-bit values
+        char intfpath[IFNAMSIZ + 64];
+
+#ifdef HAVE_RTM_GETSTATS
+        //
+        // Use netlink if supported by kernel for this interface
+        //
+        if ((repo.intfIndex = (int) if_nametoindex(conf.intfName)) > 0) {
+                if ((fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE)) >= 0) {
+                        if (_intf_netlink_read(fd, &repo.intfCount) == 0) {
+                                repo.intfFD      = fd;
+                                repo.intfNetlink = TRUE;
+                                repo.intfCountPs = repo.intfCountDbg = repo.intfCount;
+                                repo.linkSpeed   = _intf_link_speed();
+                                return 0;
+                        }
+                        close(fd);
+                }
+        }
+#endif
+        if (repo.isServer) {
+                return sprintf(scratch, "ERROR: Netlink statistics unavailable for local interface (%s)\n", conf.intfName);
+        }
+
+        //
+        // Open sysfs counter files for each direction
+        //
+        for (i = 0; i < 2; i++) {
+                var = sprintf(intfpath, "/sys/class/net/%s/statistics/", conf.intfName);
+                if ((conf.usTesting && i == 0) || (conf.dsTesting && i == 1))
+                        strcat(&intfpath[var], "tx_bytes");
+                else
+                        strcat(&intfpath[var], "rx_bytes");
+                if ((fd = open(intfpath, O_RDONLY)) < 0) {
+                        return sprintf(scratch, "OPEN ERROR: %s (%s)\n", strerror(errno), intfpath);
+                }
+                if (i == 0)
+                        repo.intfFD = fd;
+                else
+                        repo.intfFDAlt = fd;
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Sample interface counters via netlink and return change since base sample (which is then updated)
+//
+// Return FALSE if netlink sampling is not available
+//
+BOOL sample_intf_stats(struct intfCounters *delta, struct intfCounters *base) {
+#ifdef HAVE_RTM_GETSTATS
+        struct intfCounters ic;
+
+        memset(delta, 0, sizeof(struct intfCounters));
+        if (!repo.intfNetlink || _intf_netlink_read(repo.intfFD, &ic) < 0)
+                return FALSE;
+#define INTF_DELTA(field) delta->field = (ic.field >= base->field) ? ic.field - base->field : 0
+        INTF_DELTA(rxBytes);
+        INTF_DELTA(txBytes);
+        INTF_DELTA(rxPackets);
+        INTF_DELTA(txPackets);
+        INTF_DELTA(rxDropped);
+        INTF_DELTA(txDropped);
+        INTF_DELTA(rxErrors);
+        INTF_DELTA(txErrors);
+#undef INTF_DELTA
+        *base = ic;
+        return TRUE;
+#else
+        (void) (base);
+        memset(delta, 0, sizeof(struct intfCounters));
+        return FALSE;
+#endif
+}
+//----------------------------------------------------------------------------
+//
+// Populate interface drop data (since last debug message) for appending to debug message
+//
+static void _intf_debug(char *intfdata) {
+        struct intfCounters delta;
+
+        *intfdata = '\0';
+        if (sample_intf_stats(&delta, &repo.intfCountDbg)) {
+                sprintf(intfdata, INTF_DEBUG, delta.rxDropped + delta.rxErrors, delta.txDropped + delta.txErrors);
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Update interface statistics via netlink or sysfs
+//
+void upd_intf_stats(BOOL initialize) {
+        int i, var;
+        unsigned long long intfbytes[2], *ib; // Always handle counters as 64-bit values
         double mbps, *im;
-        struct timespec tspecvar;
         char buffer[32];
 
-        if (!initialize) {
-                lseek(repo.intfFD, 0, SEEK_SET);    // Reset position to read new value
-                lseek(repo.intfFDAlt, 0, SEEK_SET); // Reset position to read new value
+        //
+        // Obtain byte counters (primary is transmit when testing upstream, else receive)
+        //
+        intfbytes[0] = intfbytes[1] = 0;
+#ifdef HAVE_RTM_GETSTATS
+        if (repo.intfNetlink) {
+                if (_intf_netlink_read(repo.intfFD, &repo.intfCount) < 0)
+                        return;
+                if (conf.usTesting) {
+                        intfbytes[0] = repo.intfCount.txBytes;
+                        intfbytes[1] = repo.intfCount.rxBytes;
+                } else {
+                        intfbytes[0] = repo.intfCount.rxBytes;
+                        intfbytes[1] = repo.intfCount.txBytes;
+                }
+        } else
+#endif
+        {
+                if (!initialize) {
+                        lseek(repo.intfFD, 0, SEEK_SET);    // Reset position to read new value
+                        lseek(repo.intfFDAlt, 0, SEEK_SET); // Reset position to read new value
+                }
+                for (i = 0; i < 2; i++) {
+                        if ((var = (int) read((i == 0) ? repo.intfFD : repo.intfFDAlt, buffer, sizeof(buffer) - 1)) > 0) {
+                                buffer[var]  = '\0';
+                                intfbytes[i] = strtoull(buffer, NULL, 10);
+                        }
+                }
         }
+
+        //
+        // Calculate rates from change in byte counters
+        //
         for (i = 0; i < 2; i++) {
                 if (i == 0) {
-                        fd = repo.intfFD;
                         ib = &repo.intfBytes;
                         im = &repo.intfMbps;
                 } else {
-                        fd = repo.intfFDAlt;
                         ib = &repo.intfBytesAlt;
                         im = &repo.intfMbpsAlt;
                 }
-                if ((var = (int) read(fd, buffer, sizeof(buffer))) > 0) {
-                        buffer[var] = '\0';
-                        if ((intfbytes = strtoull(buffer, NULL, 10)) > 0) {
-                                if (!initialize) {
-                                        if (tspecisset(&repo.intfTime)) {
-                                                tspecminus(&repo.systemClock, &repo.intfTime, &tspecvar);
-                                                if (intfbytes >= *ib) {
-                                                        mbps = (double) (intfbytes - *ib);
-                                                } else { // Counter wrapped (allow for 32 or 64-bit wrap threshold)
-                                                        if (*ib <= 4294967295ULL) {
-                                                                mbps = (double) ((4294967295ULL - *ib) + intfbytes + 1);
-                                                        } else {
-                                                                mbps = (double) ((ULLONG_MAX - *ib) + intfbytes + 1);
-                                                        }
+                if (intfbytes[i] > 0) {
+                        if (!initialize) {
+                                if (repo.intfTime != 0) {
+                                        if (intfbytes[i] >= *ib) {
+                                                mbps = (double) (intfbytes[i] - *ib);
+                                        } else { // Counter wrapped (allow for 32 or 64-bit wrap threshold)
+                                                if (*ib <= 4294967295ULL) {
+                                                        mbps = (double) ((4294967295ULL - *ib) + intfbytes[i] + 1);
+                                                } else {
+                                                        mbps = (double) ((ULLONG_MAX - *ib) + intfbytes[i] + 1);
                                                 }
-                                                mbps *= 8.0;
-                                                mbps /= (double) tspecusec(&tspecvar);
-                                                *im = mbps;
                                         }
-                                }
-                                *ib = intfbytes; // Save current value
-                                if (i == 1) {
-                                        tspeccpy(&repo.intfTime, &repo.systemClock); // Save current time
+                                        mbps *= 8.0;
+                                        mbps /= (double) nsusec(repo.monoClock - repo.intfTime);
+                                        *im = mbps;
                                 }
                         }
+                        *ib = intfbytes[i]; // Save current value
+                        if (i == 1) {
+                                repo.intfTime = repo.monoClock; // Save current time
+                        }
                 }
         }
         return;
 }
 //----------------------------------------------------------------------------
 //
+// Sample measured utilization (throughput in each direction and CPU) for admission control
+//
+// Throughput is taken from the local interface counters when available (to
+// include all traffic), else from the L3 bytes delivered by tests.
+//
+void upd_utilization(void) {
+        int i;
+        long long usec;
+        unsigned long long bytes[2];
+        struct intfCounters delta;
+        nstime_t nscpu;
+
+        //
+        // Initialize on first call, else wait for sampling interval to elapse
+        //
+        nsgettime(CLOCK_PROCESS_CPUTIME_ID, &nscpu);
+        if (repo.utilTime == 0) {
+                repo.utilTime    = repo.monoClock;
+                repo.utilCpuTime = nscpu;
+                sample_intf_stats(&delta, &repo.intfCountUtil);
+                return;
+        }
+        if ((usec = (long long) nsusec(repo.monoClock - repo.utilTime)) < UTIL_SAMPLE_INT * USECINMSEC)
+                return;
+
+        //
+        // Obtain byte counts (transmit/receive) since last sample and update rates
+        //
+        if (sample_intf_stats(&delta, &repo.intfCountUtil)) {
+                bytes[0] = delta.txBytes;
+                bytes[1] = delta.rxBytes;
+        } else {
+                bytes[0] = repo.utilBytes[0] - repo.utilBytesLast[0];
+                bytes[1] = repo.utilBytes[1] - repo.utilBytesLast[1];
+        }
+        for (i = 0; i < 2; i++) {
+                repo.utilMbps[i]      = (double) bytes[i] * 8.0 / (double) usec;
+                repo.utilBytesLast[i] = repo.utilBytes[i];
+                repo.utilPending[i]   = 0; // Now reflected in measured rate (at least partially)
+        }
+
+        //
+        // Update CPU utilization of process (single threaded, so relative to one core)
+        //
+        repo.utilCpu     = (double) nsusec(nscpu - repo.utilCpuTime) * 100.0 / (double) usec;
+        repo.utilCpuTime = nscpu;
+        repo.utilTime    = repo.monoClock;
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Determine if a new test can be admitted based on measured utilization
+//
+// The bandwidth required by the test (if specified) is added to the measured
+// rate of its direction, along with any admitted since the last sample. The
+// capacity is the local interface link speed if known, else the configured
+// available bandwidth (if neither, only CPU utilization is considered).
+//
+BOOL admit_utilization(BOOL upstream, int mbw) {
+        int i, capacity;
+
+        if (repo.utilCpu >= (double) conf.utilTarget)
+                return FALSE;
+        i = 0; // Server transmits for downstream tests
+        if (upstream)
+                i = 1; // Server receives for upstream tests
+        capacity = conf.maxBandwidth;
+        if (repo.linkSpeed > 0)
+                capacity = repo.linkSpeed;
+        if (capacity > 0) {
+                if (repo.utilMbps[i] + (double) (repo.utilPending[i] + mbw) >
+                    (double) capacity * (double) conf.utilTarget / 100.0)
+                        return FALSE;
+        }
+        repo.utilPending[i] += mbw;
+        return TRUE;
+}
+//----------------------------------------------------------------------------
+//
 // Return a uniformly distributed random number between min and max
 //
 int getuniform(int min, int max) {
@@ -3061,7 +5800,7 @@ void output_debug(int connindex) {
         register struct connection *c = &conn[connindex];
         int var;
         unsigned int dvmin, dvavg;
-        char celabel[8], cedata[16];
+        char celabel[16], cedata[32], intfdata[64];
 
         dvmin = dvavg = 0;
         if (c->delayVarCnt > 0) {
@@ -3076,8 +5815,13 @@ void output_debug(int connindex) {
                 strcpy(celabel, CE_LABEL_TEXT);
                 sprintf(cedata, "/%u", c->tiRxCECount);
         }
+        if (c->tiRxDropCnt > 0) { // Append local receive drops when present
+                strcat(celabel, LOCDROP_TEXT);
+                sprintf(&cedata[strlen(cedata)], "/%u", c->tiRxDropCnt);
+        }
+        _intf_debug(intfdata);
         var = sprintf(scratch, CLIENT_DEBUG, connindex, celabel, c->seqErrLoss, c->seqErrOoo, c->seqErrDup, cedata, dvmin, dvavg,
-                      c->delayVarMax, var, get_rate(connindex, NULL, L3DG_OVERHEAD));
+                      c->delayVarMax, var, get_rate(connindex, NULL, L3DG_OVERHEAD), intfdata);
         send_proc(monConn, scratch, var);
 
         return;
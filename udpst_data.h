@@ -41,17 +41,51 @@
 extern int send1_loadpdu(int);
 extern int send2_loadpdu(int);
 extern int service_loadpdu(int);
+extern void select_hotpath(int);
 extern int service_recvmmsg(int);
 extern int send_statuspdu(int);
 extern int service_statuspdu(int);
 extern int proc_subinterval(int, BOOL);
 extern int agg_query_proc(int);
+extern int worker_start(void);
+extern void worker_publish(int);
+extern void worker_merge(int);
+extern int worker_wait(int);
+extern BOOL worker_pending(void);
+extern int worker_actconn(void);
+extern void worker_status(BOOL);
+extern void worker_finish(void);
+extern void rt_profile(void);
+extern void rt_unpin(void);
 extern int stop_test(int);
 extern int recv_proc(int);
+extern int recv_shared(int);
+extern void demux_add(int, struct sockaddr_storage *, socklen_t);
+extern void demux_remove(int);
 extern int send_proc(int, char *, int);
+extern int socket_error(int, int, char *);
 extern void sr_copy(struct sendingRate *, struct sendingRate *, BOOL);
-extern int create_timestamp(struct timespec *, BOOL);
+extern int create_timestamp(nstime_t, BOOL);
 extern int getuniform(int, int);
 extern unsigned short checksum(void *, int);
+extern void probe_tx_methods(void);
+extern void clock_init(void);
+extern void clock_update(void);
+extern void probe_clock_reads(void);
+extern void init_tx_method(int);
+extern void set_tx_method(int, struct sendingRate *);
+extern void calibrate_capacity(void);
+extern int flush_txqueue(int);
+#ifdef HAVE_TX_TIMESTAMPS
+extern void init_txtstamp(int);
+extern int service_txtstamp(int);
+#endif
+extern int open_intf_stats(void);
+extern BOOL sample_intf_stats(struct intfCounters *, struct intfCounters *);
+extern void upd_utilization(void);
+extern BOOL admit_utilization(BOOL, int);
+extern BOOL log_event(int, int, char *, unsigned int);
+extern void log_summary(int, BOOL);
+extern void log_flush(BOOL);
 
 #endif /* UDPST_DATA_H */
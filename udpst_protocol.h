@@ -179,7 +179,7 @@ struct controlHdrTA {
         uint16_t subIntPeriod;       // Sub-Interval period (ms)
         uint16_t reserved3;          // (reserved for alignment)
         uint16_t reserved4;          // (reserved for alignment)
-        uint8_t reserved5;           // (reserved for alignment)
+        uint8_t pdvPercentile;       // Delay variation percentile (0 = average)
         // ========== Integrity Verification ==========
         uint8_t authMode;      // Authentication mode
         uint32_t authUnixTime; // Authentication timestamp
@@ -304,13 +304,14 @@ struct statusAuthReuse {        // Start on 32-bit boundary
         uint16_t reserved3;     // (reserved for alignment)
         uint8_t reserved4;      // (reserved for alignment)
         uint8_t authMode;       // Authentication mode - DO NOT OVERWRITE
-        uint32_t reserved5;     // (reserved for alignment) [previously authUnixTime]
-        uint32_t reserved6;     // (reserved for alignment) [previously authDigest]
-        uint32_t reserved7;     // (reserved for alignment) [previously authDigest]
+        uint32_t tiRxDropCnt;   // Trial interval receive local drop count [previously authUnixTime]
+        uint32_t sisSavDropCnt; // Sub-interval saved local drop count [previously authDigest]
+        uint32_t tiDelayVarPct; // Trial interval delay variation percentile (us) [previously authDigest]
         uint32_t tiRxCECount;   // Trial interval receive CE count [previously authDigest]
         uint32_t sisSavCECount; // Sub-interval saved CE count [previously authDigest]
         uint8_t reserved8;      // (reserved for alignment) [previously keyId]
 #define STATUS_ECN_BLEACH 0x01  // ECN bleaching detected
+#define STATUS_PDV_PCT    0x02  // Delay variation percentile included (tiDelayVarPct)
         uint8_t modifierBitmap; // Modifier bitmap [previously reservedAuth1]
         uint16_t checkSum;      // Header checksum - DO NOT OVERWRITE
 };